@@ -0,0 +1,40 @@
+//===--- ClosureCapture.swift ---------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of passing a non-escaping closure, which
+// captures local variables, to a higher-order function. The closure context
+// does not escape and can be allocated on the stack.
+import TestsUtils
+
+@inline(never)
+func sumMapped(values: [Int], _ transform: (Int) -> Int) -> Int {
+  var sum = 0
+  for v in values {
+    sum = sum &+ transform(v)
+  }
+  return sum
+}
+
+@inline(never)
+public func run_ClosureCapture(N: Int) {
+  let values = Array(0..<100)
+  var sum = 0
+  for _ in 0..<N {
+    for i in 0..<1_000 {
+      let scale = i & 7
+      let offset = i >> 3
+      sum = sum &+ sumMapped(values) { $0 &* scale &+ offset }
+    }
+  }
+  CheckResults(sum == N &* 23_525_000,
+               "Incorrect results in ClosureCapture: \(sum)")
+}
@@ -0,0 +1,118 @@
+//===--- EnumMultiPayload.swift -------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of switching over and constructing generic
+// multi-payload enums, and optionals of them, in unspecialized code. The case
+// of such values is read and stored by the runtime.
+
+import TestsUtils
+
+enum Either3<A, B, C> {
+  case first(A)
+  case second(B)
+  case third(C)
+  case empty
+  case unknown
+}
+
+class Sink {
+  func fill(count: Int) {}
+  func tally() -> Int { return 0 }
+}
+
+// The methods of a generic class are not specialized if the type of the
+// instance is not known statically.
+final class TypedSink<A, B> : Sink {
+  let a: A
+  let b: B
+  var values: [Either3<A, B, Int>?] = []
+
+  init(_ a: A, _ b: B) {
+    self.a = a
+    self.b = b
+  }
+
+  override func fill(count: Int) {
+    values.removeAll(keepingCapacity: true)
+    for i in 0..<count {
+      switch i % 6 {
+      case 0: values.append(.first(a))
+      case 1: values.append(.second(b))
+      case 2: values.append(.third(i))
+      case 3: values.append(.empty)
+      case 4: values.append(.unknown)
+      default: values.append(nil)
+      }
+    }
+  }
+
+  override func tally() -> Int {
+    var result = 0
+    for value in values {
+      switch value {
+      case .some(.first): result += 1
+      case .some(.second): result += 2
+      case .some(.third(let x)): result += x & 1
+      case .some(.empty): result += 3
+      case .some(.unknown): result += 4
+      case .none: result += 5
+      }
+    }
+    return result
+  }
+}
+
+@inline(never)
+func makeSinks() -> [Sink] {
+  return [TypedSink(UInt8(1), UInt8(2)),
+          TypedSink(1, "string"),
+          TypedSink((1, 2.0), [1, 2, 3])]
+}
+
+let count = 1200
+
+// Each group of six values has the tally 1 + 2 + 0 + 3 + 4 + 5, because the
+// payload of the third case is even.
+let expectedTally = (count / 6) * 15
+
+@inline(never)
+public func run_EnumMultiPayloadInit(N: Int) {
+  let sinks = makeSinks()
+  for _ in 1...20*N {
+    for sink in sinks {
+      sink.fill(count)
+    }
+  }
+  for sink in sinks {
+    CheckResults(sink.tally() == expectedTally,
+                 "Incorrect results in EnumMultiPayloadInit")
+  }
+}
+
+@inline(never)
+public func run_EnumMultiPayloadSwitch(N: Int) {
+  let sinks = makeSinks()
+  for sink in sinks {
+    sink.fill(count)
+  }
+  var result = 0
+  for _ in 1...100*N {
+    for sink in sinks {
+      result = sink.tally()
+      if result != expectedTally {
+        break
+      }
+    }
+  }
+  CheckResults(result == expectedTally,
+               "Incorrect results in EnumMultiPayloadSwitch")
+}
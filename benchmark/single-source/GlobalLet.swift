@@ -0,0 +1,46 @@
+//===--- GlobalLet.swift --------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of reading lazily initialized global
+// constants in a tight loop. The initializers can't be constant-folded, so each
+// access goes through the global accessor and its swift_once check.
+import TestsUtils
+
+@inline(never)
+func makeScale() -> Int {
+  return 3
+}
+
+@inline(never)
+func makeOffset() -> Int {
+  return 7
+}
+
+let globalScale = makeScale()
+let globalOffset = makeOffset()
+
+@inline(never)
+func scaled(x: Int) -> Int {
+  return x &* globalScale &+ globalOffset
+}
+
+@inline(never)
+public func run_GlobalLet(N: Int) {
+  var sum = 0
+  for _ in 0..<N {
+    for i in 0..<10_000 {
+      sum = sum &+ scaled(i)
+    }
+  }
+  CheckResults(sum == N &* 150_055_000,
+               "Incorrect results in GlobalLet: \(sum)")
+}
@@ -0,0 +1,46 @@
+//===--- MatrixMultiply.swift ---------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of nested loops over [[Double]], which
+// depends on hoisting the bounds checks out of the inner loops.
+
+import TestsUtils
+
+@inline(never)
+func multiply(a: [[Double]], _ b: [[Double]], _ c: inout [[Double]]) {
+  let n = a.count
+  for i in 0..<n {
+    for j in 0..<n {
+      var sum = 0.0
+      for k in 0..<n {
+        sum += a[i][k] * b[k][j]
+      }
+      c[i][j] = sum
+    }
+  }
+}
+
+@inline(never)
+public func run_MatrixMultiply(N: Int) {
+  let size = 64
+  let a = [[Double]](repeating: [Double](repeating: 1.0, count: size),
+                     count: size)
+  let b = [[Double]](repeating: [Double](repeating: 2.0, count: size),
+                     count: size)
+  var c = [[Double]](repeating: [Double](repeating: 0.0, count: size),
+                     count: size)
+  for _ in 0..<N {
+    multiply(a, b, &c)
+  }
+  CheckResults(c[size - 1][size - 1] == 2.0 * Double(size),
+               "Incorrect result in MatrixMultiply.")
+}
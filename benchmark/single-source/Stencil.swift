@@ -0,0 +1,40 @@
+//===--- Stencil.swift ----------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of a 5-point stencil, where the array
+// indices are offsets of the induction variables.
+
+import TestsUtils
+
+@inline(never)
+func stencil(src: [[Double]], _ dst: inout [[Double]]) {
+  let n = src.count
+  for i in 1..<n - 1 {
+    for j in 1..<n - 1 {
+      dst[i][j] = 0.2 * (src[i][j] + src[i - 1][j] + src[i + 1][j] +
+                         src[i][j - 1] + src[i][j + 1])
+    }
+  }
+}
+
+@inline(never)
+public func run_Stencil(N: Int) {
+  let size = 128
+  var a = [[Double]](repeating: [Double](repeating: 1.0, count: size),
+                     count: size)
+  var b = a
+  for _ in 0..<N {
+    stencil(a, &b)
+    stencil(b, &a)
+  }
+  CheckResults(a[size / 2][size / 2] == 1.0, "Incorrect result in Stencil.")
+}
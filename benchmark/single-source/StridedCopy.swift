@@ -0,0 +1,40 @@
+//===--- StridedCopy.swift ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of array accesses with a constant stride,
+// e.g. extracting one channel of interleaved data.
+
+import TestsUtils
+
+@inline(never)
+func copyStrided(src: [Int], _ dst: inout [Int]) {
+  let n = dst.count
+  for i in 0..<n {
+    // Read the second of four interleaved channels.
+    dst[i] = src[i * 4 + 1]
+  }
+}
+
+@inline(never)
+public func run_StridedCopy(N: Int) {
+  let count = 10_000
+  var src = [Int](repeating: 0, count: 4 * count)
+  for i in 0..<src.count {
+    src[i] = i
+  }
+  var dst = [Int](repeating: 0, count: count)
+  for _ in 0..<20*N {
+    copyStrided(src, &dst)
+  }
+  CheckResults(dst[count - 1] == 4 * (count - 1) + 1,
+               "Incorrect result in StridedCopy.")
+}
@@ -0,0 +1,71 @@
+//===--- WeakCache.swift --------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of a cache which holds its values weakly.
+// Most cached objects die while the cache still references them, so the
+// runtime has to deal with many weak references to deallocated objects.
+import TestsUtils
+
+final class CachedValue {
+  let key: Int
+  var payload: [Int]
+
+  init(key: Int) {
+    self.key = key
+    self.payload = [Int](repeating: key, count: 32)
+  }
+}
+
+struct WeakBox {
+  weak var value: CachedValue?
+}
+
+final class WeakValueCache {
+  var entries: [WeakBox]
+
+  init(capacity: Int) {
+    entries = [WeakBox](repeating: WeakBox(value: nil), count: capacity)
+  }
+
+  @inline(never)
+  func lookup(key: Int) -> CachedValue {
+    let slot = key % entries.count
+    if let value = entries[slot].value where value.key == key {
+      return value
+    }
+    let value = CachedValue(key: key)
+    entries[slot].value = value
+    return value
+  }
+}
+
+@inline(never)
+public func run_WeakCache(N: Int) {
+  let cache = WeakValueCache(capacity: 1024)
+  var live = [CachedValue]()
+  var sum = 0
+  for _ in 0..<N {
+    for key in 0..<10_000 {
+      let value = cache.lookup(key % 3_000)
+      sum = sum &+ value.key
+      // Keep every 16th value alive for a while; all others die immediately.
+      if key % 16 == 0 {
+        live.append(value)
+        if live.count > 64 {
+          _ = live.removeFirst()
+        }
+      }
+    }
+  }
+  CheckResults(sum == N &* 13_995_000,
+               "Incorrect results in WeakCache: \(sum)")
+}
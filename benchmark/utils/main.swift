@@ -37,6 +37,7 @@ import Calculator
 import CaptureProp
 import Chars
 import ClassArrayGetter
+import ClosureCapture
 import DeadArray
 import DictTest
 import DictTest2
@@ -45,9 +46,11 @@ import DictionaryBridge
 import DictionaryLiteral
 import DictionaryRemove
 import DictionarySwap
+import EnumMultiPayload
 import ErrorHandling
 import Fibonacci
 import GlobalClass
+import GlobalLet
 import Hanoi
 import Hash
 import Histogram
@@ -55,6 +58,7 @@ import Integrate
 import Join
 import LinkedList
 import MapReduce
+import MatrixMultiply
 import Memset
 import MonteCarloE
 import MonteCarloPi
@@ -82,8 +86,10 @@ import SortLettersInPlace
 import SortStrings
 import StackPromo
 import StaticArray
+import Stencil
 import StrComplexWalk
 import StrToInt
+import StridedCopy
 import StringBuilder
 import StringInterpolation
 import StringTests
@@ -93,6 +99,7 @@ import TwoSum
 import TypeFlood
 import UTF8Decode
 import Walsh
+import WeakCache
 import XorLoop
 
 precommitTests = [
@@ -117,6 +124,7 @@ precommitTests = [
   "CaptureProp": run_CaptureProp,
   "Chars": run_Chars,
   "ClassArrayGetter": run_ClassArrayGetter,
+  "ClosureCapture": run_ClosureCapture,
   "DeadArray": run_DeadArray,
   "Dictionary": run_Dictionary,
   "Dictionary2": run_Dictionary2,
@@ -125,8 +133,11 @@ precommitTests = [
   "DictionaryLiteral": run_DictionaryLiteral,
   "DictionaryRemove": run_DictionaryRemove,
   "DictionarySwap": run_DictionarySwap,
+  "EnumMultiPayloadInit": run_EnumMultiPayloadInit,
+  "EnumMultiPayloadSwitch": run_EnumMultiPayloadSwitch,
   "ErrorHandling": run_ErrorHandling,
   "GlobalClass": run_GlobalClass,
+  "GlobalLet": run_GlobalLet,
   "Hanoi": run_Hanoi,
   "HashTest": run_HashTest,
   "Histogram": run_Histogram,
@@ -134,6 +145,7 @@ precommitTests = [
   "Join": run_Join,
   "LinkedList": run_LinkedList,
   "MapReduce": run_MapReduce,
+  "MatrixMultiply": run_MatrixMultiply,
   "Memset": run_Memset,
   "MonteCarloE": run_MonteCarloE,
   "MonteCarloPi": run_MonteCarloPi,
@@ -165,8 +177,10 @@ precommitTests = [
   "SortStrings": run_SortStrings,
   "StackPromo": run_StackPromo,
   "StaticArray": run_StaticArray,
+  "Stencil": run_Stencil,
   "StrComplexWalk": run_StrComplexWalk,
   "StrToInt": run_StrToInt,
+  "StridedCopy": run_StridedCopy,
   "StringBuilder": run_StringBuilder,
   "StringInterpolation": run_StringInterpolation,
   "StringWalk": run_StringWalk,
@@ -176,6 +190,7 @@ precommitTests = [
   "TypeFlood": run_TypeFlood,
   "UTF8Decode": run_UTF8Decode,
   "Walsh": run_Walsh,
+  "WeakCache": run_WeakCache,
   "XorLoop": run_XorLoop,
 ]
 
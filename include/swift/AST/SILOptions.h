@@ -95,6 +95,10 @@ public:
   /// Emit a mapping of profile counters for use in coverage.
   bool EmitProfileCoverageMapping = false;
 
+  /// The path of an indexed profile file which is used to guide optimizations.
+  /// Empty if no profile should be used.
+  std::string UseProfile;
+
   /// Should we use a pass pipeline passed in via a json file? Null by default.
   StringRef ExternalPassPipelineFilename;
   
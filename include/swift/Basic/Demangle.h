@@ -13,7 +13,9 @@
 #ifndef SWIFT_BASIC_DEMANGLE_H
 #define SWIFT_BASIC_DEMANGLE_H
 
+#include <algorithm>
 #include <memory>
+#include <new>
 #include <string>
 #include <vector>
 #include <cassert>
@@ -67,7 +69,8 @@ struct DemangleOptions {
 };
 
 class Node;
-typedef std::shared_ptr<Node> NodePointer;
+class NodeFactory;
+typedef Node *NodePointer;
 
 enum class FunctionSigSpecializationParamKind : unsigned {
   // Option Flags use bits 0-5. This give us 6 bits implying 64 entries to
@@ -133,7 +136,13 @@ enum class Directness {
   Direct, Indirect
 };
 
-class Node : public std::enable_shared_from_this<Node> {
+/// A node in a demangled parse tree.
+///
+/// Nodes are allocated by a NodeFactory and are freed all at once when the
+/// factory is cleared or destroyed. The text payload and the children array
+/// of a node live in the same arena as the node itself, so nodes are trivially
+/// destructible.
+class Node {
 public:
   enum class Kind : uint16_t {
 #define NODE(ID) ID,
@@ -150,40 +159,49 @@ private:
   };
   PayloadKind NodePayloadKind;
 
+  uint32_t NumChildren = 0;
+  uint32_t ReservedChildren = 0;
+
   union {
-    std::string TextPayload;
+    struct {
+      const char *Data;
+      size_t Length;
+    } TextPayload;
     IndexType IndexPayload;
   };
 
-  // FIXME: use allocator.
-  typedef std::vector<NodePointer> NodeVector;
-  NodeVector Children;
+  NodePointer *Children = nullptr;
 
-  Node(Kind k)
-      : NodeKind(k), NodePayloadKind(PayloadKind::None) {
+  /// The factory which allocated this node. It is needed to grow the
+  /// children array.
+  NodeFactory &Factory;
+
+  Node(NodeFactory &F, Kind k)
+      : NodeKind(k), NodePayloadKind(PayloadKind::None), Factory(F) {
   }
-  Node(Kind k, std::string &&t)
-      : NodeKind(k), NodePayloadKind(PayloadKind::Text) {
-    new (&TextPayload) std::string(std::move(t));
+  Node(NodeFactory &F, Kind k, llvm::StringRef t)
+      : NodeKind(k), NodePayloadKind(PayloadKind::Text), Factory(F) {
+    TextPayload.Data = t.data();
+    TextPayload.Length = t.size();
   }
-  Node(Kind k, IndexType index)
-      : NodeKind(k), NodePayloadKind(PayloadKind::Index) {
+  Node(NodeFactory &F, Kind k, IndexType index)
+      : NodeKind(k), NodePayloadKind(PayloadKind::Index), Factory(F) {
     IndexPayload = index;
   }
   Node(const Node &) = delete;
   Node &operator=(const Node &) = delete;
 
-  friend struct NodeFactory;
+  friend class NodeFactory;
 
 public:
-  ~Node();
-
   Kind getKind() const { return NodeKind; }
 
   bool hasText() const { return NodePayloadKind == PayloadKind::Text; }
-  const std::string &getText() const {
+
+  /// Returns the text payload. The text is always null terminated.
+  llvm::StringRef getText() const {
     assert(hasText());
-    return TextPayload;
+    return llvm::StringRef(TextPayload.Data, TextPayload.Length);
   }
 
   bool hasIndex() const { return NodePayloadKind == PayloadKind::Index; }
@@ -192,46 +210,156 @@ public:
     return IndexPayload;
   }
   
-  typedef NodeVector::iterator iterator;
-  typedef NodeVector::const_iterator const_iterator;
-  typedef NodeVector::size_type size_type;
-
-  bool hasChildren() const { return !Children.empty(); }
-  size_t getNumChildren() const { return Children.size(); }
-  iterator begin() { return Children.begin(); }
-  iterator end() { return Children.end(); }
-  const_iterator begin() const { return Children.begin(); }
-  const_iterator end() const { return Children.end(); }
-
-  NodePointer getFirstChild() const { return Children.front(); }
-  NodePointer getChild(size_t index) const { return Children[index]; }
+  typedef NodePointer *iterator;
+  typedef const NodePointer *const_iterator;
+  typedef size_t size_type;
+
+  bool hasChildren() const { return NumChildren != 0; }
+  size_t getNumChildren() const { return NumChildren; }
+  iterator begin() { return Children; }
+  iterator end() { return Children + NumChildren; }
+  const_iterator begin() const { return Children; }
+  const_iterator end() const { return Children + NumChildren; }
+
+  NodePointer getFirstChild() const {
+    assert(NumChildren > 0);
+    return Children[0];
+  }
+  NodePointer getChild(size_t index) const {
+    assert(index < NumChildren);
+    return Children[index];
+  }
 
   /// Add a new node as a child of this one.
   ///
   /// \param child - should have no parent or siblings
   /// \returns child
-  NodePointer addChild(NodePointer child) {
-    assert(child && "adding null child!");
-    Children.push_back(child);
-    return child;
-  }
+  inline NodePointer addChild(NodePointer child);
 
   /// A convenience method for adding two children at once.
   void addChildren(NodePointer child1, NodePointer child2) {
-    addChild(std::move(child1));
-    addChild(std::move(child2));
+    addChild(child1);
+    addChild(child2);
   }
 };
 
+/// An arena which owns demangled parse trees.
+///
+/// Nodes (including their texts and children arrays) are bump-allocated from
+/// slabs of memory. Nothing is freed until the factory is cleared or
+/// destroyed, which frees all nodes at once. Therefore a factory should be
+/// kept alive as long as any node created by it is in use.
+///
+/// A single factory can be reused for demangling many symbols: clear() keeps
+/// the most recently allocated slab, so that steady-state demangling does not
+/// call malloc at all.
+class NodeFactory {
+  /// The header of a slab. The allocatable memory follows the header.
+  struct Slab {
+    Slab *Previous;
+  };
+
+  enum : size_t {
+    InitialSlabSize = 4096,
+    MaxSlabSize = 1024 * 1024
+  };
+
+  /// The slab which is currently used for allocation.
+  Slab *CurrentSlab = nullptr;
+
+  /// The next free byte and the end of the current slab.
+  char *CurPtr = nullptr;
+  char *End = nullptr;
+
+  /// The size of the next slab, which is doubled for each new slab.
+  size_t NextSlabSize = InitialSlabSize;
+
+  void *allocateInNewSlab(size_t Size, size_t Alignment);
+
+  void freeSlabs(Slab *S);
+
+public:
+  NodeFactory() {}
+  NodeFactory(const NodeFactory &) = delete;
+  NodeFactory &operator=(const NodeFactory &) = delete;
+
+  ~NodeFactory() { freeSlabs(CurrentSlab); }
+
+  /// Frees all nodes which were created by this factory.
+  ///
+  /// All NodePointers which were handed out by the factory become invalid.
+  void clear();
+
+  /// Allocates \p Size bytes with \p Alignment in the arena.
+  void *allocate(size_t Size, size_t Alignment) {
+    uintptr_t Aligned = (uintptr_t(CurPtr) + Alignment - 1) &
+                        ~(uintptr_t(Alignment) - 1);
+    if (CurPtr && Aligned + Size <= uintptr_t(End)) {
+      CurPtr = reinterpret_cast<char *>(Aligned + Size);
+      return reinterpret_cast<void *>(Aligned);
+    }
+    return allocateInNewSlab(Size, Alignment);
+  }
+
+  template <typename T> T *allocate(size_t NumObjects = 1) {
+    return static_cast<T *>(allocate(sizeof(T) * NumObjects, alignof(T)));
+  }
+
+  /// Copies \p Text into the arena and null-terminates the copy.
+  llvm::StringRef copyString(llvm::StringRef Text) {
+    char *Mem = allocate<char>(Text.size() + 1);
+    std::copy(Text.begin(), Text.end(), Mem);
+    Mem[Text.size()] = '\0';
+    return llvm::StringRef(Mem, Text.size());
+  }
+
+  /// Grows the children array of \p N, so that at least one more child fits.
+  void growChildren(Node *N) {
+    uint32_t NewCapacity = N->ReservedChildren ? N->ReservedChildren * 2 : 4;
+    NodePointer *NewChildren = allocate<NodePointer>(NewCapacity);
+    std::copy(N->Children, N->Children + N->NumChildren, NewChildren);
+    N->Children = NewChildren;
+    N->ReservedChildren = NewCapacity;
+  }
+
+  NodePointer create(Node::Kind K) {
+    return new (allocate<Node>()) Node(*this, K);
+  }
+  NodePointer create(Node::Kind K, Node::IndexType Index) {
+    return new (allocate<Node>()) Node(*this, K, Index);
+  }
+  NodePointer create(Node::Kind K, llvm::StringRef Text) {
+    return new (allocate<Node>()) Node(*this, K, copyString(Text));
+  }
+  NodePointer create(Node::Kind K, const std::string &Text) {
+    return create(K, llvm::StringRef(Text));
+  }
+  template <size_t N>
+  NodePointer create(Node::Kind K, const char (&Text)[N]) {
+    return create(K, llvm::StringRef(Text));
+  }
+};
+
+inline NodePointer Node::addChild(NodePointer child) {
+  assert(child && "adding null child!");
+  if (NumChildren == ReservedChildren)
+    Factory.growChildren(this);
+  Children[NumChildren++] = child;
+  return child;
+}
+
 /// \brief Demangle the given string as a Swift symbol.
 ///
 /// Typical usage:
 /// \code
+///   NodeFactory Factory;
 ///   NodePointer aDemangledName =
-/// swift::Demangler::demangleSymbolAsNode("SomeSwiftMangledName")
+/// swift::Demangler::demangleSymbolAsNode("SomeSwiftMangledName", Factory)
 /// \endcode
 ///
 /// \param mangledName The mangled string.
+/// \param Factory The factory which allocates, and owns, the nodes of the
+/// parse tree.
 /// \param options An object encapsulating options to use to perform this demangling.
 ///
 ///
@@ -240,12 +368,15 @@ public:
 ///
 NodePointer
 demangleSymbolAsNode(const char *mangledName, size_t mangledNameLength,
+                     NodeFactory &Factory,
                      const DemangleOptions &options = DemangleOptions());
 
 inline NodePointer
 demangleSymbolAsNode(const std::string &mangledName,
+                     NodeFactory &Factory,
                      const DemangleOptions &options = DemangleOptions()) {
-  return demangleSymbolAsNode(mangledName.data(), mangledName.size(), options);
+  return demangleSymbolAsNode(mangledName.data(), mangledName.size(), Factory,
+                              options);
 }
 
 /// \brief Demangle the given string as a Swift symbol.
@@ -277,11 +408,14 @@ demangleSymbolAsString(const std::string &mangledName,
 ///
 /// Typical usage:
 /// \code
+///   NodeFactory Factory;
 ///   NodePointer aDemangledName =
-/// swift::Demangler::demangleTypeAsNode("SomeSwiftMangledName")
+/// swift::Demangler::demangleTypeAsNode("SomeSwiftMangledName", Factory)
 /// \endcode
 ///
 /// \param mangledName The mangled string.
+/// \param Factory The factory which allocates, and owns, the nodes of the
+/// parse tree.
 /// \param options An object encapsulating options to use to perform this demangling.
 ///
 ///
@@ -290,12 +424,15 @@ demangleSymbolAsString(const std::string &mangledName,
 ///
 NodePointer
 demangleTypeAsNode(const char *mangledName, size_t mangledNameLength,
+                   NodeFactory &Factory,
                    const DemangleOptions &options = DemangleOptions());
 
 inline NodePointer
 demangleTypeAsNode(const std::string &mangledName,
+                   NodeFactory &Factory,
                    const DemangleOptions &options = DemangleOptions()) {
-  return demangleTypeAsNode(mangledName.data(), mangledName.size(), options);
+  return demangleTypeAsNode(mangledName.data(), mangledName.size(), Factory,
+                            options);
 }
 
 /// \brief Demangle the given string as a Swift type mangling.
@@ -330,7 +467,7 @@ void mangleIdentifier(const char *data, size_t length,
 /// \brief Remangle a demangled parse tree.
 ///
 /// This should always round-trip perfectly with demangleSymbolAsNode.
-std::string mangleNode(const NodePointer &root);
+std::string mangleNode(NodePointer root);
 
 /// \brief Transform the node structure in a string.
 ///
@@ -348,25 +485,6 @@ std::string mangleNode(const NodePointer &root);
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
-struct NodeFactory {
-  static NodePointer create(Node::Kind K) {
-    return NodePointer(new Node(K));
-  }
-  static NodePointer create(Node::Kind K, Node::IndexType Index) {
-    return NodePointer(new Node(K, Index));
-  }
-  static NodePointer create(Node::Kind K, llvm::StringRef Text) {
-    return NodePointer(new Node(K, Text));
-  }
-  static NodePointer create(Node::Kind K, std::string &&Text) {
-    return NodePointer(new Node(K, std::move(Text)));
-  }
-  template <size_t N>
-  static NodePointer create(Node::Kind K, const char (&Text)[N]) {
-    return NodePointer(new Node(K, llvm::StringRef(Text)));
-  }
-};
-
   /// A class for printing to a std::string.
 class DemanglerPrinter {
 public:
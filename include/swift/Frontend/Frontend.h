@@ -313,6 +313,9 @@ class CompilerInstance {
 
   SourceFile *PrimarySourceFile = nullptr;
 
+  /// The declaration which contained the code completion point, if any.
+  Optional<PersistentParserState::DelayedDeclInfo> CodeCompletionDecl;
+
   void createSILModule(bool WholeModule = false);
   void setPrimarySourceFile(SourceFile *SF);
 
@@ -386,6 +389,16 @@ public:
   /// \returns the primary SourceFile, or nullptr if there is no primary input
   SourceFile *getPrimarySourceFile() { return PrimarySourceFile; }
 
+  /// Returns the declaration which contained the code completion point and
+  /// was parsed after type-checking the rest of the input files, or None if
+  /// this is not a code completion invocation.
+  ///
+  /// The declaration can be parsed again with
+  /// \c performCodeCompletionReparse.
+  Optional<PersistentParserState::DelayedDeclInfo> getCodeCompletionDecl() {
+    return CodeCompletionDecl;
+  }
+
   /// \brief Returns true if there was an error during setup.
   bool setup(const CompilerInvocation &Invocation);
 
@@ -688,7 +688,9 @@ public:
   }
 
   ParserStatus parseDecl(SmallVectorImpl<Decl*> &Entries, ParseDeclOptions Flags);
-  void parseDeclDelayed();
+  /// Parses the delayed declaration. Returns false if the declaration ended
+  /// before the end of the delayed range.
+  bool parseDeclDelayed();
 
   ParserResult<TypeDecl> parseDeclTypeAlias(bool WantDefinition,
                                             bool isAssociatedType,
@@ -73,6 +73,16 @@ public:
     Decl,
   };
 
+  /// Describes the declaration which was delayed for code completion, without
+  /// its parser scope.
+  struct DelayedDeclInfo {
+    DelayedDeclKind Kind;
+    unsigned Flags;
+    DeclContext *ParentContext;
+    SourceRange BodyRange;
+    SourceLoc PreviousLoc;
+  };
+
   class DelayedDeclState {
     friend class PersistentParserState;
     friend class Parser;
@@ -156,6 +166,11 @@ public:
   DeclContext *getDelayedDeclContext() {
     return CodeCompletionDelayedDeclState->ParentContext;
   }
+  DelayedDeclInfo getDelayedDeclInfo() {
+    auto &State = *CodeCompletionDelayedDeclState;
+    return { State.Kind, State.Flags, State.ParentContext,
+             { State.BodyPos.Loc, State.BodyEnd }, State.BodyPos.PrevLoc };
+  }
   std::unique_ptr<DelayedDeclState> takeDelayedDeclState() {
     return std::move(CodeCompletionDelayedDeclState);
   }
@@ -77,7 +77,8 @@ class ReflectionContext {
   void dumpTypeRef(const std::string &MangledName,
                    std::ostream &OS, bool printTypeName = false) const {
     auto TypeName = Demangle::demangleTypeAsString(MangledName);
-    auto DemangleTree = Demangle::demangleTypeAsNode(MangledName);
+    Demangle::NodeFactory Factory;
+    auto DemangleTree = Demangle::demangleTypeAsNode(MangledName, Factory);
     auto TR = TypeRef::fromDemangleNode(DemangleTree);
     OS << TypeName << '\n';
     TR->dump(OS);
@@ -184,7 +185,9 @@ public:
           continue;
 
         auto SubstitutedTypeName = AssocTy.getMangledSubstitutedTypeName();
-        auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName);
+        Demangle::NodeFactory Factory;
+        auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName,
+                                                      Factory);
         return TypeRef::fromDemangleNode(Demangled);
       }
     }
@@ -390,7 +393,8 @@ public:
     if (MangledName.empty())
       return nullptr;
 
-    auto DemangleNode = Demangle::demangleTypeAsNode(MangledName);
+    Demangle::NodeFactory Factory;
+    auto DemangleNode = Demangle::demangleTypeAsNode(MangledName, Factory);
     if (!DemangleNode)
       return nullptr;
 
@@ -479,7 +483,8 @@ public:
         auto MangledName = Reader.readString(ProtocolDescriptor->Name);
         if (MangledName.empty())
           return nullptr;
-        auto Demangled = Demangle::demangleSymbolAsNode(MangledName);
+        Demangle::NodeFactory Factory;
+        auto Demangled = Demangle::demangleSymbolAsNode(MangledName, Factory);
         auto Protocol = TypeRef::fromDemangleNode(Demangled);
         if (!llvm::isa<ProtocolTypeRef>(Protocol.get()))
           return nullptr;
@@ -535,6 +540,7 @@ public:
     if (MangledName.empty())
       return {};
 
+    Demangle::NodeFactory Factory;
     for (auto Info : ReflectionInfos) {
       for (auto &FieldDescriptor : Info.fieldmd) {
         auto CandidateMangledName = FieldDescriptor.MangledTypeName.get();
@@ -542,7 +548,8 @@ public:
           continue;
         for (auto &Field : FieldDescriptor) {
           auto Demangled
-            = Demangle::demangleTypeAsNode(Field.getMangledTypeName());
+            = Demangle::demangleTypeAsNode(Field.getMangledTypeName(),
+                                           Factory);
           auto Unsubstituted = TypeRef::fromDemangleNode(Demangled);
           if (!Unsubstituted)
             return {};
@@ -576,6 +576,10 @@ static inline void swift_unownedTakeAssign(UnownedReference *dest,
 /*****************************************************************************/
 
 /// A weak reference value object.  This is ABI.
+///
+/// For native Swift objects, Value is not the object itself but refers to the
+/// object's side table entry, which is managed by the runtime. It must only be
+/// accessed with the swift_weak* and swift_unknownWeak* functions.
 struct WeakReference {
   HeapObject *Value;
 };
@@ -1996,7 +1996,10 @@ struct TargetEnumMetadata : public TargetValueMetadata<Runtime> {
 
   /// Retrieve the size of the payload area.
   ///
-  /// `hasPayloadSize` must be true for this to be valid.
+  /// `hasPayloadSize` must be true for this to be valid. For multi-payload
+  /// enums whose metadata was initialized by the runtime, the high byte of
+  /// this word may additionally cache the layout of the tag; see
+  /// swift_initEnumMetadataMultiPayload.
   StoredSize getPayloadSize() const {
     assert(hasPayloadSize());
     auto offset = this->Description->Enum.getPayloadSizeOffset();
@@ -3336,6 +3339,38 @@ extern "C"
 const WitnessTable *swift_conformsToProtocol(const Metadata *type,
                                             const ProtocolDescriptor *protocol);
 
+/// An entry of the inline cache of a cast to a protocol type, which is
+/// followed by the witness tables of the conformances of Type to the protocols
+/// of the cast.
+///
+/// Entries are immutable and never freed, so they can be read without any
+/// synchronization once they are stored in a cache.
+struct DynamicCastInlineCacheEntry {
+  const Metadata *Type;
+
+  const WitnessTable **getWitnessTables() {
+    return reinterpret_cast<const WitnessTable **>(this + 1);
+  }
+};
+
+/// Fill the inline cache of a cast site, which is emitted by the compiler for
+/// casts of class instances and metatypes to protocol types.
+///
+/// The cache is monomorphic: only the first successful cast fills it, so that
+/// polymorphic cast sites don't allocate a new entry for every cast.
+///
+/// \param cache The cache variable of the cast site.
+/// \param type The type whose conformances were looked up.
+/// \param witnessTables The witness tables of the conformances, in the order
+///                      of the protocols of the cast.
+/// \param numWitnessTables The number of witness tables.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+void swift_dynamicCastFillInlineCache(DynamicCastInlineCacheEntry **cache,
+                                      const Metadata *type,
+                                      const WitnessTable * const *witnessTables,
+                                      size_t numWitnessTables);
+
 /// Register a block of protocol conformance records for dynamic lookup.
 SWIFT_RUNTIME_EXPORT
 extern "C"
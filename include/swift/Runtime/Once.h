@@ -18,7 +18,7 @@
 #define SWIFT_RUNTIME_ONCE_H
 
 #include "swift/Runtime/HeapObject.h"
-#include <mutex>
+#include <stdint.h>
 
 namespace swift {
 
@@ -27,18 +27,19 @@ namespace swift {
 // On OS X and iOS, swift_once_t matches dispatch_once_t.
 typedef long swift_once_t;
 
-#elif defined(__CYGWIN__)
-
-// On Cygwin, std::once_flag can not be used because it is larger than the
-// platform word.
-typedef uintptr_t swift_once_t;
 #else
 
-// On other platforms swift_once_t is std::once_flag
-typedef std::once_flag swift_once_t;
+// On other platforms swift_once_t is a word which is managed by swift_once.
+typedef uintptr_t swift_once_t;
 
 #endif
 
+/// The value of a swift_once_t predicate once the initialization has
+/// completed. This is ABI: the compiler checks for this value inline and only
+/// calls swift_once if the predicate has a different value. On Apple platforms
+/// this is the "done" value of dispatch_once.
+static const swift_once_t SwiftOnceDone = ~swift_once_t(0);
+
 /// Runs the given function with the given context argument exactly once.
 /// The predicate argument must point to a global or static variable of static
 /// extent of type swift_once_t.
@@ -0,0 +1,56 @@
+//===--- Statistics.h - Swift runtime statistics ----------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counters of runtime events, such as metadata instantiations and conformance
+// cache misses. The counters are always maintained; each thread counts into
+// its own set of counters, which are only summed up when the statistics are
+// queried.
+//
+// If the environment variable SWIFT_RUNTIME_DUMP_STATISTICS is set, the
+// statistics are printed to stderr when the process exits.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_STATISTICS_H
+#define SWIFT_RUNTIME_STATISTICS_H
+
+#include "swift/Runtime/Config.h"
+#include <stdint.h>
+
+namespace swift {
+
+/// The values of all runtime counters. See Statistics.def for the meaning
+/// of the fields.
+struct RuntimeStatistics {
+#define RUNTIME_STATISTIC(Id, Description) uint64_t Id;
+#include "swift/Runtime/Statistics.def"
+};
+
+/// \brief Fill in the counters of all threads, including threads which have
+/// already exited, since the last call to swift_resetRuntimeStatistics.
+///
+/// Threads which are running concurrently may or may not have their most
+/// recent events included.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_getRuntimeStatistics(RuntimeStatistics *statistics);
+
+/// \brief Reset all counters to zero.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_resetRuntimeStatistics();
+
+/// \brief Print the current counters to stderr.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_dumpRuntimeStatistics();
+
+} // end namespace swift
+
+#endif
@@ -143,6 +143,14 @@ private:
   /// The function's effects attribute.
   EffectsKind EffectsKindAttr;
 
+  /// A compact summary of the function's side-effects, computed by the
+  /// optimizer of the defining module and serialized with the function's
+  /// declaration. It lets client modules reason about calls to the function
+  /// without having its body. Empty if there is no summary.
+  ///
+  /// The encoding is defined by SideEffectAnalysis.
+  llvm::SmallVector<uint8_t, 4> EffectsSummary;
+
   /// True if this function is inlined at least once. This means that the
   /// debug info keeps a pointer to this function.
   bool Inlined = false;
@@ -448,6 +456,17 @@ public:
     EffectsKindAttr = E;
   }
 
+  /// \return True if a side-effect summary is attached to the function.
+  bool hasEffectsSummary() const { return !EffectsSummary.empty(); }
+
+  /// \return The side-effect summary of the function. See EffectsSummary.
+  ArrayRef<uint8_t> getEffectsSummary() const { return EffectsSummary; }
+
+  /// \brief Set the side-effect summary of the function.
+  void setEffectsSummary(ArrayRef<uint8_t> Summary) {
+    EffectsSummary.assign(Summary.begin(), Summary.end());
+  }
+
   /// Get this function's global_init attribute.
   ///
   /// The implied semantics are:
@@ -636,6 +636,11 @@ class ApplyInstBase<Impl, Base, false> : public Base {
   /// error result but is not actually throwing.
   bool NonThrowing;
 
+  /// Used for partial_apply instructions: true if the context can be
+  /// allocated on the stack. This can't be a StackPromotable base class,
+  /// because the tail-allocated operands must follow this class' storage.
+  bool OnStack;
+
   /// The fixed operand is the callee;  the rest are arguments.
   TailAllocatedOperandList<1> Operands;
 
@@ -654,7 +659,7 @@ protected:
                 ArrayRef<SILValue> args, As... baseArgs)
       : Base(kind, DebugLoc, baseArgs...), SubstCalleeType(substCalleeType),
         NumSubstitutions(substitutions.size()), NonThrowing(false),
-        Operands(this, args, callee) {
+        OnStack(false), Operands(this, args, callee) {
     static_assert(sizeof(Impl) == sizeof(*this),
         "subclass has extra storage, cannot use TailAllocatedOperandList");
     memcpy(getSubstitutionsStorage(), substitutions.begin(),
@@ -674,7 +679,11 @@ protected:
   void setNonThrowing(bool isNonThrowing) { NonThrowing = isNonThrowing; }
   
   bool isNonThrowingApply() const { return NonThrowing; }
-  
+
+  void setOnStack(bool isOnStack) { OnStack = isOnStack; }
+
+  bool isOnStack() const { return OnStack; }
+
 public:
   /// The operand number of the first argument.
   static unsigned getArgumentOperandNumber() { return 1; }
@@ -918,6 +927,10 @@ public:
 
 /// PartialApplyInst - Represents the creation of a closure object by partial
 /// application of a function value.
+///
+/// If the closure does not escape, the context can be allocated on the stack.
+/// In this case the [stack] attribute is set and a dealloc_ref [stack] marks
+/// the end of the context's lifetime, like for alloc_ref.
 class PartialApplyInst
     : public ApplyInstBase<PartialApplyInst, SILInstruction> {
   friend class SILBuilder;
@@ -925,13 +938,14 @@ class PartialApplyInst
   PartialApplyInst(SILDebugLocation DebugLoc, SILValue Callee,
                    SILType SubstCalleeType,
                    ArrayRef<Substitution> Substitutions,
-                   ArrayRef<SILValue> Args, SILType ClosureType);
+                   ArrayRef<SILValue> Args, SILType ClosureType,
+                   bool canBeOnStack);
 
   static PartialApplyInst *create(SILDebugLocation DebugLoc, SILValue Callee,
                                   SILType SubstCalleeType,
                                   ArrayRef<Substitution> Substitutions,
                                   ArrayRef<SILValue> Args, SILType ClosureType,
-                                  SILFunction &F);
+                                  SILFunction &F, bool canBeOnStack);
 
 public:
   /// Return the ast level function type of this partial apply.
@@ -939,6 +953,12 @@ public:
     return getType().castTo<SILFunctionType>();
   }
 
+  /// Returns true if the context can be allocated on the stack (the final
+  /// decision is in IRGen). See StackPromotable.
+  bool canAllocOnStack() const { return isOnStack(); }
+
+  void setStackAllocatable() { setOnStack(true); }
+
   static bool classof(const ValueBase *V) {
     return V->getKind() == ValueKind::PartialApplyInst;
   }
@@ -0,0 +1,111 @@
+//===--- ProfileAnalysis.h - Execution counts from a profile ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This analysis provides function entry counts which are read from an indexed
+// profile file (as produced by llvm-profdata from the output of a program
+// which was compiled with -profile-generate).
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SILOPTIMIZER_ANALYSIS_PROFILEANALYSIS_H
+#define SWIFT_SILOPTIMIZER_ANALYSIS_PROFILEANALYSIS_H
+
+#include "swift/SILOptimizer/Analysis/Analysis.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
+#include <memory>
+
+namespace llvm {
+class IndexedInstrProfReader;
+}
+
+namespace swift {
+
+class SILModule;
+class SILFunction;
+
+/// Provides the execution counts of functions, based on the profile file
+/// which is specified with the -profile-use option.
+///
+/// If no profile is specified (or the profile can't be read) no counts are
+/// available and all queries return None.
+class ProfileAnalysis : public SILAnalysis {
+  SILModule *M;
+
+  /// The reader for the indexed profile. Null if there is no profile.
+  std::unique_ptr<llvm::IndexedInstrProfReader> Reader;
+
+  /// True if we already tried to read the profile file.
+  bool ProfileRead = false;
+
+  /// The largest function entry count in the profile.
+  uint64_t MaxEntryCount = 0;
+
+  /// Caches the entry counts of already queried functions. None is cached for
+  /// functions which are not contained in the profile.
+  ///
+  /// The cache is keyed by the function name and not the SILFunction itself,
+  /// because the profile data does not change if functions are deleted.
+  llvm::StringMap<llvm::Optional<uint64_t>> EntryCounts;
+
+  /// Tries to open the profile file. On failure a diagnostic is emitted.
+  ///
+  /// The profile is read lazily on the first query, so that pass managers
+  /// which don't use profile information don't pay for it.
+  void readProfile();
+
+  void ensureProfileRead() {
+    if (!ProfileRead)
+      readProfile();
+  }
+
+public:
+  ProfileAnalysis(SILModule *M);
+
+  ~ProfileAnalysis();
+
+  static bool classof(const SILAnalysis *S) {
+    return S->getKind() == AnalysisKind::Profile;
+  }
+
+  virtual void invalidate(SILAnalysis::InvalidationKind K) override {
+    // The profile does not depend on the SIL, so nothing can invalidate it.
+  }
+
+  virtual void invalidate(SILFunction *F,
+                          SILAnalysis::InvalidationKind K) override { }
+
+  /// Returns true if a profile is available.
+  bool hasProfile() {
+    ensureProfileRead();
+    return Reader != nullptr;
+  }
+
+  /// Returns the number of times \p F was entered in the profiled run, or
+  /// None if the function is not contained in the profile.
+  llvm::Optional<uint64_t> getEntryCount(SILFunction *F);
+
+  /// Returns true if \p F is contained in the profile and its entry count is
+  /// at least \p PerMille / 1000 of the maximum function entry count.
+  bool isHot(SILFunction *F, unsigned PerMille);
+
+  /// Returns true if \p F is contained in the profile, but was never executed
+  /// in the profiled run.
+  bool isNeverExecuted(SILFunction *F) {
+    auto Count = getEntryCount(F);
+    return Count.hasValue() && Count.getValue() == 0;
+  }
+};
+
+} // end namespace swift
+
+#endif
@@ -19,6 +19,7 @@
 #include "swift/SILOptimizer/Analysis/ArraySemantic.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 
 namespace swift {
@@ -318,10 +319,20 @@ private:
   /// Callee analysis, used for determining the callees at call sites.
   BasicCalleeAnalysis *BCA;
 
+  /// External functions for which we already tried to load a side-effect
+  /// summary from the defining module.
+  llvm::SmallPtrSet<SILFunction *, 16> SummaryLookups;
+
   /// Get the side-effects of a function, which has an @effects attribute.
   /// Returns true if \a F has an @effects attribute which could be handled.
   static bool getDefinedEffects(FunctionEffects &Effects, SILFunction *F);
   
+  /// Get the side-effects of an external function from the side-effect
+  /// summary which was serialized with its declaration. \p Effects must
+  /// already have one parameter entry per argument of the call.
+  /// Returns true if \p F has a summary which matches the call.
+  bool getSummaryEffects(FunctionEffects &Effects, SILFunction *F);
+
   /// Get the side-effects of a semantic call.
   /// Return true if \p ASC could be handled.
   bool getSemanticEffects(FunctionEffects &Effects, ArraySemanticsCall ASC);
@@ -374,6 +385,17 @@ public:
 
   /// Get the side-effects of a call site.
   void getEffects(FunctionEffects &ApplyEffects, FullApplySite FAS);
+
+  /// Encodes \p FE into a compact summary, which can be attached to a
+  /// SILFunction and serialized. The summary consists of a byte of flags, a
+  /// byte for the global effects and a byte for each parameter.
+  static void encodeSummary(const FunctionEffects &FE,
+                            SmallVectorImpl<uint8_t> &Summary);
+
+  /// Decodes a summary, which was created by encodeSummary, into \p FE.
+  /// Returns false if the summary is malformed or does not match the number
+  /// of parameters in \p FE.
+  static bool decodeSummary(FunctionEffects &FE, ArrayRef<uint8_t> Summary);
   
   /// No invalidation is needed. See comment for SideEffectAnalysis.
   virtual void invalidate(InvalidationKind K) override;
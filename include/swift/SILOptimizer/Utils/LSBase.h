@@ -31,12 +31,15 @@
 #include "swift/SIL/Projection.h"
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
 #include "swift/SILOptimizer/Analysis/EscapeAnalysis.h"
+#include "swift/SILOptimizer/Analysis/PostOrderAnalysis.h"
 #include "swift/SILOptimizer/Analysis/TypeExpansionAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/Utils/Local.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
 #include <utility> 
@@ -371,12 +374,67 @@ public:
                                    LSLocationBaseMap &BaseToLoc,
                                    TypeExpansionAnalysis *TE,
                                    std::pair<int, int> &LSCount);
+
+  /// Collect the basic blocks of \p F which can have a non-empty genset or
+  /// killset for \p LSLocationVault, i.e. blocks which access memory or
+  /// define the base of a location. All other blocks are transparent to the
+  /// load store data flows and don't need to be scanned.
+  static void
+  collectRelevantBlocks(SILFunction &F,
+                        const std::vector<LSLocation> &LSLocationVault,
+                        llvm::SmallPtrSetImpl<SILBasicBlock *> &Blocks);
 };
 
 static inline llvm::hash_code hash_value(const LSLocation &L) {
   return llvm::hash_combine(hash_value((LSBase)L));
 }
 
+//===----------------------------------------------------------------------===//
+//                         Load Store Data Flow Worklist
+//===----------------------------------------------------------------------===//
+
+/// The direction in which a load store data flow propagates its sets. RLE
+/// propagates available values from predecessors to successors, DSE
+/// propagates live stores from successors to predecessors.
+enum class LSDataFlowDirection { Forward, Backward };
+
+/// The worklist for the iterative genset/killset data flows of RLE and DSE.
+///
+/// Pending blocks are always popped in the natural order of the data flow,
+/// i.e. in reverse post order for a forward and in post order for a backward
+/// data flow. After the initial sweep, a block is only revisited if the
+/// out-set of one of its inputs has changed, so that the cost of the data flow
+/// is proportional to the amount of change instead of the function size.
+/// Unreachable blocks are never processed.
+class LSDataFlowWorklist {
+  PostOrderFunctionInfo *PO;
+  LSDataFlowDirection Direction;
+
+  /// The ith bit is set if the ith block in data flow order is pending.
+  llvm::BitVector Pending;
+
+  /// Returns the position of \p BB in data flow order, if it is reachable.
+  Optional<unsigned> getIndex(SILBasicBlock *BB) const {
+    if (Direction == LSDataFlowDirection::Forward)
+      return PO->getRPONumber(BB);
+    return PO->getPONumber(BB);
+  }
+
+public:
+  /// Constructs a worklist with all reachable blocks pending.
+  LSDataFlowWorklist(PostOrderFunctionInfo *PO, LSDataFlowDirection Direction)
+      : PO(PO), Direction(Direction), Pending(PO->size(), true) {}
+
+  bool empty() const { return Pending.none(); }
+
+  /// Remove and return the first pending block in data flow order.
+  SILBasicBlock *pop();
+
+  /// Add the blocks which consume the out-set of \p BB to the worklist, i.e.
+  /// its successors in a forward and its predecessors in a backward data flow.
+  void pushDependents(SILBasicBlock *BB);
+};
+
 } // end swift namespace
 
 /// LSLocation and LSValue are used in DenseMap.
@@ -19,6 +19,7 @@
 
 #include "swift/Basic/LLVM.h"
 #include "swift/Basic/OptionSet.h"
+#include "swift/Parse/PersistentParserState.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
@@ -49,7 +50,6 @@ namespace swift {
   class LangOptions;
   class ModuleDecl;
   class Parser;
-  class PersistentParserState;
   class SerializationOptions;
   class SILOptions;
   class SILModule;
@@ -119,6 +119,26 @@ namespace swift {
                              PersistentParserState &PersistentState,
                              CodeCompletionCallbacksFactory *Factory);
 
+  /// \brief Parse the declaration which contained the code completion point
+  /// again, from the code completion buffer \p BufferID, and run code
+  /// completion on it.
+  ///
+  /// This repeats code completion in an edited version of the declaration
+  /// without parsing and type-checking the rest of \p SF again. The rest of
+  /// the buffer must not have changed since \p SF was parsed, and \p Info
+  /// must refer to the locations in the new buffer.
+  ///
+  /// The lexical scope of the original parse is not available, so this is
+  /// only correct for declarations in library source files.
+  ///
+  /// \returns false, without running code completion, if the edited
+  /// declaration ends before the end of \p Info's range. Then the rest of
+  /// the buffer must be parsed again, too.
+  bool performCodeCompletionReparse(
+      SourceFile &SF, unsigned BufferID,
+      const PersistentParserState::DelayedDeclInfo &Info,
+      CodeCompletionCallbacksFactory *Factory);
+
   /// \brief Lex and return a vector of tokens for the given buffer.
   std::vector<Token> tokenize(const LangOptions &LangOpts,
                               const SourceManager &SM, unsigned BufferID,
@@ -22,6 +22,7 @@
 #include "swift/Basic/UUID.h"
 #include "llvm/ADT/StringRef.h"
 #include <functional>
+#include <type_traits>
 #include <vector>
 #include <cstdio>
 #include <cstdlib>
@@ -90,25 +91,45 @@ struct QuotedString {
 
 } // end unnamed namespace
 
-Node::~Node() {
-  switch (NodePayloadKind) {
-  case PayloadKind::None: return;
-  case PayloadKind::Index: return;
-  case PayloadKind::Text: TextPayload.~basic_string(); return;
+static_assert(std::is_trivially_destructible<Node>::value,
+              "nodes are freed without running their destructors");
+
+void *NodeFactory::allocateInNewSlab(size_t Size, size_t Alignment) {
+  size_t SlabSize = std::max(size_t(NextSlabSize),
+                             sizeof(Slab) + Size + Alignment - 1);
+  if (NextSlabSize < MaxSlabSize)
+    NextSlabSize *= 2;
+
+  auto *NewSlab = static_cast<Slab *>(malloc(SlabSize));
+  if (!NewSlab)
+    unreachable("out of memory allocating demangle nodes");
+  NewSlab->Previous = CurrentSlab;
+  CurrentSlab = NewSlab;
+  CurPtr = reinterpret_cast<char *>(NewSlab + 1);
+  End = reinterpret_cast<char *>(NewSlab) + SlabSize;
+
+  void *Mem = allocate(Size, Alignment);
+  assert(Mem && "new slab must fit the allocation");
+  return Mem;
+}
+
+void NodeFactory::freeSlabs(Slab *S) {
+  while (S) {
+    Slab *Previous = S->Previous;
+    free(S);
+    S = Previous;
   }
-  unreachable("bad payload kind");
 }
 
-namespace {
-  struct FindPtr {
-    FindPtr(Node *v) : Target(v) {}
-    bool operator()(NodePointer sp) const {
-      return sp.get() == Target;
-    }
-  private:
-    Node *Target;
-  };
-} // end anonymous namespace
+void NodeFactory::clear() {
+  if (!CurrentSlab)
+    return;
+  // Keep the current slab, which is the largest one, for the next round of
+  // allocations and free all the others.
+  freeSlabs(CurrentSlab->Previous);
+  CurrentSlab->Previous = nullptr;
+  CurPtr = reinterpret_cast<char *>(CurrentSlab + 1);
+}
 
 static bool isStartOfIdentifier(char c) {
   if (c >= '0' && c <= '9')
@@ -296,8 +317,10 @@ static StringRef toString(ValueWitnessKind k) {
 class Demangler {
   std::vector<NodePointer> Substitutions;
   NameSource Mangled;
+  NodeFactory &Factory;
 public:  
-  Demangler(llvm::StringRef mangled) : Mangled(mangled) {}
+  Demangler(llvm::StringRef mangled, NodeFactory &Factory)
+    : Mangled(mangled), Factory(Factory) {}
 
 /// Try to demangle a child node of the given kind.  If that fails,
 /// return; otherwise add it to the parent.
@@ -312,8 +335,8 @@ public:
 #define DEMANGLE_CHILD_AS_NODE_OR_RETURN(PARENT, CHILD_KIND) do {  \
     auto _kind = demangle##CHILD_KIND();                           \
     if (!_kind.hasValue()) return nullptr;                         \
-    (PARENT)->addChild(NodeFactory::create(Node::Kind::CHILD_KIND, \
-                                           unsigned(*_kind)));     \
+    (PARENT)->addChild(Factory.create(Node::Kind::CHILD_KIND,      \
+                                      unsigned(*_kind)));          \
   } while (false)
 
   /// Attempt to demangle the source string.  The root node will
@@ -326,7 +349,7 @@ public:
     if (!Mangled.nextIf("_T"))
       return nullptr;
 
-    NodePointer topLevel = NodeFactory::create(Node::Kind::Global);
+    NodePointer topLevel = Factory.create(Node::Kind::Global);
 
     // First demangle any specialization prefixes.
     if (Mangled.nextIf("TS")) {
@@ -343,24 +366,24 @@ public:
         return nullptr;
 
     } else if (Mangled.nextIf("To")) {
-      topLevel->addChild(NodeFactory::create(Node::Kind::ObjCAttribute));
+      topLevel->addChild(Factory.create(Node::Kind::ObjCAttribute));
     } else if (Mangled.nextIf("TO")) {
-      topLevel->addChild(NodeFactory::create(Node::Kind::NonObjCAttribute));
+      topLevel->addChild(Factory.create(Node::Kind::NonObjCAttribute));
     } else if (Mangled.nextIf("TD")) {
-      topLevel->addChild(NodeFactory::create(Node::Kind::DynamicAttribute));
+      topLevel->addChild(Factory.create(Node::Kind::DynamicAttribute));
     } else if (Mangled.nextIf("Td")) {
-      topLevel->addChild(NodeFactory::create(
+      topLevel->addChild(Factory.create(
                                    Node::Kind::DirectMethodReferenceAttribute));
     } else if (Mangled.nextIf("TV")) {
-      topLevel->addChild(NodeFactory::create(Node::Kind::VTableAttribute));
+      topLevel->addChild(Factory.create(Node::Kind::VTableAttribute));
     }
 
     DEMANGLE_CHILD_OR_RETURN(topLevel, Global);
 
     // Add a suffix node if there's anything left unmangled.
     if (!Mangled.isEmpty()) {
-      topLevel->addChild(NodeFactory::create(Node::Kind::Suffix,
-                                             Mangled.getString()));
+      topLevel->addChild(Factory.create(Node::Kind::Suffix,
+                                        Mangled.getString()));
     }
 
     return topLevel;
@@ -472,43 +495,43 @@ private:
     if (Mangled.nextIf('M')) {
       if (Mangled.nextIf('P')) {
         auto pattern =
-            NodeFactory::create(Node::Kind::GenericTypeMetadataPattern);
+            Factory.create(Node::Kind::GenericTypeMetadataPattern);
         DEMANGLE_CHILD_OR_RETURN(pattern, Type);
         return pattern;
       }
       if (Mangled.nextIf('a')) {
         auto accessor =
-          NodeFactory::create(Node::Kind::TypeMetadataAccessFunction);
+          Factory.create(Node::Kind::TypeMetadataAccessFunction);
         DEMANGLE_CHILD_OR_RETURN(accessor, Type);
         return accessor;
       }
       if (Mangled.nextIf('L')) {
-        auto cache = NodeFactory::create(Node::Kind::TypeMetadataLazyCache);
+        auto cache = Factory.create(Node::Kind::TypeMetadataLazyCache);
         DEMANGLE_CHILD_OR_RETURN(cache, Type);
         return cache;
       }
       if (Mangled.nextIf('m')) {
-        auto metaclass = NodeFactory::create(Node::Kind::Metaclass);
+        auto metaclass = Factory.create(Node::Kind::Metaclass);
         DEMANGLE_CHILD_OR_RETURN(metaclass, Type);
         return metaclass;
       }
       if (Mangled.nextIf('n')) {
         auto nominalType =
-            NodeFactory::create(Node::Kind::NominalTypeDescriptor);
+            Factory.create(Node::Kind::NominalTypeDescriptor);
         DEMANGLE_CHILD_OR_RETURN(nominalType, Type);
         return nominalType;
       }
       if (Mangled.nextIf('f')) {
-        auto metadata = NodeFactory::create(Node::Kind::FullTypeMetadata);
+        auto metadata = Factory.create(Node::Kind::FullTypeMetadata);
         DEMANGLE_CHILD_OR_RETURN(metadata, Type);
         return metadata;
       }
       if (Mangled.nextIf('p')) {
-        auto metadata = NodeFactory::create(Node::Kind::ProtocolDescriptor);
+        auto metadata = Factory.create(Node::Kind::ProtocolDescriptor);
         DEMANGLE_CHILD_OR_RETURN(metadata, ProtocolName);
         return metadata;
       }
-      auto metadata = NodeFactory::create(Node::Kind::TypeMetadata);
+      auto metadata = Factory.create(Node::Kind::TypeMetadata);
       DEMANGLE_CHILD_OR_RETURN(metadata, Type);
       return metadata;
     }
@@ -519,7 +542,7 @@ private:
       Node::Kind kind = Node::Kind::PartialApplyForwarder;
       if (Mangled.nextIf('o'))
         kind = Node::Kind::PartialApplyObjCForwarder;
-      auto forwarder = NodeFactory::create(kind);
+      auto forwarder = Factory.create(kind);
       if (Mangled.nextIf("__T"))
         DEMANGLE_CHILD_OR_RETURN(forwarder, Global);
       return forwarder;
@@ -527,7 +550,7 @@ private:
 
     // Top-level types, for various consumers.
     if (Mangled.nextIf('t')) {
-      auto type = NodeFactory::create(Node::Kind::TypeMangling);
+      auto type = Factory.create(Node::Kind::TypeMangling);
       DEMANGLE_CHILD_OR_RETURN(type, Type);
       return type;
     }
@@ -538,7 +561,7 @@ private:
       if (!w.hasValue())
         return nullptr;
       auto witness =
-        NodeFactory::create(Node::Kind::ValueWitness, unsigned(w.getValue()));
+        Factory.create(Node::Kind::ValueWitness, unsigned(w.getValue()));
       DEMANGLE_CHILD_OR_RETURN(witness, Type);
       return witness;
     }
@@ -546,69 +569,69 @@ private:
     // Offsets, value witness tables, and protocol witnesses.
     if (Mangled.nextIf('W')) {
       if (Mangled.nextIf('V')) {
-        auto witnessTable = NodeFactory::create(Node::Kind::ValueWitnessTable);
+        auto witnessTable = Factory.create(Node::Kind::ValueWitnessTable);
         DEMANGLE_CHILD_OR_RETURN(witnessTable, Type);
         return witnessTable;
       }
       if (Mangled.nextIf('o')) {
         auto witnessTableOffset =
-            NodeFactory::create(Node::Kind::WitnessTableOffset);
+            Factory.create(Node::Kind::WitnessTableOffset);
         DEMANGLE_CHILD_OR_RETURN(witnessTableOffset, Entity);
         return witnessTableOffset;
       }
       if (Mangled.nextIf('v')) {
-        auto fieldOffset = NodeFactory::create(Node::Kind::FieldOffset);
+        auto fieldOffset = Factory.create(Node::Kind::FieldOffset);
         DEMANGLE_CHILD_AS_NODE_OR_RETURN(fieldOffset, Directness);
         DEMANGLE_CHILD_OR_RETURN(fieldOffset, Entity);
         return fieldOffset;
       }
       if (Mangled.nextIf('P')) {
         auto witnessTable =
-            NodeFactory::create(Node::Kind::ProtocolWitnessTable);
+            Factory.create(Node::Kind::ProtocolWitnessTable);
         DEMANGLE_CHILD_OR_RETURN(witnessTable, ProtocolConformance);
         return witnessTable;
       }
       if (Mangled.nextIf('G')) {
         auto witnessTable =
-            NodeFactory::create(Node::Kind::GenericProtocolWitnessTable);
+            Factory.create(Node::Kind::GenericProtocolWitnessTable);
         DEMANGLE_CHILD_OR_RETURN(witnessTable, ProtocolConformance);
         return witnessTable;
       }
       if (Mangled.nextIf('I')) {
-        auto witnessTable = NodeFactory::create(
+        auto witnessTable = Factory.create(
             Node::Kind::GenericProtocolWitnessTableInstantiationFunction);
         DEMANGLE_CHILD_OR_RETURN(witnessTable, ProtocolConformance);
         return witnessTable;
       }
       if (Mangled.nextIf('l')) {
         auto accessor =
-          NodeFactory::create(Node::Kind::LazyProtocolWitnessTableAccessor);
+          Factory.create(Node::Kind::LazyProtocolWitnessTableAccessor);
         DEMANGLE_CHILD_OR_RETURN(accessor, Type);
         DEMANGLE_CHILD_OR_RETURN(accessor, ProtocolConformance);
         return accessor;
       }
       if (Mangled.nextIf('L')) {
         auto accessor =
-          NodeFactory::create(Node::Kind::LazyProtocolWitnessTableCacheVariable);
+          Factory.create(Node::Kind::LazyProtocolWitnessTableCacheVariable);
         DEMANGLE_CHILD_OR_RETURN(accessor, Type);
         DEMANGLE_CHILD_OR_RETURN(accessor, ProtocolConformance);
         return accessor;
       }
       if (Mangled.nextIf('a')) {
         auto tableTemplate =
-          NodeFactory::create(Node::Kind::ProtocolWitnessTableAccessor);
+          Factory.create(Node::Kind::ProtocolWitnessTableAccessor);
         DEMANGLE_CHILD_OR_RETURN(tableTemplate, ProtocolConformance);
         return tableTemplate;
       }
       if (Mangled.nextIf('t')) {
-        auto accessor = NodeFactory::create(
+        auto accessor = Factory.create(
             Node::Kind::AssociatedTypeMetadataAccessor);
         DEMANGLE_CHILD_OR_RETURN(accessor, ProtocolConformance);
         DEMANGLE_CHILD_OR_RETURN(accessor, DeclName);
         return accessor;
       }
       if (Mangled.nextIf('T')) {
-        auto accessor = NodeFactory::create(
+        auto accessor = Factory.create(
             Node::Kind::AssociatedTypeWitnessTableAccessor);
         DEMANGLE_CHILD_OR_RETURN(accessor, ProtocolConformance);
         DEMANGLE_CHILD_OR_RETURN(accessor, DeclName);
@@ -621,19 +644,19 @@ private:
     // Other thunks.
     if (Mangled.nextIf('T')) {
       if (Mangled.nextIf('R')) {
-        auto thunk = NodeFactory::create(Node::Kind::ReabstractionThunkHelper);
+        auto thunk = Factory.create(Node::Kind::ReabstractionThunkHelper);
         if (!demangleReabstractSignature(thunk))
           return nullptr;
         return thunk;
       }
       if (Mangled.nextIf('r')) {
-        auto thunk = NodeFactory::create(Node::Kind::ReabstractionThunk);
+        auto thunk = Factory.create(Node::Kind::ReabstractionThunk);
         if (!demangleReabstractSignature(thunk))
           return nullptr;
         return thunk;
       }
       if (Mangled.nextIf('W')) {
-        NodePointer thunk = NodeFactory::create(Node::Kind::ProtocolWitness);
+        NodePointer thunk = Factory.create(Node::Kind::ProtocolWitness);
         DEMANGLE_CHILD_OR_RETURN(thunk, ProtocolConformance);
         // The entity is mangled in its own generic context.
         DEMANGLE_CHILD_OR_RETURN(thunk, Entity);
@@ -649,7 +672,7 @@ private:
   NodePointer demangleGenericSpecialization(NodePointer specialization) {
     while (!Mangled.nextIf('_')) {
       // Otherwise, we have another parameter. Demangle the type.
-      NodePointer param = NodeFactory::create(Node::Kind::GenericSpecializationParam);
+      NodePointer param = Factory.create(Node::Kind::GenericSpecializationParam);
       DEMANGLE_CHILD_OR_RETURN(param, Type);
 
       // Then parse any conformances until we find an underscore. Pop off the
@@ -667,11 +690,11 @@ private:
 
 /// TODO: This is an atrocity. Come up with a shorter name.
 #define FUNCSIGSPEC_CREATE_PARAM_KIND(kind)                                    \
-  NodeFactory::create(Node::Kind::FunctionSignatureSpecializationParamKind,    \
-                      unsigned(FunctionSigSpecializationParamKind::kind))
+  Factory.create(Node::Kind::FunctionSignatureSpecializationParamKind,         \
+                 unsigned(FunctionSigSpecializationParamKind::kind))
 #define FUNCSIGSPEC_CREATE_PARAM_PAYLOAD(payload)                              \
-  NodeFactory::create(Node::Kind::FunctionSignatureSpecializationParamPayload, \
-                      payload)
+  Factory.create(Node::Kind::FunctionSignatureSpecializationParamPayload,      \
+                 payload)
 
   bool demangleFuncSigSpecializationConstantProp(NodePointer parent) {
     // Then figure out what was actually constant propagated. First check if
@@ -757,7 +780,7 @@ private:
     parent->addChild(FUNCSIGSPEC_CREATE_PARAM_PAYLOAD(name->getText()));
 
     // Then demangle types until we fail.
-    NodePointer type;
+    NodePointer type = nullptr;
     while (Mangled.peek() != '_' && (type = demangleType())) {
       parent->addChild(type);
     }
@@ -777,8 +800,8 @@ private:
     while (!Mangled.nextIf('_')) {
       // Create the parameter.
       NodePointer param =
-        NodeFactory::create(Node::Kind::FunctionSignatureSpecializationParam,
-                            paramCount);
+        Factory.create(Node::Kind::FunctionSignatureSpecializationParam,
+                       paramCount);
 
       // First handle options.
       if (Mangled.nextIf("n_")) {
@@ -822,7 +845,7 @@ private:
         if (!Value)
           return nullptr;
 
-        auto result = NodeFactory::create(
+        auto result = Factory.create(
             Node::Kind::FunctionSignatureSpecializationParamKind, Value);
         if (!result)
           return nullptr;
@@ -842,22 +865,22 @@ private:
   NodePointer demangleSpecializedAttribute() {
     bool isNotReAbstracted = false;
     if (Mangled.nextIf("g") || (isNotReAbstracted = Mangled.nextIf("r"))) {
-      auto spec = NodeFactory::create(isNotReAbstracted ?
+      auto spec = Factory.create(isNotReAbstracted ?
                               Node::Kind::GenericSpecializationNotReAbstracted :
                               Node::Kind::GenericSpecialization);
       // Create a node for the pass id.
-      spec->addChild(NodeFactory::create(Node::Kind::SpecializationPassID,
-                                         unsigned(Mangled.next() - 48)));
+      spec->addChild(Factory.create(Node::Kind::SpecializationPassID,
+                                    unsigned(Mangled.next() - 48)));
       // And then mangle the generic specialization.
       return demangleGenericSpecialization(spec);
     }
     if (Mangled.nextIf("f")) {
       auto spec =
-          NodeFactory::create(Node::Kind::FunctionSignatureSpecialization);
+          Factory.create(Node::Kind::FunctionSignatureSpecialization);
 
       // Add the pass id.
-      spec->addChild(NodeFactory::create(Node::Kind::SpecializationPassID,
-                                         unsigned(Mangled.next() - 48)));
+      spec->addChild(Factory.create(Node::Kind::SpecializationPassID,
+                                    unsigned(Mangled.next() - 48)));
 
       // Then perform the function signature specialization.
       return demangleFunctionSignatureSpecialization(spec);
@@ -877,7 +900,7 @@ private:
       NodePointer name = demangleIdentifier();
       if (!name) return nullptr;
 
-      NodePointer localName = NodeFactory::create(Node::Kind::LocalDeclName);
+      NodePointer localName = Factory.create(Node::Kind::LocalDeclName);
       localName->addChild(std::move(discriminator));
       localName->addChild(std::move(name));
       return localName;
@@ -889,7 +912,7 @@ private:
       NodePointer name = demangleIdentifier();
       if (!name) return nullptr;
 
-      auto privateName = NodeFactory::create(Node::Kind::PrivateDeclName);
+      auto privateName = Factory.create(Node::Kind::PrivateDeclName);
       privateName->addChildren(std::move(discriminator), std::move(name));
       return privateName;
     }
@@ -975,7 +998,7 @@ private:
       identifier = opDecodeBuffer;
     }
     
-    return NodeFactory::create(*kind, identifier);
+    return Factory.create(*kind, identifier);
   }
 
   bool demangleIndex(Node::IndexType &natural) {
@@ -997,13 +1020,13 @@ private:
     Node::IndexType index;
     if (!demangleIndex(index))
       return nullptr;
-    return NodeFactory::create(kind, index);
+    return Factory.create(kind, index);
   }
 
   NodePointer createSwiftType(Node::Kind typeKind, StringRef name) {
-    NodePointer type = NodeFactory::create(typeKind);
-    type->addChild(NodeFactory::create(Node::Kind::Module, STDLIB_NAME));
-    type->addChild(NodeFactory::create(Node::Kind::Identifier, name));
+    NodePointer type = Factory.create(typeKind);
+    type->addChild(Factory.create(Node::Kind::Module, STDLIB_NAME));
+    type->addChild(Factory.create(Node::Kind::Identifier, name));
     return type;
   }
 
@@ -1012,9 +1035,9 @@ private:
     if (!Mangled)
       return nullptr;
     if (Mangled.nextIf('o'))
-      return NodeFactory::create(Node::Kind::Module, MANGLING_MODULE_OBJC);
+      return Factory.create(Node::Kind::Module, MANGLING_MODULE_OBJC);
     if (Mangled.nextIf('C'))
-      return NodeFactory::create(Node::Kind::Module, MANGLING_MODULE_C);
+      return Factory.create(Node::Kind::Module, MANGLING_MODULE_C);
     if (Mangled.nextIf('a'))
       return createSwiftType(Node::Kind::Structure, "Array");
     if (Mangled.nextIf('b'))
@@ -1053,7 +1076,7 @@ private:
 
   NodePointer demangleModule() {
     if (Mangled.nextIf('s')) {
-      return NodeFactory::create(Node::Kind::Module, STDLIB_NAME);
+      return Factory.create(Node::Kind::Module, STDLIB_NAME);
     }
     if (Mangled.nextIf('S')) {
       NodePointer module = demangleSubstitutionIndex();
@@ -1077,7 +1100,7 @@ private:
     auto name = demangleDeclName();
     if (!name) return nullptr;
 
-    auto decl = NodeFactory::create(kind);
+    auto decl = Factory.create(kind);
     decl->addChild(context);
     decl->addChild(name);
     Substitutions.push_back(decl);
@@ -1088,7 +1111,7 @@ private:
     NodePointer proto = demangleProtocolNameImpl();
     if (!proto) return nullptr;
 
-    NodePointer type = NodeFactory::create(Node::Kind::Type);
+    NodePointer type = Factory.create(Node::Kind::Type);
     type->addChild(proto);
     return type;
   }
@@ -1097,7 +1120,7 @@ private:
     NodePointer name = demangleDeclName();
     if (!name) return nullptr;
 
-    auto proto = NodeFactory::create(Node::Kind::Protocol);
+    auto proto = Factory.create(Node::Kind::Protocol);
     proto->addChild(std::move(context));
     proto->addChild(std::move(name));
     Substitutions.push_back(proto);
@@ -1122,7 +1145,7 @@ private:
     }
 
     if (Mangled.nextIf('s')) {
-      NodePointer stdlib = NodeFactory::create(Node::Kind::Module, STDLIB_NAME);
+      NodePointer stdlib = Factory.create(Node::Kind::Module, STDLIB_NAME);
 
       return demangleProtocolNameGivenContext(stdlib);
     }
@@ -1151,7 +1174,7 @@ private:
     // context ::= 'e' module context generic-signature (constrained extension)
     if (!Mangled) return nullptr;
     if (Mangled.nextIf('E')) {
-      NodePointer ext = NodeFactory::create(Node::Kind::Extension);
+      NodePointer ext = Factory.create(Node::Kind::Extension);
       NodePointer def_module = demangleModule();
       if (!def_module) return nullptr;
       NodePointer type = demangleContext();
@@ -1161,7 +1184,7 @@ private:
       return ext;
     }
     if (Mangled.nextIf('e')) {
-      NodePointer ext = NodeFactory::create(Node::Kind::Extension);
+      NodePointer ext = Factory.create(Node::Kind::Extension);
       NodePointer def_module = demangleModule();
       if (!def_module) return nullptr;
       NodePointer sig = demangleGenericSignature();
@@ -1180,15 +1203,15 @@ private:
     if (Mangled.nextIf('S'))
       return demangleSubstitutionIndex();
     if (Mangled.nextIf('s'))
-      return NodeFactory::create(Node::Kind::Module, STDLIB_NAME);
+      return Factory.create(Node::Kind::Module, STDLIB_NAME);
     if (isStartOfEntity(Mangled.peek()))
       return demangleEntity();
     return demangleModule();
   }
   
   NodePointer demangleProtocolList() {
-    NodePointer proto_list = NodeFactory::create(Node::Kind::ProtocolList);
-    NodePointer type_list = NodeFactory::create(Node::Kind::TypeList);
+    NodePointer proto_list = Factory.create(Node::Kind::ProtocolList);
+    NodePointer type_list = Factory.create(Node::Kind::TypeList);
     proto_list->addChild(type_list);
     while (!Mangled.nextIf('_')) {
       NodePointer proto = demangleProtocolName();
@@ -1210,7 +1233,7 @@ private:
     if (!context)
       return nullptr;
     NodePointer proto_conformance =
-        NodeFactory::create(Node::Kind::ProtocolConformance);
+        Factory.create(Node::Kind::ProtocolConformance);
     proto_conformance->addChild(type);
     proto_conformance->addChild(protocol);
     proto_conformance->addChild(context);
@@ -1243,7 +1266,7 @@ private:
     // entity-name
     Node::Kind entityKind;
     bool hasType = true;
-    NodePointer name;
+    NodePointer name = nullptr;
     if (Mangled.nextIf('D')) {
       entityKind = Node::Kind::Deallocator;
       hasType = false;
@@ -1339,7 +1362,7 @@ private:
       if (!name) return nullptr;
     }
 
-    NodePointer entity = NodeFactory::create(entityKind);
+    NodePointer entity = Factory.create(entityKind);
     entity->addChild(context);
 
     if (name) entity->addChild(name);
@@ -1351,7 +1374,7 @@ private:
     }
     
     if (isStatic) {
-      auto staticNode = NodeFactory::create(Node::Kind::Static);
+      auto staticNode = Factory.create(Node::Kind::Static);
       staticNode->addChild(entity);
       return staticNode;
     }
@@ -1361,10 +1384,10 @@ private:
 
   NodePointer demangleArchetypeRef(Node::IndexType depth, Node::IndexType i) {
     // FIXME: Name won't match demangled context generic signatures correctly.
-    auto ref = NodeFactory::create(Node::Kind::ArchetypeRef,
-                                   archetypeName(i, depth));
-    ref->addChild(NodeFactory::create(Node::Kind::Index, depth));
-    ref->addChild(NodeFactory::create(Node::Kind::Index, i));
+    auto ref = Factory.create(Node::Kind::ArchetypeRef,
+                              archetypeName(i, depth));
+    ref->addChild(Factory.create(Node::Kind::Index, depth));
+    ref->addChild(Factory.create(Node::Kind::Index, i));
     return ref;
   }
 
@@ -1373,10 +1396,10 @@ private:
     DemanglerPrinter PrintName(Name);
     PrintName << archetypeName(index, depth);
 
-    auto paramTy = NodeFactory::create(Node::Kind::DependentGenericParamType,
-                                       std::move(Name));
-    paramTy->addChild(NodeFactory::create(Node::Kind::Index, depth));
-    paramTy->addChild(NodeFactory::create(Node::Kind::Index, index));
+    auto paramTy = Factory.create(Node::Kind::DependentGenericParamType,
+                                  std::move(Name));
+    paramTy->addChild(Factory.create(Node::Kind::Index, depth));
+    paramTy->addChild(Factory.create(Node::Kind::Index, index));
 
     return paramTy;
   }
@@ -1405,7 +1428,7 @@ private:
   NodePointer demangleDependentMemberTypeName(NodePointer base) {
     assert(base->getKind() == Node::Kind::Type
            && "base should be a type");
-    NodePointer assocTy;
+    NodePointer assocTy = nullptr;
 
     if (Mangled.nextIf('S')) {
       assocTy = demangleSubstitutionIndex();
@@ -1429,7 +1452,7 @@ private:
       Substitutions.push_back(assocTy);
     }
 
-    NodePointer depTy = NodeFactory::create(Node::Kind::DependentMemberType);
+    NodePointer depTy = Factory.create(Node::Kind::DependentMemberType);
     depTy->addChild(base);
     depTy->addChild(assocTy);
     return depTy;
@@ -1441,7 +1464,7 @@ private:
     if (!base)
       return nullptr;
 
-    NodePointer nodeType = NodeFactory::create(Node::Kind::Type);
+    NodePointer nodeType = Factory.create(Node::Kind::Type);
     nodeType->addChild(base);
 
     // Demangle the associated type name.
@@ -1456,7 +1479,7 @@ private:
 
     // Demangle the associated type chain.
     while (!Mangled.nextIf('_')) {
-      NodePointer nodeType = NodeFactory::create(Node::Kind::Type);
+      NodePointer nodeType = Factory.create(Node::Kind::Type);
       nodeType->addChild(base);
       
       base = demangleDependentMemberTypeName(nodeType);
@@ -1500,19 +1523,19 @@ private:
     if (!type)
       return nullptr;
 
-    NodePointer nodeType = NodeFactory::create(Node::Kind::Type);
+    NodePointer nodeType = Factory.create(Node::Kind::Type);
     nodeType->addChild(type);
     return nodeType;
   }
 
   NodePointer demangleGenericSignature() {
-    auto sig = NodeFactory::create(Node::Kind::DependentGenericSignature);
+    auto sig = Factory.create(Node::Kind::DependentGenericSignature);
     // First read in the parameter counts at each depth.
     Node::IndexType count = ~(Node::IndexType)0;
     
     auto addCount = [&]{
       auto countNode =
-        NodeFactory::create(Node::Kind::DependentGenericParamCount, count);
+        Factory.create(Node::Kind::DependentGenericParamCount, count);
       sig->addChild(countNode);
     };
     
@@ -1551,14 +1574,14 @@ private:
 
   NodePointer demangleMetatypeRepresentation() {
     if (Mangled.nextIf('t'))
-      return NodeFactory::create(Node::Kind::MetatypeRepresentation, "@thin");
+      return Factory.create(Node::Kind::MetatypeRepresentation, "@thin");
 
     if (Mangled.nextIf('T'))
-      return NodeFactory::create(Node::Kind::MetatypeRepresentation, "@thick");
+      return Factory.create(Node::Kind::MetatypeRepresentation, "@thick");
 
     if (Mangled.nextIf('o'))
-      return NodeFactory::create(Node::Kind::MetatypeRepresentation,
-                                 "@objc_metatype");
+      return Factory.create(Node::Kind::MetatypeRepresentation,
+                            "@objc_metatype");
 
     unreachable("Unhandled metatype representation");
   }
@@ -1570,7 +1593,7 @@ private:
     if (Mangled.nextIf('z')) {
       NodePointer second = demangleType();
       if (!second) return nullptr;
-      auto reqt = NodeFactory::create(
+      auto reqt = Factory.create(
           Node::Kind::DependentGenericSameTypeRequirement);
       reqt->addChild(constrainedType);
       reqt->addChild(second);
@@ -1581,7 +1604,7 @@ private:
     // will begin with either 'C' or 'S'.
     if (!Mangled)
       return nullptr;
-    NodePointer constraint;
+    NodePointer constraint = nullptr;
 
     auto next = Mangled.peek();
 
@@ -1591,7 +1614,7 @@ private:
     } else if (next == 'S') {
       // A substitution may be either the module name of a protocol or a full
       // type name.
-      NodePointer typeName;
+      NodePointer typeName = nullptr;
       Mangled.next();
       NodePointer sub = demangleSubstitutionIndex();
       if (!sub) return nullptr;
@@ -1605,14 +1628,14 @@ private:
       } else {
         return nullptr;
       }
-      constraint = NodeFactory::create(Node::Kind::Type);
+      constraint = Factory.create(Node::Kind::Type);
       constraint->addChild(typeName);
     } else {
       constraint = demangleProtocolName();
       if (!constraint)
         return nullptr;
     }
-    auto reqt = NodeFactory::create(
+    auto reqt = Factory.create(
                           Node::Kind::DependentGenericConformanceRequirement);
     reqt->addChild(constrainedType);
     reqt->addChild(constraint);
@@ -1621,7 +1644,7 @@ private:
   
   NodePointer demangleArchetypeType() {
     auto makeSelfType = [&](NodePointer proto) -> NodePointer {
-      auto selfType = NodeFactory::create(Node::Kind::SelfTypeRef);
+      auto selfType = Factory.create(Node::Kind::SelfTypeRef);
       selfType->addChild(proto);
       Substitutions.push_back(selfType);
       return selfType;
@@ -1630,7 +1653,7 @@ private:
     auto makeAssociatedType = [&](NodePointer root) -> NodePointer {
       NodePointer name = demangleIdentifier();
       if (!name) return nullptr;
-      auto assocType = NodeFactory::create(Node::Kind::AssociatedTypeRef);
+      auto assocType = Factory.create(Node::Kind::AssociatedTypeRef);
       assocType->addChild(root);
       assocType->addChild(name);
       Substitutions.push_back(assocType);
@@ -1657,7 +1680,7 @@ private:
         return makeAssociatedType(sub);
     }
     if (Mangled.nextIf('s')) {
-      NodePointer stdlib = NodeFactory::create(Node::Kind::Module, STDLIB_NAME);
+      NodePointer stdlib = Factory.create(Node::Kind::Module, STDLIB_NAME);
       return makeAssociatedType(stdlib);
     }
     if (Mangled.nextIf('d')) {
@@ -1672,12 +1695,12 @@ private:
       NodePointer index = demangleIndexAsNode();
       if (!index)
         return nullptr;
-      NodePointer decl_ctx = NodeFactory::create(Node::Kind::DeclContext);
+      NodePointer decl_ctx = Factory.create(Node::Kind::DeclContext);
       NodePointer ctx = demangleContext();
       if (!ctx)
         return nullptr;
       decl_ctx->addChild(ctx);
-      auto qual_atype = NodeFactory::create(Node::Kind::QualifiedArchetype);
+      auto qual_atype = Factory.create(Node::Kind::QualifiedArchetype);
       qual_atype->addChild(index);
       qual_atype->addChild(decl_ctx);
       return qual_atype;
@@ -1689,13 +1712,13 @@ private:
   }
 
   NodePointer demangleTuple(IsVariadic isV) {
-    NodePointer tuple = NodeFactory::create(
+    NodePointer tuple = Factory.create(
         isV == IsVariadic::yes ? Node::Kind::VariadicTuple
                                : Node::Kind::NonVariadicTuple);
     while (!Mangled.nextIf('_')) {
       if (!Mangled)
         return nullptr;
-      NodePointer elt = NodeFactory::create(Node::Kind::TupleElement);
+      NodePointer elt = Factory.create(Node::Kind::TupleElement);
 
       if (isStartOfIdentifier(Mangled.peek())) {
         NodePointer label = demangleIdentifier(Node::Kind::TupleElementName);
@@ -1715,7 +1738,7 @@ private:
   }
   
   NodePointer postProcessReturnTypeNode (NodePointer out_args) {
-    NodePointer out_node = NodeFactory::create(Node::Kind::ReturnType);
+    NodePointer out_node = Factory.create(Node::Kind::ReturnType);
     out_node->addChild(out_args);
     return out_node;
   }
@@ -1724,7 +1747,7 @@ private:
     NodePointer type = demangleTypeImpl();
     if (!type)
       return nullptr;
-    NodePointer nodeType = NodeFactory::create(Node::Kind::Type);
+    NodePointer nodeType = Factory.create(Node::Kind::Type);
     nodeType->addChild(type);
     return nodeType;
   }
@@ -1741,13 +1764,13 @@ private:
     NodePointer out_args = demangleType();
     if (!out_args)
       return nullptr;
-    NodePointer block = NodeFactory::create(kind);
+    NodePointer block = Factory.create(kind);
     
     if (throws) {
-      block->addChild(NodeFactory::create(Node::Kind::ThrowsAnnotation));
+      block->addChild(Factory.create(Node::Kind::ThrowsAnnotation));
     }
     
-    NodePointer in_node = NodeFactory::create(Node::Kind::ArgumentTuple);
+    NodePointer in_node = Factory.create(Node::Kind::ArgumentTuple);
     block->addChild(in_node);
     in_node->addChild(in_args);
     block->addChild(postProcessReturnTypeNode(out_args));
@@ -1763,15 +1786,15 @@ private:
         return nullptr;
       c = Mangled.next();
       if (c == 'b')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.BridgeObject");
+        return Factory.create(Node::Kind::BuiltinTypeName,
+                              "Builtin.BridgeObject");
       if (c == 'B')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.UnsafeValueBuffer");
+        return Factory.create(Node::Kind::BuiltinTypeName,
+                              "Builtin.UnsafeValueBuffer");
       if (c == 'f') {
         Node::IndexType size;
         if (demangleBuiltinSize(size)) {
-          return NodeFactory::create(
+          return Factory.create(
               Node::Kind::BuiltinTypeName,
               (DemanglerPrinter("") << "Builtin.Float" << size).str());
         }
@@ -1779,7 +1802,7 @@ private:
       if (c == 'i') {
         Node::IndexType size;
         if (demangleBuiltinSize(size)) {
-          return NodeFactory::create(
+          return Factory.create(
               Node::Kind::BuiltinTypeName,
               (DemanglerPrinter("") << "Builtin.Int" << size).str());
         }
@@ -1793,7 +1816,7 @@ private:
             Node::IndexType size;
             if (!demangleBuiltinSize(size))
               return nullptr;
-            return NodeFactory::create(
+            return Factory.create(
                 Node::Kind::BuiltinTypeName,
                 (DemanglerPrinter("") << "Builtin.Vec" << elts << "xInt" << size)
                     .str());
@@ -1802,30 +1825,30 @@ private:
             Node::IndexType size;
             if (!demangleBuiltinSize(size))
               return nullptr;
-            return NodeFactory::create(
+            return Factory.create(
                 Node::Kind::BuiltinTypeName,
                 (DemanglerPrinter("") << "Builtin.Vec" << elts << "xFloat"
                                     << size).str());
           }
           if (Mangled.nextIf('p'))
-            return NodeFactory::create(
+            return Factory.create(
                 Node::Kind::BuiltinTypeName,
                 (DemanglerPrinter("") << "Builtin.Vec" << elts << "xRawPointer")
                     .str());
         }
       }
       if (c == 'O')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.UnknownObject");
+        return Factory.create(Node::Kind::BuiltinTypeName,
+                              "Builtin.UnknownObject");
       if (c == 'o')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.NativeObject");
+        return Factory.create(Node::Kind::BuiltinTypeName,
+                              "Builtin.NativeObject");
       if (c == 'p')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.RawPointer");
+        return Factory.create(Node::Kind::BuiltinTypeName,
+                              "Builtin.RawPointer");
       if (c == 'w')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.Word");
+        return Factory.create(Node::Kind::BuiltinTypeName,
+                              "Builtin.Word");
       return nullptr;
     }
     if (c == 'a')
@@ -1842,7 +1865,7 @@ private:
       if (!type)
         return nullptr;
 
-      NodePointer dynamicSelf = NodeFactory::create(Node::Kind::DynamicSelf);
+      NodePointer dynamicSelf = Factory.create(Node::Kind::DynamicSelf);
       dynamicSelf->addChild(type);
       return dynamicSelf;
     }
@@ -1851,7 +1874,7 @@ private:
         return nullptr;
       if (!Mangled.nextIf('R'))
         return nullptr;
-      return NodeFactory::create(Node::Kind::ErrorType, std::string());
+      return Factory.create(Node::Kind::ErrorType, std::string());
     }
     if (c == 'F') {
       return demangleFunctionType(Node::Kind::FunctionType);
@@ -1863,7 +1886,7 @@ private:
       NodePointer unboundType = demangleType();
       if (!unboundType)
         return nullptr;
-      NodePointer type_list = NodeFactory::create(Node::Kind::TypeList);
+      NodePointer type_list = Factory.create(Node::Kind::TypeList);
       while (!Mangled.nextIf('_')) {
         NodePointer type = demangleType();
         if (!type)
@@ -1887,7 +1910,7 @@ private:
           return nullptr;
       }
       NodePointer type_application =
-          NodeFactory::create(bound_type_kind);
+          Factory.create(bound_type_kind);
       type_application->addChild(unboundType);
       type_application->addChild(type_list);
       return type_application;
@@ -1897,7 +1920,7 @@ private:
         NodePointer type = demangleType();
         if (!type)
           return nullptr;
-        NodePointer boxType = NodeFactory::create(Node::Kind::SILBoxType);
+        NodePointer boxType = Factory.create(Node::Kind::SILBoxType);
         boxType->addChild(type);
         return boxType;
       }
@@ -1909,7 +1932,7 @@ private:
       NodePointer type = demangleType();
       if (!type)
         return nullptr;
-      NodePointer metatype = NodeFactory::create(Node::Kind::Metatype);
+      NodePointer metatype = Factory.create(Node::Kind::Metatype);
       metatype->addChild(type);
       return metatype;
     }
@@ -1921,7 +1944,7 @@ private:
         NodePointer type = demangleType();
         if (!type)
           return nullptr;
-        NodePointer metatype = NodeFactory::create(Node::Kind::Metatype);
+        NodePointer metatype = Factory.create(Node::Kind::Metatype);
         metatype->addChild(metatypeRepr);
         metatype->addChild(type);
         return metatype;
@@ -1931,7 +1954,7 @@ private:
       if (Mangled.nextIf('M')) {
         NodePointer type = demangleType();
         if (!type) return nullptr;
-        auto metatype = NodeFactory::create(Node::Kind::ExistentialMetatype);
+        auto metatype = Factory.create(Node::Kind::ExistentialMetatype);
         metatype->addChild(type);
         return metatype;
       }
@@ -1948,7 +1971,7 @@ private:
           NodePointer type = demangleType();
           if (!type) return nullptr;
 
-          auto metatype = NodeFactory::create(Node::Kind::ExistentialMetatype);
+          auto metatype = Factory.create(Node::Kind::ExistentialMetatype);
           metatype->addChild(metatypeRepr);
           metatype->addChild(type);
           return metatype;
@@ -1974,7 +1997,7 @@ private:
       return demangleAssociatedTypeCompound();
     }
     if (c == 'R') {
-      NodePointer inout = NodeFactory::create(Node::Kind::InOut);
+      NodePointer inout = Factory.create(Node::Kind::InOut);
       NodePointer type = demangleTypeImpl();
       if (!type)
         return nullptr;
@@ -1996,7 +2019,7 @@ private:
       NodePointer sub = demangleType();
       if (!sub) return nullptr;
       NodePointer dependentGenericType
-        = NodeFactory::create(Node::Kind::DependentGenericType);
+        = Factory.create(Node::Kind::DependentGenericType);
       dependentGenericType->addChild(sig);
       dependentGenericType->addChild(sub);
       return dependentGenericType;
@@ -2009,7 +2032,7 @@ private:
         NodePointer type = demangleType();
         if (!type)
           return nullptr;
-        NodePointer unowned = NodeFactory::create(Node::Kind::Unowned);
+        NodePointer unowned = Factory.create(Node::Kind::Unowned);
         unowned->addChild(type);
         return unowned;
       }
@@ -2017,7 +2040,7 @@ private:
         NodePointer type = demangleType();
         if (!type)
           return nullptr;
-        NodePointer unowned = NodeFactory::create(Node::Kind::Unmanaged);
+        NodePointer unowned = Factory.create(Node::Kind::Unmanaged);
         unowned->addChild(type);
         return unowned;
       }
@@ -2025,7 +2048,7 @@ private:
         NodePointer type = demangleType();
         if (!type)
           return nullptr;
-        NodePointer weak = NodeFactory::create(Node::Kind::Weak);
+        NodePointer weak = Factory.create(Node::Kind::Weak);
         weak->addChild(type);
         return weak;
       }
@@ -2072,7 +2095,7 @@ private:
   // impl-function-attribute ::= 'N'             // noreturn
   // impl-function-attribute ::= 'G'             // generic
   NodePointer demangleImplFunctionType() {
-    NodePointer type = NodeFactory::create(Node::Kind::ImplFunctionType);
+    NodePointer type = Factory.create(Node::Kind::ImplFunctionType);
 
     if (!demangleImplCalleeConvention(type))
       return nullptr;
@@ -2167,13 +2190,13 @@ private:
     if (attr.empty()) {
       return false;
     }
-    type->addChild(NodeFactory::create(Node::Kind::ImplConvention, attr));
+    type->addChild(Factory.create(Node::Kind::ImplConvention, attr));
     return true;
   }
 
   void addImplFunctionAttribute(NodePointer parent, StringRef attr,
                          Node::Kind kind = Node::Kind::ImplFunctionAttribute) {
-    parent->addChild(NodeFactory::create(kind, attr));
+    parent->addChild(Factory.create(kind, attr));
   }
 
   // impl-parameter ::= impl-convention type
@@ -2219,9 +2242,9 @@ private:
     auto type = demangleType();
     if (!type) return nullptr;
 
-    NodePointer node = NodeFactory::create(kind);
-    node->addChild(NodeFactory::create(Node::Kind::ImplConvention,
-                                       convention));
+    NodePointer node = Factory.create(kind);
+    node->addChild(Factory.create(Node::Kind::ImplConvention,
+                                  convention));
     node->addChild(type);
     
     return node;
@@ -2232,16 +2255,18 @@ private:
 NodePointer
 swift::Demangle::demangleSymbolAsNode(const char *MangledName,
                                       size_t MangledNameLength,
+                                      NodeFactory &Factory,
                                       const DemangleOptions &Options) {
-  Demangler demangler(StringRef(MangledName, MangledNameLength));
+  Demangler demangler(StringRef(MangledName, MangledNameLength), Factory);
   return demangler.demangleTopLevel();
 }
 
 NodePointer
 swift::Demangle::demangleTypeAsNode(const char *MangledName,
                                     size_t MangledNameLength,
+                                    NodeFactory &Factory,
                                     const DemangleOptions &Options) {
-  Demangler demangler(StringRef(MangledName, MangledNameLength));
+  Demangler demangler(StringRef(MangledName, MangledNameLength), Factory);
   return demangler.demangleTypeName();
 }
 
@@ -2671,8 +2696,9 @@ unsigned NodePrinter::printFunctionSigSpecializationParam(NodePointer pointer,
     Printer << "[";
     print(pointer->getChild(Idx++));
     Printer << " : ";
-    const auto &text = pointer->getChild(Idx++)->getText();
-    std::string demangledName = demangleSymbolAsString(text);
+    StringRef text = pointer->getChild(Idx++)->getText();
+    std::string demangledName = demangleSymbolAsString(text.data(),
+                                                       text.size());
     if (demangledName.empty()) {
       Printer << text;
     } else {
@@ -2812,7 +2838,7 @@ void NodePrinter::printSimplifiedEntityType(NodePointer context,
   assert(type->getKind() == Node::Kind::Type);
   type = type->getChild(0);
 
-  NodePointer generics;
+  NodePointer generics = nullptr;
   if (type->getKind() == Node::Kind::GenericType ||
       type->getKind() == Node::Kind::DependentGenericType) {
     generics = type->getChild(0);
@@ -2898,7 +2924,8 @@ void NodePrinter::print(NodePointer pointer, bool asContext, bool suppressType)
     return;
   case Node::Kind::Suffix:
     if (!Options.DisplayUnmangledSuffix) return;
-    Printer << " with unmangled suffix " << QuotedString(pointer->getText());
+    Printer << " with unmangled suffix "
+            << QuotedString(pointer->getText().str());
     return;
   case Node::Kind::Initializer:
     printEntity(false, false, "(variable initialization expression)");
@@ -3096,7 +3123,9 @@ void NodePrinter::print(NodePointer pointer, bool asContext, bool suppressType)
     return;
   }
   case Node::Kind::FunctionSignatureSpecializationParamPayload: {
-    std::string demangledName = demangleSymbolAsString(pointer->getText());
+    StringRef text = pointer->getText();
+    std::string demangledName = demangleSymbolAsString(text.data(),
+                                                       text.size());
     if (demangledName.empty()) {
       Printer << pointer->getText();
     } else {
@@ -3656,10 +3685,12 @@ std::string Demangle::demangleSymbolAsString(const char *MangledName,
                                              size_t MangledNameLength,
                                              const DemangleOptions &Options) {
   auto mangled = StringRef(MangledName, MangledNameLength);
-  auto root = demangleSymbolAsNode(MangledName, MangledNameLength, Options);
+  NodeFactory Factory;
+  auto root = demangleSymbolAsNode(MangledName, MangledNameLength, Factory,
+                                   Options);
   if (!root) return mangled.str();
 
-  std::string demangling = nodeToString(std::move(root), Options);
+  std::string demangling = nodeToString(root, Options);
   if (demangling.empty())
     return mangled.str();
   return demangling;
@@ -3669,10 +3700,12 @@ std::string Demangle::demangleTypeAsString(const char *MangledName,
                                            size_t MangledNameLength,
                                            const DemangleOptions &Options) {
   auto mangled = StringRef(MangledName, MangledNameLength);
-  auto root = demangleTypeAsNode(MangledName, MangledNameLength, Options);
+  NodeFactory Factory;
+  auto root = demangleTypeAsNode(MangledName, MangledNameLength, Factory,
+                                 Options);
   if (!root) return mangled.str();
   
-  std::string demangling = nodeToString(std::move(root), Options);
+  std::string demangling = nodeToString(root, Options);
   if (demangling.empty())
     return mangled.str();
   return demangling;
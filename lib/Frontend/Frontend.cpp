@@ -506,6 +506,8 @@ void CompilerInstance::performSema() {
     Context->recordKnownProtocols(stdlib);
 
   if (DelayedCB) {
+    if (PersistentState.hasDelayedDecl())
+      CodeCompletionDecl = PersistentState.getDelayedDeclInfo();
     performDelayedParsing(MainModule, PersistentState,
                           Invocation.getCodeCompletionFactory());
   }
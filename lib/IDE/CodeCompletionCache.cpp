@@ -2,6 +2,7 @@
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -88,13 +89,7 @@ CodeCompletionCache::~CodeCompletionCache() {}
 ///
 /// This should be incremented any time we commit a change to the format of the
 /// cached results. This isn't expected to change very often.
-static constexpr uint32_t onDiskCompletionCacheVersion = 0;
-
-static StringRef copyString(llvm::BumpPtrAllocator &Allocator, StringRef Str) {
-  char *Mem = Allocator.Allocate<char>(Str.size());
-  std::copy(Str.begin(), Str.end(), Mem);
-  return StringRef(Mem, Str.size());
-}
+static constexpr uint32_t onDiskCompletionCacheVersion = 1;
 
 static ArrayRef<StringRef> copyStringArray(llvm::BumpPtrAllocator &Allocator,
                                            ArrayRef<StringRef> Arr) {
@@ -112,9 +107,21 @@ static ArrayRef<std::pair<StringRef, StringRef>> copyStringPairArray(
   return llvm::makeArrayRef(Buff, Arr.size());
 }
 
+namespace {
+/// An allocator together with the cache file whose contents are referenced by
+/// the results in the allocator.
+struct CachedModuleAllocator {
+  llvm::BumpPtrAllocator Allocator;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+};
+} // end anonymous namespace
+
 /// Deserializes CodeCompletionResults from \p in and stores them in \p V.
+///
+/// The strings of the results are not copied, but point into \p in, which is
+/// kept alive as long as the allocator of \p V's sink.
 /// \see writeCacheModule.
-static bool readCachedModule(llvm::MemoryBuffer *in,
+static bool readCachedModule(std::unique_ptr<llvm::MemoryBuffer> in,
                              const CodeCompletionCache::Key &K,
                              CodeCompletionCache::Value &V,
                              bool allowOutOfDate = false) {
@@ -159,7 +166,13 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
   auto stringCount = read32le(strings);
   assert(strings + stringCount == end && "incorrect file size");
   (void)stringCount; // so it is not seen as "unused" in release builds.
-  
+
+  // Replace the allocator of the sink by one that also owns the buffer.
+  auto owner = std::make_shared<CachedModuleAllocator>();
+  owner->Buffer = std::move(in);
+  V.Sink.Allocator = CodeCompletionResultSink::AllocatorPtr(owner,
+                                                            &owner->Allocator);
+
   // STRINGS
   auto getString = [&](uint32_t index) -> StringRef {
     if (index == ~0u)
@@ -167,7 +180,15 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 
     const char *p = strings + index;
     auto size = read32le(p);
-    return copyString(*V.Sink.Allocator, StringRef(p, size));
+    return StringRef(p, size);
+  };
+
+  // STRING LISTS
+  auto getStringList = [&](uint32_t listIndex, uint32_t count,
+                           SmallVectorImpl<StringRef> &list) {
+    const char *p = chunks + listIndex;
+    for (unsigned i = 0; i < count; ++i)
+      list.push_back(getString(read32le(p)));
   };
 
   // CHUNKS
@@ -201,9 +222,7 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
     auto context = static_cast<SemanticContextKind>(*cursor++);
     auto notRecommended = static_cast<bool>(*cursor++);
     auto numBytesToErase = static_cast<unsigned>(*cursor++);
-    auto oldCursor = cursor;
     auto chunkIndex = read32le(cursor);
-    auto IntLength = cursor - oldCursor;
     auto moduleIndex = read32le(cursor);
     auto briefDocIndex = read32le(cursor);
     auto assocUSRCount = read32le(cursor);
@@ -215,20 +234,14 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
     auto moduleName = getString(moduleIndex);
     auto briefDocComment = getString(briefDocIndex);
     SmallVector<StringRef, 4> assocUSRs;
-    for (unsigned i = 0; i < assocUSRCount; ++i) {
-      auto usr = getString(assocUSRsIndex);
-      assocUSRs.push_back(usr);
-      assocUSRsIndex += usr.size() + IntLength;
-    }
+    getStringList(assocUSRsIndex, assocUSRCount, assocUSRs);
 
+    SmallVector<StringRef, 8> declKeywordStrings;
+    getStringList(declKeywordIndex, 2 * declKeywordCount, declKeywordStrings);
     SmallVector<std::pair<StringRef, StringRef>, 4> declKeywords;
-    for (unsigned i = 0; i < declKeywordCount; ++i) {
-      auto first = getString(declKeywordIndex);
-      declKeywordIndex += first.size() + IntLength;
-      auto second = getString(declKeywordIndex);
-      declKeywordIndex += second.size() + IntLength;
-      declKeywords.push_back(std::make_pair(first, second));
-    }
+    for (unsigned i = 0; i < declKeywordCount; ++i)
+      declKeywords.push_back(std::make_pair(declKeywordStrings[2 * i],
+                                            declKeywordStrings[2 * i + 1]));
 
     CodeCompletionResult *result = nullptr;
     if (kind == CodeCompletionResult::Declaration) {
@@ -264,12 +277,16 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 ///     * Contains offsets into CHUNKS and STRINGS.
 ///
 ///   CHUNKS
-///     * A length-prefixed array of CodeCompletionStrings.
+///     * A length-prefixed array of CodeCompletionStrings and string lists.
 ///     * Each CodeCompletionString is a length-prefixed array of fixed size
 ///       CodeCompletionString::Chunks.
+///     * Each string list (associated USRs, decl keywords) is an array of
+///       offsets into STRINGS. Its length is stored in the result.
 ///
 ///   STRINGS
 ///     * A blob of length-prefixed strings referred to in CHUNKS or RESULTS.
+///     * Each distinct string is stored only once, so that the reader can
+///       refer to the strings in place instead of copying them.
 static void writeCachedModule(llvm::raw_ostream &out,
                               const CodeCompletionCache::Key &K,
                               CodeCompletionCache::Value &V) {
@@ -308,13 +325,26 @@ static void writeCachedModule(llvm::raw_ostream &out,
   std::string strings_;
   llvm::raw_string_ostream strings(strings_);
 
-  auto addString = [&strings](StringRef str) {
+  llvm::StringMap<uint32_t> knownStrings;
+  auto addString = [&strings, &knownStrings](StringRef str) {
     if (str.empty())
       return ~0u;
-    auto size = strings.tell();
+    auto known = knownStrings.insert(
+        std::make_pair(str, static_cast<uint32_t>(strings.tell())));
+    if (!known.second)
+      return known.first->second;
     endian::Writer<little> LE(strings);
     LE.write(static_cast<uint32_t>(str.size()));
     strings << str;
+    return known.first->second;
+  };
+
+  auto addStringList = [&](ArrayRef<StringRef> list) {
+    if (list.empty())
+      return ~0u;
+    auto size = chunks.tell();
+    for (StringRef str : list)
+      chunksLE.write(addString(str));
     return static_cast<uint32_t>(size);
   };
 
@@ -352,26 +382,15 @@ static void writeCachedModule(llvm::raw_ostream &out,
       LE.write(addString(R->getModuleName()));      // index into strings
       LE.write(addString(R->getBriefDocComment())); // index into strings
       LE.write(static_cast<uint32_t>(R->getAssociatedUSRs().size()));
-      if (R->getAssociatedUSRs().empty()) {
-        LE.write(static_cast<uint32_t>(~0u));
-      } else {
-        LE.write(addString(R->getAssociatedUSRs()[0]));
-        for (unsigned i = 1; i < R->getAssociatedUSRs().size(); ++i) {
-          addString(R->getAssociatedUSRs()[i]); // ignore result
-        }
-      }
+      LE.write(addStringList(R->getAssociatedUSRs())); // index into chunks
       auto AllKeywords = R->getDeclKeywords();
-      LE.write(static_cast<uint32_t>(AllKeywords.size()));
-      if (AllKeywords.empty()) {
-        LE.write(static_cast<uint32_t>(~0u));
-      } else {
-        LE.write(addString(AllKeywords[0].first));
-        addString(AllKeywords[0].second);
-        for (unsigned i = 1; i < AllKeywords.size(); ++i) {
-          addString(AllKeywords[i].first);
-          addString(AllKeywords[i].second);
-        }
+      SmallVector<StringRef, 8> keywordStrings;
+      for (auto &keyword : AllKeywords) {
+        keywordStrings.push_back(keyword.first);
+        keywordStrings.push_back(keyword.second);
       }
+      LE.write(static_cast<uint32_t>(AllKeywords.size()));
+      LE.write(addStringList(keywordStrings)); // index into chunks
     }
   }
   LE.write(static_cast<uint32_t>(results.tell()));
@@ -417,14 +436,17 @@ static std::string getName(StringRef cacheDirectory,
 
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::get(const Key &K) {
-  // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(getName(cacheDirectory, K));
+  // Try to find the cached file. Don't require a null terminator, so that
+  // the file can be mapped into memory.
+  auto bufferOrErr =
+      llvm::MemoryBuffer::getFile(getName(cacheDirectory, K), /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
   if (!bufferOrErr)
     return None;
 
   // Read the cached results, failing if they are out of date.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V))
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V))
     return None;
 
   return V;
@@ -460,7 +482,9 @@ std::error_code OnDiskCodeCompletionCache::set(const Key &K, ValueRefCntPtr V) {
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
   // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(filename);
+  auto bufferOrErr =
+      llvm::MemoryBuffer::getFile(filename, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
   if (!bufferOrErr)
     return None;
 
@@ -469,7 +493,7 @@ OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
 
   // Read the cached results.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V,
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V,
                         /*allowOutOfDate*/ true))
     return None;
 
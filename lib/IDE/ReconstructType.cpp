@@ -940,7 +940,7 @@ static void VisitNodeAssociatedTypeRef(
   }
   result._types.clear();
   result._error = stringWithFormat(
-      "unable to find associated type %s in context", ident->getText().c_str());
+      "unable to find associated type %s in context", ident->getText().data());
 }
 
 static void VisitNodeBoundGeneric(
@@ -987,7 +987,7 @@ static void VisitNodeBuiltinTypeName(
     ASTContext *ast, std::vector<Demangle::NodePointer> &nodes,
     Demangle::NodePointer &cur_node, VisitNodeResult &result,
     const VisitNodeResult &generic_context) { // set by GenericType case
-  std::string builtin_name = cur_node->getText();
+  std::string builtin_name = cur_node->getText().str();
 
   StringRef builtin_name_ref(builtin_name);
 
@@ -1407,7 +1407,7 @@ static void VisitNodeFunction(
       if (decl_scope_result._decls.size() == 0) {
         result._error = stringWithFormat(
             "demangled identifier %s could not be found by name lookup",
-            (*pos)->getText().c_str());
+            (*pos)->getText().data());
         break;
       }
       std::copy(decl_scope_result._decls.begin(),
@@ -1602,7 +1602,7 @@ static void VisitNodeSetterGetter(
       VisitNode(ast, nodes, decl_ctx_result, generic_context);
       break;
     case Demangle::Node::Kind::Identifier:
-      identifier.assign((*pos)->getText());
+      identifier.assign((*pos)->getText().str());
       break;
     case Demangle::Node::Kind::Type:
       nodes.push_back(*pos);
@@ -1771,7 +1771,7 @@ static void VisitNodeIdentifier(
     if (result._error.empty())
       result._error =
           stringWithFormat("unable to find Node::Kind::Identifier '%s'",
-                           cur_node->getText().c_str());
+                           cur_node->getText().data());
   }
 }
 
@@ -1830,7 +1830,7 @@ static void VisitNodePrivateDeclName(
     if (result._error.empty())
       result._error = stringWithFormat(
           "unable to find Node::Kind::PrivateDeclName '%s' in '%s'",
-          id_node->getText().c_str(), priv_decl_id_node->getText().c_str());
+          id_node->getText().data(), priv_decl_id_node->getText().data());
   }
 }
 
@@ -1894,7 +1894,7 @@ static void VisitNodeModule(
     Demangle::NodePointer &cur_node, VisitNodeResult &result,
     const VisitNodeResult &generic_context) { // set by GenericType case
   std::string error;
-  const char *module_name = cur_node->getText().c_str();
+  const char *module_name = cur_node->getText().data();
   if (!module_name || *module_name == '\0') {
     result._error = stringWithFormat("error: empty module name.");
     return;
@@ -2074,7 +2074,7 @@ static void VisitNodeTupleElement(
     const Demangle::Node::Kind child_node_kind = (*pos)->getKind();
     switch (child_node_kind) {
     case Demangle::Node::Kind::TupleElementName:
-      tuple_name = (*pos)->getText().c_str();
+      tuple_name = (*pos)->getText().data();
       break;
     case Demangle::Node::Kind::Type:
       nodes.push_back((*pos)->getFirstChild());
@@ -2378,9 +2378,10 @@ VisitNode(ASTContext *ast, std::vector<Demangle::NodePointer> &nodes,
 Decl *ide::getDeclFromMangledSymbolName(ASTContext &context,
                                         StringRef mangledName,
                                         std::string &error) {
+  Demangle::NodeFactory factory;
   std::vector<Demangle::NodePointer> nodes;
-  nodes.push_back(
-      Demangle::demangleSymbolAsNode(mangledName.data(), mangledName.size()));
+  nodes.push_back(Demangle::demangleSymbolAsNode(mangledName.data(),
+                                                 mangledName.size(), factory));
   VisitNodeResult emptyGenericContext;
   VisitNodeResult result;
   VisitNode(&context, nodes, result, emptyGenericContext);
@@ -2399,9 +2400,10 @@ Type ide::getTypeFromMangledTypename(ASTContext &Ctx,
                                      const char *mangled_typename,
                                      std::string &error) {
   ConstString mangled_name(mangled_typename);
+  Demangle::NodeFactory factory;
   std::vector<Demangle::NodePointer> nodes;
-  nodes.push_back(
-      Demangle::demangleTypeAsNode(mangled_typename, mangled_name.length()));
+  nodes.push_back(Demangle::demangleTypeAsNode(mangled_typename,
+                                               mangled_name.length(), factory));
   VisitNodeResult empty_generic_context;
   VisitNodeResult result;
 
@@ -2421,9 +2423,11 @@ Type ide::getTypeFromMangledSymbolname(ASTContext &Ctx,
                                        const char *mangled_typename,
                                        std::string &error) {
   ConstString mangled_name(mangled_typename);
+  Demangle::NodeFactory factory;
   std::vector<Demangle::NodePointer> nodes;
-  nodes.push_back(
-      Demangle::demangleSymbolAsNode(mangled_typename, mangled_name.length()));
+  nodes.push_back(Demangle::demangleSymbolAsNode(mangled_typename,
+                                                 mangled_name.length(),
+                                                 factory));
   VisitNodeResult empty_generic_context;
   VisitNodeResult result;
 
@@ -281,10 +281,15 @@ llvm::Value *irgen::emitReferenceToObjCProtocol(IRGenFunction &IGF,
 /// Emit a helper function to look up \c numProtocols witness tables given
 /// a value and a type metadata reference.
 ///
-/// The function's input type is (value, metadataValue, protocol...)
+/// The function's input type is (value, metadataValue, cache, protocol...)
 /// The function's output type is (value, witnessTable...)
 ///
 /// The value is NULL if the cast failed.
+///
+/// The cache is the monomorphic inline cache of the cast site: if it contains
+/// an entry for the type, the witness tables are taken from the entry instead
+/// of looking up the conformances in the runtime. There is no cache if
+/// \c numProtocols is 0.
 static llvm::Function *emitExistentialScalarCastFn(IRGenModule &IGM,
                                                    unsigned numProtocols,
                                                    CheckedCastMode mode,
@@ -318,6 +323,8 @@ static llvm::Function *emitExistentialScalarCastFn(IRGenModule &IGM,
   llvm::SmallVector<llvm::Type *, 4> returnTys;
   argTys.push_back(IGM.Int8PtrTy);
   argTys.push_back(IGM.TypeMetadataPtrTy);
+  if (numProtocols > 0)
+    argTys.push_back(IGM.Int8PtrPtrTy);
   returnTys.push_back(IGM.Int8PtrTy);
   for (unsigned i = 0; i < numProtocols; ++i) {
     argTys.push_back(IGM.ProtocolDescriptorPtrTy);
@@ -338,11 +345,51 @@ static llvm::Function *emitExistentialScalarCastFn(IRGenModule &IGM,
 
   auto value = args.claimNext();
   auto ref = args.claimNext();
+  llvm::Value *cache = numProtocols > 0 ? args.claimNext() : nullptr;
   auto failBB = IGF.createBasicBlock("fail");
   auto conformsToProtocol = IGM.getConformsToProtocolFn();
-  
+
+  // Check the inline cache of the cast site. A cache entry consists of the
+  // type metadata followed by the witness tables.
+  if (cache) {
+    auto checkBB = IGF.createBasicBlock("cacheCheck");
+    auto hitBB = IGF.createBasicBlock("cacheHit");
+    auto missBB = IGF.createBasicBlock("cacheMiss");
+
+    // Cache entries are immutable once they are stored in the cache, and the
+    // loads from the entry are address-dependent on the loaded pointer, so a
+    // naked load is sufficient (see emitLazyCacheAccessFunction).
+    auto entry = IGF.Builder.CreateLoad(Address(cache,
+                                                IGM.getPointerAlignment()));
+    auto isNull = IGF.Builder.CreateICmpEQ(entry,
+                                llvm::ConstantPointerNull::get(IGM.Int8PtrTy));
+    IGF.Builder.CreateCondBr(isNull, missBB, checkBB);
+
+    IGF.Builder.emitBlock(checkBB);
+    Address entryWords(IGF.Builder.CreateBitCast(entry, IGM.Int8PtrPtrTy),
+                       IGM.getPointerAlignment());
+    auto cachedType = IGF.Builder.CreateBitCast(
+                  IGF.Builder.CreateLoad(entryWords), IGM.TypeMetadataPtrTy);
+    auto isHit = IGF.Builder.CreateICmpEQ(cachedType, ref);
+    IGF.Builder.CreateCondBr(isHit, hitBB, missBB);
+
+    IGF.Builder.emitBlock(hitBB);
+    Explosion cachedRets;
+    cachedRets.add(value);
+    for (unsigned i = 0; i < numProtocols; ++i) {
+      auto slot = IGF.Builder.CreateConstArrayGEP(entryWords, i + 1,
+                                                  IGM.getPointerSize());
+      cachedRets.add(IGF.Builder.CreateBitCast(IGF.Builder.CreateLoad(slot),
+                                               IGM.WitnessTablePtrTy));
+    }
+    IGF.emitScalarReturn(returnTy, cachedRets);
+
+    IGF.Builder.emitBlock(missBB);
+  }
+
   Explosion rets;
   rets.add(value);
+  SmallVector<llvm::Value *, 4> witnesses;
 
   // Check the class constraint if necessary.
   if (checkClassConstraint) {
@@ -363,8 +410,26 @@ static llvm::Function *emitExistentialScalarCastFn(IRGenModule &IGM,
     
     IGF.Builder.emitBlock(contBB);
     rets.add(witness);
+    witnesses.push_back(witness);
   }
-  
+
+  // If we succeeded, remember the witnesses in the cache of the cast site.
+  if (cache) {
+    auto bufTy = llvm::ArrayType::get(IGM.WitnessTablePtrTy, numProtocols);
+    Address witnessesBuf = IGF.createAlloca(bufTy, IGM.getPointerAlignment(),
+                                            "witness_tables");
+    witnessesBuf = IGF.Builder.CreateBitCast(witnessesBuf,
+                                       IGM.WitnessTablePtrTy->getPointerTo());
+    for (unsigned i = 0; i < numProtocols; ++i) {
+      Address slot = IGF.Builder.CreateConstArrayGEP(witnessesBuf, i,
+                                                     IGM.getPointerSize());
+      IGF.Builder.CreateStore(witnesses[i], slot);
+    }
+    IGF.Builder.CreateCall(IGM.getDynamicCastFillInlineCacheFn(),
+                           {cache, ref, witnessesBuf.getAddress(),
+                            IGM.getSize(Size(numProtocols))});
+  }
+
   // If we succeeded, return the witnesses.
   IGF.emitScalarReturn(returnTy, rets);
   
@@ -668,6 +733,18 @@ void irgen::emitScalarExistentialDowncast(IRGenFunction &IGF,
   args.push_back(resultValue);
 
   args.push_back(metadataValue);
+
+  // Each cast site has its own inline cache for the witness tables.
+  if (!witnessTableProtos.empty()) {
+    auto cache = new llvm::GlobalVariable(IGF.IGM.Module, IGF.IGM.Int8PtrTy,
+                                          /*constant*/ false,
+                                          llvm::GlobalValue::PrivateLinkage,
+                       llvm::ConstantPointerNull::get(IGF.IGM.Int8PtrTy),
+                                          "dynamic_cast_cache");
+    cache->setAlignment(IGF.IGM.getPointerAlignment().getValue());
+    args.push_back(cache);
+  }
+
   for (auto proto : witnessTableProtos)
     args.push_back(proto);
 
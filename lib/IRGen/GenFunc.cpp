@@ -2308,6 +2308,8 @@ if (Builtin.ID == BuiltinValueKind::id) { \
     if (auto ExpectedPred = IGF.IGM.TargetInfo.OnceDonePredicateValue) {
       auto PredValue = IGF.Builder.CreateLoad(PredPtr,
                                               IGF.IGM.getPointerAlignment());
+      if (IGF.IGM.TargetInfo.OnceDonePredicateNeedsAcquire)
+        PredValue->setAtomic(llvm::AtomicOrdering::Acquire);
       auto ExpectedPredValue = llvm::ConstantInt::getSigned(IGF.IGM.OnceTy,
                                                             *ExpectedPred);
       auto PredIsDone = IGF.Builder.CreateICmpEQ(PredValue, ExpectedPredValue);
@@ -3767,7 +3769,8 @@ void irgen::emitFunctionPartialApplication(IRGenFunction &IGF,
                                            CanSILFunctionType origType,
                                            CanSILFunctionType substType,
                                            CanSILFunctionType outType,
-                                           Explosion &out) {
+                                           Explosion &out,
+                                           int &StackAllocSize) {
   // If we have a single Swift-refcounted context value, we can adopt it
   // directly as our closure context without creating a box and thunk.
   enum HasSingleSwiftRefcountedContext { Maybe, Yes, No, Thunkable }
@@ -3917,6 +3920,7 @@ void irgen::emitFunctionPartialApplication(IRGenFunction &IGF,
     llvm::Value *ctx = args.claimNext();
     ctx = IGF.Builder.CreateBitCast(ctx, IGF.IGM.RefCountedPtrTy);
     out.add(ctx);
+    StackAllocSize = -1;
     return;
   }
   
@@ -3959,6 +3963,7 @@ void irgen::emitFunctionPartialApplication(IRGenFunction &IGF,
       ctx = IGF.Builder.CreateLoad(ctx, IGF.IGM.getPointerAlignment());
     ctx = IGF.Builder.CreateBitCast(ctx, IGF.IGM.RefCountedPtrTy);
     out.add(ctx);
+    StackAllocSize = -1;
     return;
   }
 
@@ -3972,11 +3977,26 @@ void irgen::emitFunctionPartialApplication(IRGenFunction &IGF,
   llvm::Value *data;
   if (layout.isKnownEmpty()) {
     data = IGF.IGM.RefCountedNull;
+    StackAllocSize = -1;
   } else {
     // Allocate a new object.
     HeapNonFixedOffsets offsets(IGF, layout);
 
-    data = IGF.emitUnmanagedAlloc(layout, "closure", &offsets);
+    if (layout.isFixedLayout() &&
+        (int)layout.getSize().getValue() < StackAllocSize) {
+      // Allocate the context on the stack.
+      auto stackAddr = IGF.createAlloca(layout.getType(),
+                                        layout.getAlignment(),
+                                        "closure.raw");
+      data = IGF.Builder.CreateBitCast(stackAddr.getAddress(),
+                                       IGF.IGM.RefCountedPtrTy);
+      data = IGF.emitInitStackObjectCall(layout.getPrivateMetadata(IGF.IGM),
+                                         data, "closure");
+      StackAllocSize = layout.getSize().getValue();
+    } else {
+      data = IGF.emitUnmanagedAlloc(layout, "closure", &offsets);
+      StackAllocSize = -1;
+    }
     Address dataAddr = layout.emitCastTo(IGF, data);
 
     
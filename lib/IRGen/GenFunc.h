@@ -48,6 +48,11 @@ namespace irgen {
 
   /// Emit a partial application thunk for a function pointer applied to a
   /// partial set of argument values.
+  ///
+  /// If \p StackAllocSize is not negative, the context may be allocated on
+  /// the stack if its size is less than \p StackAllocSize. On return,
+  /// \p StackAllocSize is set to the size of the stack allocated context or
+  /// to -1 if the context was not allocated on the stack.
   void emitFunctionPartialApplication(IRGenFunction &IGF,
                                       llvm::Value *fnPtr,
                                       llvm::Value *fnContext,
@@ -57,7 +62,8 @@ namespace irgen {
                                       CanSILFunctionType origType,
                                       CanSILFunctionType substType,
                                       CanSILFunctionType outType,
-                                      Explosion &out);
+                                      Explosion &out,
+                                      int &StackAllocSize);
   
   /// Add function attributes to an attribute set for a byval argument.
   void addByvalArgumentAttributes(IRGenModule &IGM,
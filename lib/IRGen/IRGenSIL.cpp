@@ -331,7 +331,8 @@ public:
   llvm::DenseMap<SILValue, LoweredValue> LoweredValues;
   llvm::DenseMap<SILType, LoweredValue> LoweredUndefs;
 
-  /// All alloc_ref instructions which allocate the object on the stack.
+  /// All alloc_ref and partial_apply instructions which allocate the object
+  /// on the stack.
   llvm::SmallPtrSet<SILInstruction *, 8> StackAllocs;
   /// With closure captures it is actually possible to have two function
   /// arguments that both have the same name. Until this is fixed, we need to
@@ -2266,13 +2267,25 @@ void IRGenSILFunction::visitPartialApplyInst(swift::PartialApplyInst *i) {
     = getPartialApplicationFunction(*this, i->getCallee(),
                                     i->getSubstitutions());
   
+  int StackAllocSize = -1;
+  if (i->canAllocOnStack()) {
+    estimateStackSize();
+    // Is there enough space for stack allocation?
+    StackAllocSize = IGM.Opts.StackPromotionSizeLimit - EstimatedStackSize;
+  }
+
   // Create the thunk and function value.
   Explosion function;
   emitFunctionPartialApplication(*this, calleeFn, innerContext, llArgs,
                                  params, i->getSubstitutions(),
                                  origCalleeTy, i->getSubstCalleeType(),
                                  i->getType().castTo<SILFunctionType>(),
-                                 function);
+                                 function, StackAllocSize);
+  if (StackAllocSize >= 0) {
+    // Remember that this partial_apply allocates the context on the stack.
+    StackAllocs.insert(i);
+    EstimatedStackSize += StackAllocSize;
+  }
   setLoweredExplosion(v, function);
 }
 
@@ -3578,18 +3591,25 @@ void IRGenSILFunction::visitDeallocStackInst(swift::DeallocStackInst *i) {
 void IRGenSILFunction::visitDeallocRefInst(swift::DeallocRefInst *i) {
   // Lower the operand.
   Explosion self = getLoweredExplosion(i->getOperand());
+  auto *PAI = dyn_cast<PartialApplyInst>(i->getOperand());
+  // A closure is lowered to the function pointer and the context. Only the
+  // context is of interest.
+  if (PAI)
+    self.claimNext();
   auto selfValue = self.claimNext();
   if (!i->canAllocOnStack()) {
     auto classType = i->getOperand()->getType();
     emitClassDeallocation(*this, classType, selfValue);
     return;
   }
-  // It's a dealloc_ref [stack]. Even if the alloc_ref did not allocate the
-  // object on the stack, we don't have to deallocate it, because it is
-  // deallocated in the final release.
-  auto *ARI = cast<AllocRefInst>(i->getOperand());
-  assert(ARI->canAllocOnStack());
-  if (StackAllocs.count(ARI)) {
+  // It's a dealloc_ref [stack]. Even if the alloc_ref or partial_apply did
+  // not allocate the object on the stack, we don't have to deallocate it,
+  // because it is deallocated in the final release.
+  SILInstruction *Alloc = PAI;
+  if (!Alloc)
+    Alloc = cast<AllocRefInst>(i->getOperand());
+  assert(Alloc->isAllocatingStack());
+  if (StackAllocs.count(Alloc)) {
     if (IGM.Opts.EmitStackPromotionChecks) {
       selfValue = Builder.CreateBitCast(selfValue, IGM.RefCountedPtrTy);
       emitVerifyEndOfLifetimeCall(selfValue);
@@ -121,6 +121,45 @@ public:
     return emitLoadOfIsInline(IGF, T);
   }
 
+  // The runtime installs memcpy and no-op array witnesses if the type turns
+  // out to be POD or bitwise-takable when its metadata is instantiated, so
+  // call the array witnesses instead of emitting a loop over the elements.
+
+  void destroyArray(IRGenFunction &IGF, Address array, llvm::Value *count,
+                    SILType T) const override {
+    if (this->isPOD(ResilienceExpansion::Maximal))
+      return;
+    emitDestroyArrayCall(IGF, T, array, count);
+  }
+
+  void initializeArrayWithCopy(IRGenFunction &IGF,
+                               Address dest, Address src, llvm::Value *count,
+                               SILType T) const override {
+    if (this->isPOD(ResilienceExpansion::Maximal))
+      return super::initializeArrayWithCopy(IGF, dest, src, count, T);
+    emitInitializeArrayWithCopyCall(IGF, T, dest, src, count);
+  }
+
+  void initializeArrayWithTakeFrontToBack(IRGenFunction &IGF,
+                                          Address dest, Address src,
+                                          llvm::Value *count,
+                                          SILType T) const override {
+    if (this->isBitwiseTakable(ResilienceExpansion::Maximal))
+      return super::initializeArrayWithTakeFrontToBack(IGF, dest, src, count,
+                                                       T);
+    emitInitializeArrayWithTakeFrontToBackCall(IGF, T, dest, src, count);
+  }
+
+  void initializeArrayWithTakeBackToFront(IRGenFunction &IGF,
+                                          Address dest, Address src,
+                                          llvm::Value *count,
+                                          SILType T) const override {
+    if (this->isBitwiseTakable(ResilienceExpansion::Maximal))
+      return super::initializeArrayWithTakeBackToFront(IGF, dest, src, count,
+                                                       T);
+    emitInitializeArrayWithTakeBackToFrontCall(IGF, T, dest, src, count);
+  }
+
   /// FIXME: Dynamic extra inhabitant lookup.
   bool mayHaveExtraInhabitants(IRGenModule &) const override { return false; }
   llvm::Value *getExtraInhabitantIndex(IRGenFunction &IGF,
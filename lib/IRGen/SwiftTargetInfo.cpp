@@ -127,10 +127,13 @@ SwiftTargetInfo SwiftTargetInfo::get(IRGenModule &IGM) {
   SwiftTargetInfo target(triple.getObjectFormat(), pointerSize);
   
   // On Apple platforms, we implement "once" using dispatch_once, which exposes
-  // -1 as ABI for the "done" value.
-  if (triple.isOSDarwin())
-    target.OnceDonePredicateValue = -1L;
-  // TODO: Do we know this for Linux?
+  // -1 as ABI for the "done" value. The runtime's own implementation of
+  // swift_once on other platforms uses the same value, but the predicate must
+  // be read with acquire ordering, because it doesn't synchronize with
+  // dispatch_once's barriers.
+  target.OnceDonePredicateValue = -1L;
+  if (!triple.isOSDarwin())
+    target.OnceDonePredicateNeedsAcquire = true;
   
   switch (triple.getArch()) {
   case llvm::Triple::x86_64:
@@ -2202,7 +2202,7 @@ ParserStatus Parser::parseDecl(SmallVectorImpl<Decl*> &Entries,
   return Status;
 }
 
-void Parser::parseDeclDelayed() {
+bool Parser::parseDeclDelayed() {
   auto DelayedState = State->takeDelayedDeclState();
   assert(DelayedState.get() && "should have delayed state");
 
@@ -2231,6 +2231,7 @@ void Parser::parseDeclDelayed() {
 
   SmallVector<Decl *, 2> Entries;
   parseDecl(Entries, ParseDeclOptions(DelayedState->Flags));
+  return Tok.is(tok::eof);
 }
 
 /// \brief Parse an 'import' declaration, doing no token skipping on error.
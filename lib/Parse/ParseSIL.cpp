@@ -3473,8 +3473,13 @@ bool SILParser::parseCallInstruction(SILLocation InstLoc,
   SmallVector<UnresolvedValueName, 4> ArgNames;
 
   bool IsNonThrowingApply = false;
-  if (parseSILOptional(IsNonThrowingApply, *this, "nothrow"))
+  bool IsOnStack = false;
+  if (Opcode == ValueKind::PartialApplyInst) {
+    if (parseSILOptional(IsOnStack, *this, "stack"))
+      return true;
+  } else if (parseSILOptional(IsNonThrowingApply, *this, "nothrow")) {
     return true;
+  }
   
   if (parseValueName(FnName))
     return true;
@@ -3574,7 +3579,7 @@ bool SILParser::parseCallInstruction(SILLocation InstLoc,
       SILBuilder::getPartialApplyResultType(Ty, ArgNames.size(), SILMod, subs);
     // FIXME: Why the arbitrary order difference in IRBuilder type argument?
     ResultVal = B.createPartialApply(InstLoc, FnVal, FnTy,
-                                     subs, Args, closureTy);
+                                     subs, Args, closureTy, IsOnStack);
     break;
   }
   case ValueKind::TryApplyInst: {
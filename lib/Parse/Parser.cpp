@@ -97,11 +97,16 @@ private:
   }
 };
 
-static void parseDelayedDecl(
+/// Parses the delayed declaration and runs code completion on it.
+///
+/// If \p MustReachDeclEnd is true, code completion is skipped and false is
+/// returned if the declaration ends before the end of the delayed range.
+static bool parseDelayedDecl(
               PersistentParserState &ParserState,
-              CodeCompletionCallbacksFactory *CodeCompletionFactory) {
+              CodeCompletionCallbacksFactory *CodeCompletionFactory,
+              bool MustReachDeclEnd = false) {
   if (!ParserState.hasDelayedDecl())
-    return;
+    return true;
 
   SourceFile &SF = *ParserState.getDelayedDeclContext()->getParentSourceFile();
   SourceManager &SourceMgr = SF.getASTContext().SourceMgr;
@@ -122,12 +127,14 @@ static void parseDelayedDecl(
     break;
 
   case PersistentParserState::DelayedDeclKind::Decl:
-    TheParser.parseDeclDelayed();
+    if (!TheParser.parseDeclDelayed() && MustReachDeclEnd)
+      return false;
     break;
   }
 
   if (CodeCompletion)
     CodeCompletion->doneParsing();
+  return true;
 }
 } // unnamed namespace
 
@@ -164,6 +171,24 @@ void swift::performDelayedParsing(
     parseDelayedDecl(PersistentState, CodeCompletionFactory);
 }
 
+bool swift::performCodeCompletionReparse(
+    SourceFile &SF, unsigned BufferID,
+    const PersistentParserState::DelayedDeclInfo &Info,
+    CodeCompletionCallbacksFactory *Factory) {
+  SharedTimer timer("Parsing");
+  PersistentParserState State;
+  {
+    // The scope of the original parse is gone. Declarations in library files
+    // don't depend on names from the parser scope, so an empty top-level scope
+    // is enough.
+    Parser TheParser(BufferID, SF, nullptr, &State);
+    Scope S(&TheParser, ScopeKind::TopLevel);
+    State.delayDecl(Info.Kind, Info.Flags, Info.ParentContext, Info.BodyRange,
+                    Info.PreviousLoc);
+  }
+  return parseDelayedDecl(State, Factory, /*MustReachDeclEnd=*/true);
+}
+
 /// \brief Tokenizes a string literal, taking into account string interpolation.
 static void getStringPartTokens(const Token &Tok, const LangOptions &LangOpts,
                                 const SourceManager &SM,
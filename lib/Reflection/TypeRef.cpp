@@ -320,8 +320,8 @@ TypeRefPointer TypeRef::fromDemangleNode(Demangle::NodePointer Node) {
         return ProtocolCompositionTypeRef::create(Protocols);
     }
     case NodeKind::Protocol: {
-      auto moduleName = Node->getChild(0)->getText();
-      auto name = Node->getChild(1)->getText();
+      auto moduleName = Node->getChild(0)->getText().str();
+      auto name = Node->getChild(1)->getText().str();
       return ProtocolTypeRef::create(moduleName, name);
     }
     case NodeKind::DependentGenericParamType: {
@@ -356,7 +356,7 @@ TypeRefPointer TypeRef::fromDemangleNode(Demangle::NodePointer Node) {
     }
     case NodeKind::DependentMemberType: {
       auto base = fromDemangleNode(Node->getChild(0));
-      auto member = Node->getChild(1)->getText();
+      auto member = Node->getChild(1)->getText().str();
       return DependentMemberTypeRef::create(member, base);
     }
     default:
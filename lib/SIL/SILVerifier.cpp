@@ -1455,6 +1455,14 @@ public:
   void checkDeallocRefInst(DeallocRefInst *DI) {
     require(DI->getOperand()->getType().isObject(),
             "Operand of dealloc_ref must be object");
+    // The context of a stack promoted partial_apply is deallocated with a
+    // dealloc_ref [stack].
+    if (auto *PAI = dyn_cast<PartialApplyInst>(DI->getOperand())) {
+      require(DI->canAllocOnStack() && PAI->canAllocOnStack(),
+              "dealloc_ref of a partial_apply must be [stack] and match a "
+              "partial_apply [stack]");
+      return;
+    }
     require(DI->getOperand()->getType().getClassOrBoundGenericClass(),
             "Operand of dealloc_ref must be of class type");
   }
@@ -0,0 +1,78 @@
+//===--- ProfileAnalysis.cpp - Execution counts from a profile ------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "sil-profile-analysis"
+#include "swift/SILOptimizer/Analysis/ProfileAnalysis.h"
+#include "swift/AST/ASTContext.h"
+#include "swift/AST/DiagnosticsSIL.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ProfileData/InstrProfReader.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+ProfileAnalysis::ProfileAnalysis(SILModule *M)
+    : SILAnalysis(AnalysisKind::Profile), M(M) {}
+
+ProfileAnalysis::~ProfileAnalysis() {}
+
+void ProfileAnalysis::readProfile() {
+  ProfileRead = true;
+  StringRef Path = M->getOptions().UseProfile;
+  if (Path.empty())
+    return;
+
+  auto ReaderOrErr = llvm::IndexedInstrProfReader::create(Path);
+  if (std::error_code EC = ReaderOrErr.getError()) {
+    M->getASTContext().Diags.diagnose(SourceLoc(), diag::profile_read_error,
+                                      Path, EC.message());
+    return;
+  }
+  Reader = std::move(ReaderOrErr.get());
+  MaxEntryCount = Reader->getMaximumFunctionCount();
+  DEBUG(llvm::dbgs() << "Read profile " << Path << ", max entry count "
+                     << MaxEntryCount << '\n');
+}
+
+llvm::Optional<uint64_t> ProfileAnalysis::getEntryCount(SILFunction *F) {
+  if (!hasProfile())
+    return llvm::None;
+
+  auto Iter = EntryCounts.find(F->getName());
+  if (Iter != EntryCounts.end())
+    return Iter->second;
+
+  // The profile records are keyed by the mangled name of the function, which
+  // is the same name as the SIL function name (see SILGenProfiling). SILGen
+  // does not compute a structural hash yet, so the hash is always zero.
+  llvm::Optional<uint64_t> Result;
+  std::vector<uint64_t> Counts;
+  if (!Reader->getFunctionCounts(F->getName(), /*FuncHash=*/0, Counts) &&
+      !Counts.empty()) {
+    // Counter 0 is the counter of the function body, i.e. the entry count.
+    Result = Counts[0];
+  }
+  EntryCounts[F->getName()] = Result;
+  return Result;
+}
+
+bool ProfileAnalysis::isHot(SILFunction *F, unsigned PerMille) {
+  auto Count = getEntryCount(F);
+  if (!Count.hasValue() || MaxEntryCount == 0)
+    return false;
+  return Count.getValue() * 1000 >= MaxEntryCount * PerMille;
+}
+
+SILAnalysis *swift::createProfileAnalysis(SILModule *M) {
+  return new ProfileAnalysis(M);
+}
@@ -16,6 +16,7 @@
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILArgument.h"
+#include "swift/Serialization/SerializedSILLoader.h"
 
 using namespace swift;
 
@@ -171,6 +172,113 @@ bool SideEffectAnalysis::getDefinedEffects(FunctionEffects &Effects,
   return false;
 }
 
+bool SideEffectAnalysis::getSummaryEffects(FunctionEffects &Effects,
+                                           SILFunction *F) {
+  if (!F->isExternalDeclaration())
+    return false;
+
+  // Declarations which are created by SILGen don't have a summary. Try to pick
+  // it up from the serialized declaration in the defining module, but only
+  // once per function.
+  if (!F->hasEffectsSummary() && SummaryLookups.insert(F).second) {
+    if (SerializedSILLoader *Loader = F->getModule().getSILLoader())
+      Loader->lookupSILFunction(F->getName(), /*declarationOnly*/ true);
+  }
+  if (!F->hasEffectsSummary())
+    return false;
+
+  // The summary must match the number of arguments of the call.
+  FunctionEffects SummaryEffects(Effects.ParamEffects.size());
+  if (!decodeSummary(SummaryEffects, F->getEffectsSummary()))
+    return false;
+
+  DEBUG(llvm::dbgs() << "  -- use effects summary of " << F->getName()
+                     << '\n');
+  Effects.mergeFrom(SummaryEffects);
+  return true;
+}
+
+namespace {
+/// Bits of the first byte of an effects summary.
+enum SummaryFlags : uint8_t {
+  SummaryAllocsObjects = 1 << 0,
+  SummaryTraps = 1 << 1,
+  SummaryReadsRC = 1 << 2,
+  SummaryAllFlags = SummaryAllocsObjects | SummaryTraps | SummaryReadsRC
+};
+
+/// Bits of the global and parameter effects bytes of an effects summary.
+enum SummaryEffects : uint8_t {
+  SummaryReads = 1 << 0,
+  SummaryWrites = 1 << 1,
+  SummaryRetains = 1 << 2,
+  SummaryReleases = 1 << 3,
+  SummaryAllEffects = SummaryReads | SummaryWrites | SummaryRetains |
+                      SummaryReleases
+};
+} // end anonymous namespace
+
+static uint8_t encodeEffects(const Effects &E) {
+  uint8_t Bits = 0;
+  if (E.mayRead())
+    Bits |= SummaryReads;
+  if (E.mayWrite())
+    Bits |= SummaryWrites;
+  if (E.mayRetain())
+    Bits |= SummaryRetains;
+  if (E.mayRelease())
+    Bits |= SummaryReleases;
+  return Bits;
+}
+
+void SideEffectAnalysis::encodeSummary(const FunctionEffects &FE,
+                                       SmallVectorImpl<uint8_t> &Summary) {
+  uint8_t Flags = 0;
+  if (FE.AllocsObjects)
+    Flags |= SummaryAllocsObjects;
+  if (FE.Traps)
+    Flags |= SummaryTraps;
+  if (FE.ReadsRC)
+    Flags |= SummaryReadsRC;
+
+  Summary.clear();
+  Summary.push_back(Flags);
+  Summary.push_back(encodeEffects(FE.GlobalEffects));
+  for (const Effects &PE : FE.ParamEffects)
+    Summary.push_back(encodeEffects(PE));
+}
+
+bool SideEffectAnalysis::decodeSummary(FunctionEffects &FE,
+                                       ArrayRef<uint8_t> Summary) {
+  if (Summary.size() != FE.ParamEffects.size() + 2)
+    return false;
+
+  auto decodeEffects = [](Effects &E, uint8_t Bits) -> bool {
+    if (Bits & ~SummaryAllEffects)
+      return false;
+    E.Reads = (Bits & SummaryReads) != 0;
+    E.Writes = (Bits & SummaryWrites) != 0;
+    E.Retains = (Bits & SummaryRetains) != 0;
+    E.Releases = (Bits & SummaryReleases) != 0;
+    return true;
+  };
+
+  uint8_t Flags = Summary[0];
+  if (Flags & ~SummaryAllFlags)
+    return false;
+  FE.AllocsObjects = (Flags & SummaryAllocsObjects) != 0;
+  FE.Traps = (Flags & SummaryTraps) != 0;
+  FE.ReadsRC = (Flags & SummaryReadsRC) != 0;
+
+  if (!decodeEffects(FE.GlobalEffects, Summary[1]))
+    return false;
+  for (unsigned Idx = 0, e = FE.ParamEffects.size(); Idx < e; ++Idx) {
+    if (!decodeEffects(FE.ParamEffects[Idx], Summary[Idx + 2]))
+      return false;
+  }
+  return true;
+}
+
 bool SideEffectAnalysis::getSemanticEffects(FunctionEffects &FE,
                                             ArraySemanticsCall ASC) {
   assert(ASC.hasSelf());
@@ -292,6 +400,12 @@ void SideEffectAnalysis::analyzeInstruction(FunctionInfo *FInfo,
       // Does the function have any @effects?
       if (getDefinedEffects(FInfo->FE, SingleCallee))
         return;
+      // Is it an external function with a serialized effects summary?
+      FunctionEffects ApplyEffects(FAS.getNumArguments());
+      if (getSummaryEffects(ApplyEffects, SingleCallee)) {
+        FInfo->FE.mergeFromApply(ApplyEffects, FAS);
+        return;
+      }
     }
 
     if (RecursionDepth < MaxRecursionDepth) {
@@ -471,6 +585,9 @@ void SideEffectAnalysis::getEffects(FunctionEffects &ApplyEffects, FullApplySite
     // Does the function have any @effects?
     if (getDefinedEffects(ApplyEffects, SingleCallee))
       return;
+    // Is it an external function with a serialized effects summary?
+    if (getSummaryEffects(ApplyEffects, SingleCallee))
+      return;
   }
 
   auto Callees = BCA->getCalleeList(FAS);
@@ -493,6 +610,7 @@ void SideEffectAnalysis::getEffects(FunctionEffects &ApplyEffects, FullApplySite
 
 void SideEffectAnalysis::invalidate(InvalidationKind K) {
   Function2Info.clear();
+  SummaryLookups.clear();
   Allocator.DestroyAll();
   DEBUG(llvm::dbgs() << "invalidate all\n");
 }
@@ -257,7 +257,8 @@ void CapturePropagation::rewritePartialApply(PartialApplyInst *OrigPAI,
                                            SpecialF->getLoweredType(),
                                            ArrayRef<Substitution>(),
                                            ArrayRef<SILValue>(),
-                                           OrigPAI->getType());
+                                           OrigPAI->getType(),
+                                           OrigPAI->canAllocOnStack());
   OrigPAI->replaceAllUsesWith(NewPAI);
   recursivelyDeleteTriviallyDeadInstructions(OrigPAI, true);
   DEBUG(llvm::dbgs() << "  Rewrote caller:\n" << *NewPAI);
@@ -0,0 +1,78 @@
+//===--- ComputeEffectsSummaries.cpp - Summarize side-effects -------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Attaches a side-effect summary to all public functions of the module. The
+// summaries are serialized with the function declarations, so that the
+// side-effect analysis of client modules doesn't need to be conservative for
+// calls to these functions.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "compute-effects-summaries"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumSummaries, "Number of computed side-effect summaries");
+
+namespace {
+
+class ComputeEffectsSummaries : public SILModuleTransform {
+
+  /// Returns true if \p FE doesn't say anything more than the conservative
+  /// assumption for an unknown function.
+  static bool hasWorstEffects(const SideEffectAnalysis::FunctionEffects &FE) {
+    const auto &GE = FE.getGlobalEffects();
+    return GE.mayRead() && GE.mayWrite() && GE.mayRetain() &&
+           GE.mayRelease() && FE.mayAllocObjects() && FE.mayTrap() &&
+           FE.mayReadRC();
+  }
+
+  void run() override {
+    auto *SEA = PM->getAnalysis<SideEffectAnalysis>();
+
+    for (auto &F : *getModule()) {
+      // Only public functions can be referenced from other modules.
+      if (!F.isDefinition() || !hasPublicVisibility(F.getLinkage()))
+        continue;
+
+      // @effects attributes are serialized anyway.
+      if (F.getEffectsKind() != EffectsKind::Unspecified)
+        continue;
+
+      const auto &FE = SEA->getEffects(&F);
+      if (hasWorstEffects(FE))
+        continue;
+
+      SmallVector<uint8_t, 8> Summary;
+      SideEffectAnalysis::encodeSummary(FE, Summary);
+      DEBUG(llvm::dbgs() << "effects summary for " << F.getName() << ": "
+                         << FE << '\n');
+      F.setEffectsSummary(Summary);
+      ++NumSummaries;
+    }
+  }
+
+  StringRef getName() override { return "Compute Effects Summaries"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createComputeEffectsSummaries() {
+  return new ComputeEffectsSummaries();
+}
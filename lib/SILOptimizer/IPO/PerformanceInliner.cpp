@@ -19,6 +19,7 @@
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
+#include "swift/SILOptimizer/Analysis/ProfileAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/Local.h"
@@ -36,6 +37,9 @@
 using namespace swift;
 
 STATISTIC(NumFunctionsInlined, "Number of functions inlined");
+STATISTIC(NumHotCallsInlined, "Number of hot call sites inlined (profile)");
+STATISTIC(NumNeverExecutedNotInlined,
+          "Number of never executed callees kept out of line (profile)");
 
 namespace {
 
@@ -46,6 +50,11 @@ namespace {
   llvm::cl::opt<int> TestThreshold("sil-inline-test-threshold",
                                         llvm::cl::init(-1), llvm::cl::Hidden);
 
+  // A function is considered hot if its entry count in the profile is at least
+  // this fraction (in 1/1000) of the maximum function entry count.
+  llvm::cl::opt<unsigned> HotFunctionPerMille(
+      "sil-inline-profile-hot-permille", llvm::cl::init(10), llvm::cl::Hidden);
+
   // The following constants define the cost model for inlining.
 
   // The base value for every call: it represents the benefit of removing the
@@ -71,6 +80,10 @@ namespace {
   // Configuration for the caller block limit.
   const unsigned BlockLimitDenominator = 10000;
 
+  // Additional benefit if both, the caller and the callee, are hot according
+  // to the profile (see -profile-use).
+  const unsigned HotCallBenefit = 2 * RemovedCallBenefit;
+
   // Represents a value in integer constant evaluation.
   struct IntConst {
     IntConst() : isValid(false), isFromCaller(false) { }
@@ -219,6 +232,9 @@ namespace {
     /// global_init attributes.
     InlineSelection WhatToInline;
 
+    /// Function entry counts from the profile, if one is available.
+    ProfileAnalysis *PA;
+
 #ifndef NDEBUG
     SILFunction *LastPrintedCaller = nullptr;
     void dumpCaller(SILFunction *Caller) {
@@ -239,6 +255,10 @@ namespace {
 
     bool isProfitableInColdBlock(FullApplySite AI, SILFunction *Callee);
 
+    bool isHotCall(FullApplySite AI, SILFunction *Callee);
+
+    bool isNeverExecuted(SILFunction *F);
+
     void visitColdBlocks(SmallVectorImpl<FullApplySite> &AppliesToInline,
                          SILBasicBlock *root, DominanceInfo *DT);
 
@@ -247,8 +267,9 @@ namespace {
                                 DominanceAnalysis *DA, SILLoopAnalysis *LA);
 
   public:
-    SILPerformanceInliner(int threshold, InlineSelection WhatToInline)
-        : InlineCostThreshold(threshold), WhatToInline(WhatToInline) {}
+    SILPerformanceInliner(int threshold, InlineSelection WhatToInline,
+                          ProfileAnalysis *PA)
+        : InlineCostThreshold(threshold), WhatToInline(WhatToInline), PA(PA) {}
 
     bool inlineCallsIntoFunction(SILFunction *F, DominanceAnalysis *DA,
                                  SILLoopAnalysis *LA);
@@ -679,6 +700,12 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
   Benefit += loopDepthOfAI * LoopBenefitFactor;
   int testThreshold = TestThreshold;
 
+  // A hot call site is worth inlining even if the static cost model is
+  // undecided: the call overhead is paid very often.
+  bool HotCall = isHotCall(AI, Callee);
+  if (HotCall)
+    Benefit += HotCallBenefit;
+
   while (SILBasicBlock *block = domOrder.getNext()) {
     constTracker.beginBlock();
     for (SILInstruction &I : *block) {
@@ -725,6 +752,10 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
     // Only inline trivial functions into thunks (which will not increase the
     // code size).
     Threshold = TrivialFunctionThreshold;
+  } else if (isNeverExecuted(Callee)) {
+    // The callee was never executed in the profiled run. Keep it out of line
+    // (unless it's trivial) so that its code does not bloat the caller.
+    Threshold = TrivialFunctionThreshold;
   } else {
     // The default case.
     // We reduce the benefit if the caller is too large. For this we use a
@@ -740,15 +771,19 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
   }
 
   if (CalleeCost > Threshold) {
+    if (Threshold == TrivialFunctionThreshold && isNeverExecuted(Callee))
+      NumNeverExecutedNotInlined++;
     return false;
   }
   NumCallerBlocks += Callee->size();
+  if (HotCall)
+    NumHotCallsInlined++;
 
   DEBUG(
     dumpCaller(AI.getFunction());
     llvm::dbgs() << "    decision {" << CalleeCost << " < " << Threshold <<
-        ", ld=" << loopDepthOfAI << ", bb=" << NumCallerBlocks << "} " <<
-        Callee->getName() << '\n';
+        ", ld=" << loopDepthOfAI << ", bb=" << NumCallerBlocks <<
+        (HotCall ? ", hot" : "") << "} " << Callee->getName() << '\n';
   );
   return true;
 }
@@ -789,6 +824,23 @@ bool SILPerformanceInliner::isProfitableInColdBlock(FullApplySite AI,
   return true;
 }
 
+/// Return true if the call site is hot according to the profile, i.e. both the
+/// caller and the callee are frequently executed.
+///
+/// The profile only contains the function entry counts, so the callee's count
+/// is used as an approximation for the execution count of the call site.
+bool SILPerformanceInliner::isHotCall(FullApplySite AI, SILFunction *Callee) {
+  if (!PA->hasProfile())
+    return false;
+  return PA->isHot(AI.getFunction(), HotFunctionPerMille) &&
+         PA->isHot(Callee, HotFunctionPerMille);
+}
+
+/// Return true if \p F is known to be never executed in the profiled run.
+bool SILPerformanceInliner::isNeverExecuted(SILFunction *F) {
+  return PA->hasProfile() && PA->isNeverExecuted(F);
+}
+
 void SILPerformanceInliner::collectAppliesToInline(
     SILFunction *Caller, SmallVectorImpl<FullApplySite> &Applies,
     DominanceAnalysis *DA, SILLoopAnalysis *LA) {
@@ -801,6 +853,13 @@ void SILPerformanceInliner::collectAppliesToInline(
 
   unsigned NumCallerBlocks = Caller->size();
 
+  // If the caller was never executed in the profiled run, the whole function
+  // is cold. Only inline what would be inlined into a cold block.
+  if (isNeverExecuted(Caller)) {
+    visitColdBlocks(Applies, &Caller->front(), DT);
+    return;
+  }
+
   // Go through all instructions and find candidates for inlining.
   // We do this in dominance order for the constTracker.
   SmallVector<FullApplySite, 8> InitialCandidates;
@@ -952,13 +1011,14 @@ public:
   void run() override {
     DominanceAnalysis *DA = PM->getAnalysis<DominanceAnalysis>();
     SILLoopAnalysis *LA = PM->getAnalysis<SILLoopAnalysis>();
+    ProfileAnalysis *PA = PM->getAnalysis<ProfileAnalysis>();
 
     if (getOptions().InlineThreshold == 0) {
       return;
     }
 
     SILPerformanceInliner Inliner(getOptions().InlineThreshold,
-                                  WhatToInline);
+                                  WhatToInline, PA);
 
     assert(getFunction()->isDefinition() &&
            "Expected only functions with bodies!");
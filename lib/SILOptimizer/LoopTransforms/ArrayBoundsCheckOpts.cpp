@@ -883,12 +883,101 @@ static bool isGuaranteedToBeExecuted(DominanceInfo *DT, SILBasicBlock *Block,
   return DT->dominates(Block, ExitingBlk);
 }
 
+/// The maximum number of arithmetic operations we look through when matching
+/// an affine access function.
+static const unsigned MaxAffineDepth = 4;
+
+/// The maximum absolute value of the stride and offset of an affine access
+/// function. This avoids overflows when combining constants at compile time.
+static const int64_t MaxAffineConstant = int64_t(1) << 32;
+
+/// Matches the builtin integer \p V against "Stride * i + Offset", where i is a
+/// canonical induction variable and Stride and Offset are constants.
+///
+/// All arithmetic must be overflow checked. Otherwise the access function
+/// might not be monotonic and checking the first and last index would not be
+/// sufficient.
+static bool matchAffineIndex(SILValue V, InductionAnalysis &IndVars,
+                             InductionInfo *&Ind, int64_t &Stride,
+                             int64_t &Offset, unsigned Depth) {
+  if (auto *Arg = dyn_cast<SILArgument>(V)) {
+    Ind = IndVars[Arg];
+    Stride = 1;
+    Offset = 0;
+    return Ind != nullptr;
+  }
+
+  if (Depth >= MaxAffineDepth)
+    return false;
+
+  // %r = builtin "sadd_with_overflow"(%x, %c, ...)
+  // %v = tuple_extract %r, 0
+  auto *TEI = dyn_cast<TupleExtractInst>(V);
+  if (!TEI || TEI->getFieldNo() != 0)
+    return false;
+  auto *BI = dyn_cast<BuiltinInst>(TEI->getOperand());
+  if (!BI || BI->getNumArguments() != 3 || !isOverflowChecked(BI))
+    return false;
+
+  BuiltinValueKind Kind = BI->getBuiltinInfo().ID;
+  SILValue X = BI->getArgument(0);
+  auto *Lit = dyn_cast<IntegerLiteralInst>(BI->getArgument(1));
+  if (!Lit && Kind != BuiltinValueKind::SSubOver) {
+    // Addition and multiplication are commutative.
+    X = BI->getArgument(1);
+    Lit = dyn_cast<IntegerLiteralInst>(BI->getArgument(0));
+  }
+  if (!Lit || Lit->getValue().getMinSignedBits() > 32)
+    return false;
+  int64_t C = Lit->getValue().getSExtValue();
+
+  if (!matchAffineIndex(X, IndVars, Ind, Stride, Offset, Depth + 1))
+    return false;
+
+  switch (Kind) {
+    case BuiltinValueKind::SAddOver:
+      Offset += C;
+      break;
+    case BuiltinValueKind::SSubOver:
+      Offset -= C;
+      break;
+    case BuiltinValueKind::SMulOver:
+      // A negative or zero stride would invert or collapse the range.
+      if (C <= 0)
+        return false;
+      Stride *= C;
+      Offset *= C;
+      break;
+    default:
+      return false;
+  }
+  return Stride < MaxAffineConstant && Offset < MaxAffineConstant &&
+         Offset > -MaxAffineConstant;
+}
+
+/// Create an overflow checked arithmetic operation of \p Val and the constant
+/// \p C.
+static SILValue createCheckedArith(SILLocation Loc, StringRef Name,
+                                   SILValue Val, int64_t C, SILBuilder &B) {
+  SmallVector<SILValue, 4> Args(1, Val);
+  Args.push_back(B.createIntegerLiteral(Loc, Val->getType(), C));
+  Args.push_back(B.createIntegerLiteral(
+      Loc, SILType::getBuiltinIntegerType(1, B.getASTContext()), -1));
+
+  auto *AI = B.createBuiltinBinaryFunctionWithOverflow(Loc, Name, Args);
+  B.createCondFail(Loc, B.createTupleExtract(Loc, AI, 1));
+  return B.createTupleExtract(Loc, AI, 0);
+}
+
 /// Describes the access function "a[f(i)]" that is based on a canonical
-/// induction variable.
+/// induction variable. The access function is affine: "Stride * i + Offset".
 class AccessFunction {
   InductionInfo *Ind;
+  int64_t Stride;
+  int64_t Offset;
 
-  AccessFunction(InductionInfo *I) { Ind = I; }
+  AccessFunction(InductionInfo *I, int64_t Stride = 1, int64_t Offset = 0)
+      : Ind(I), Stride(Stride), Offset(Offset) {}
 public:
 
   operator bool() { return Ind != nullptr; }
@@ -902,20 +991,31 @@ public:
     if (!ArrayIndexStruct)
       return nullptr;
 
-    auto AsArg =
-        dyn_cast<SILArgument>(ArrayIndexStruct->getElements()[0]);
-    if (!AsArg)
+    InductionInfo *Ind = nullptr;
+    int64_t Stride, Offset;
+    if (!matchAffineIndex(ArrayIndexStruct->getElements()[0], IndVars, Ind,
+                          Stride, Offset, 0))
       return nullptr;
 
-    if (auto *Ind = IndVars[AsArg])
-      return AccessFunction(Ind);
-
-    return nullptr;
+    return AccessFunction(Ind, Stride, Offset);
   }
 
   /// Returns true if the loop iterates from 0 until count of \p Array.
   bool isZeroToCount(SILValue Array) {
-    return getZeroToCountArray(Ind->Start, Ind->End) == Array;
+    return Stride == 1 && Offset == 0 &&
+           getZeroToCountArray(Ind->Start, Ind->End) == Array;
+  }
+
+  /// Computes the access function for the induction value \p IVVal.
+  ///
+  /// The arithmetic is overflow checked: the loop computes the same value in
+  /// its last iteration, so it would trap anyway.
+  SILValue getIndexAt(SILValue IVVal, SILLocation Loc, SILBuilder &B) {
+    if (Stride != 1)
+      IVVal = createCheckedArith(Loc, "smul_with_overflow", IVVal, Stride, B);
+    if (Offset != 0)
+      IVVal = createCheckedArith(Loc, "sadd_with_overflow", IVVal, Offset, B);
+    return IVVal;
   }
 
   /// Hoists the necessary check for beginning and end of the induction
@@ -927,8 +1027,8 @@ public:
     SILLocation Loc = AI->getLoc();
     SILBuilderWithScope Builder(Preheader->getTerminator(), AI);
 
-    // Get the first induction value.
-    auto FirstVal = Ind->getFirstValue();
+    // Get the index of the first induction value.
+    auto FirstVal = getIndexAt(Ind->getFirstValue(), Loc, Builder);
     // Clone the struct for the start index.
     auto Start = cast<SILInstruction>(CheckToHoist.getIndex())
                      ->clone(Preheader->getTerminator());
@@ -939,8 +1039,9 @@ public:
     auto NewCheck = CheckToHoist.copyTo(Preheader->getTerminator(), DT);
     NewCheck->setOperand(1, Start);
 
-    // Get the last induction value.
-    auto LastVal = Ind->getLastValue(Loc, Builder);
+    // Get the index of the last induction value. As the stride is positive,
+    // the access function is monotonic and all indices are in between.
+    auto LastVal = getIndexAt(Ind->getLastValue(Loc, Builder), Loc, Builder);
     // Clone the struct for the end index.
     auto End = cast<SILInstruction>(CheckToHoist.getIndex())
                    ->clone(Preheader->getTerminator());
@@ -1012,8 +1113,8 @@ static bool hoistChecksInLoop(DominanceInfo *DT, DominanceInfoNode *DTNode,
       continue;
     }
 
-    // Get the access function "a[f(i)]". At the moment this handles only the
-    // identity function.
+    // Get the access function "a[f(i)]". This handles affine functions of the
+    // induction variable with constant stride and offset.
     auto F = AccessFunction::getLinearFunction(ArrayIndex, IndVars);
     if (!F) {
       DEBUG(llvm::dbgs() << " not a linear function " << *Inst);
@@ -1073,10 +1174,9 @@ static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
     return false;
   }
 
-  // Only handle innermost loops for now.
-  if (!Loop->getSubLoops().empty())
-    return false;
-
+  // Loops are processed bottom-up. Checks which were hoisted into the
+  // preheader of an inner loop can be hoisted further out of the outer loop,
+  // e.g. for multi-dimensional array accesses.
   DEBUG(llvm::dbgs() << "Attempting to remove redundant checks in " << *Loop);
   DEBUG(Header->getParent()->dump());
 
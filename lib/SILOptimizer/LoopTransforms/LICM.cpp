@@ -231,6 +231,11 @@ static bool canHoistInstruction(SILInstruction *Inst, SILLoop *Loop,
   if (isa<AllocationInst>(Inst) || isa<DeallocStackInst>(Inst))
     return false;
 
+  // Can't hoist stack allocated closure contexts, because the deallocation
+  // stays inside the loop.
+  if (Inst->isAllocatingStack())
+    return false;
+
   // Can't hoist instructions which may have side effects.
   if (!hasNoSideEffect(Inst, SafeReads))
     return false;
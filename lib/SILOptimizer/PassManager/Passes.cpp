@@ -48,6 +48,10 @@ llvm::cl::opt<bool> SILViewSILGenCFG(
     "sil-view-silgen-cfg", llvm::cl::init(false),
     llvm::cl::desc("Enable the sil cfg viewer pass before diagnostics"));
 
+llvm::cl::opt<bool> SILReportUnspecializedCalls(
+    "sil-report-unspecialized-calls", llvm::cl::init(false),
+    llvm::cl::desc("Report generic calls which remain unspecialized"));
+
 using namespace swift;
 
 // Enumerates the optimization kinds that we do in SIL.
@@ -285,8 +289,10 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.addDeadObjectElimination();
   PM.addGlobalPropertyOpt();
 
-  // Do the first stack promotion on high-level SIL.
-  PM.addStackPromotion();
+  // Do the first stack promotion on high-level SIL. Closures are not promoted
+  // yet, because the following inlining and closure specialization can't
+  // delete stack allocated closures.
+  PM.addEarlyStackPromotion();
 
   PM.runOneIteration();
   PM.resetAndRemoveTransformations();
@@ -318,7 +324,8 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   // Specialize closure.
   PM.addClosureSpecializer();
 
-  // Do the second stack promotion on low-level SIL.
+  // Do the second stack promotion on low-level SIL. This also promotes
+  // closure contexts.
   PM.addStackPromotion();
 
   // Speculate virtual call targets.
@@ -363,8 +370,19 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   // Remove dead code.
   PM.addDCE();
   PM.addSimplifyCFG();
+
+  // Summarize the side-effects of public functions for client modules. This
+  // must run after all transformations which can change the effects.
+  PM.addComputeEffectsSummaries();
   PM.runOneIteration();
 
+  // Report the generic calls which could not be specialized.
+  if (SILReportUnspecializedCalls) {
+    PM.resetAndRemoveTransformations();
+    PM.addUnspecializedCallReporter();
+    PM.runOneIteration();
+  }
+
   // Call the CFG viewer.
   if (SILViewCFG) {
     PM.resetAndRemoveTransformations();
@@ -51,6 +51,10 @@ static bool foldInverseReabstractionThunks(PartialApplyInst *PAI,
   if (!PAI2Arg)
     return false;
 
+  // A stack allocated context must stay paired with its dealloc_ref [stack].
+  if (PAI->canAllocOnStack())
+    return false;
+
   // The types must match.
   if (PAI->getType() != PAI2->getArgument(0)->getType())
     return false;
@@ -69,7 +73,8 @@ static bool foldInverseReabstractionThunks(PartialApplyInst *PAI,
 SILInstruction *SILCombiner::visitPartialApplyInst(PartialApplyInst *PAI) {
   // partial_apply without any substitutions or arguments is just a
   // thin_to_thick_function.
-  if (!PAI->hasSubstitutions() && (PAI->getNumArguments() == 0))
+  if (!PAI->hasSubstitutions() && (PAI->getNumArguments() == 0) &&
+      !PAI->canAllocOnStack())
     return Builder.createThinToThickFunction(PAI->getLoc(), PAI->getCallee(),
                                              PAI->getType());
 
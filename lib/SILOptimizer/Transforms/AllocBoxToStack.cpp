@@ -756,7 +756,8 @@ specializePartialApply(PartialApplyInst *PartialApply,
   return Builder.createPartialApply(PartialApply->getLoc(), FunctionRef,
                                  SILType::getPrimitiveObjectType(SubstCalleeTy),
                                     PartialApply->getSubstitutions(), Args,
-                                    PartialApply->getType());
+                                    PartialApply->getType(),
+                                    PartialApply->canAllocOnStack());
 }
 
 static void
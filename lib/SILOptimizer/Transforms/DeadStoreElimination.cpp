@@ -155,12 +155,15 @@ namespace {
 /// behavior or alias query we need to do in worst case is roughly linear to
 /// # of BBs x(times) # of locations.
 ///
-/// we could run DSE on functions with 256 basic blocks and 256 locations,
-/// which is a large function.  
+/// Only basic blocks which access memory are counted, as all other blocks are
+/// transparent to the data flow and are never scanned.
+///
+/// we could run DSE on functions with 256 memory accessing basic blocks and
+/// 256 locations, which is a large function.
 constexpr unsigned MaxLSLocationBBMultiplicationNone = 256*256;
 
-/// we could run optimistic DSE on functions with less than 64 basic blocks
-/// and 64 locations which is a sizeable function.
+/// we could run optimistic DSE on functions with less than 64 memory
+/// accessing basic blocks and 64 locations which is a sizeable function.
 constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 64*64;
 
 /// If a large store is broken down to too many smaller stores, bail out.
@@ -346,6 +349,10 @@ private:
   /// walked, i.e. when the we generate the genset and killset.
   llvm::DenseSet<SILBasicBlock *> BBWithStores;
 
+  /// The basic blocks which can have a non-empty genset or killset. All other
+  /// blocks are transparent to the data flow.
+  llvm::SmallPtrSet<SILBasicBlock *, 16> RelevantBBs;
+
   /// Contains a map between location to their index in the LocationVault.
   /// used to facilitate fast location to index lookup.
   LSLocationIndexMap LocToBitIndex;
@@ -526,7 +533,7 @@ DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount)
     return ProcessKind::ProcessNone;
 
   bool RunOneIteration = true;
-  unsigned BBCount = 0;
+  unsigned BBCount = RelevantBBs.size();
   unsigned LocationCount = LocationVault.size();
 
   // If all basic blocks will have their successors processed if
@@ -536,7 +543,6 @@ DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount)
   auto *PO = PM->getAnalysis<PostOrderAnalysis>()->get(F);
   llvm::DenseSet<SILBasicBlock *> HandledBBs;
   for (SILBasicBlock *B : PO->getPostOrder()) {
-    ++BBCount;
     for (auto &X : B->getSuccessors()) {
       if (HandledBBs.find(X) == HandledBBs.end()) {
         RunOneIteration = false;
@@ -576,6 +582,11 @@ void DSEContext::processBasicBlockForGenKillSet(SILBasicBlock *BB) {
     }
   }
 
+  // The genset and killset of a block which does not access memory are
+  // empty.
+  if (!RelevantBBs.count(BB))
+    return;
+
   // Compute the genset and killset. 
   //
   // Also compute the MaxStoreSet at the current position of the basic block.
@@ -1101,27 +1112,12 @@ void DSEContext::runIterativeDSE() {
 
   // Process each basic block with the gen and kill set. Every time the
   // BBWriteSetIn of a basic block changes, the optimization is rerun on its
-  // predecessors.
-  llvm::SmallVector<SILBasicBlock *, 16> WorkList;
-  llvm::DenseSet<SILBasicBlock *> HandledBBs;
-  // Push into reverse post order so that we can pop from the back and get
-  // post order.
-  for (SILBasicBlock *B : PO->getReversePostOrder()) {
-    WorkList.push_back(B);
-    HandledBBs.insert(B);
-  }
+  // predecessors. Pending blocks are always processed in post order.
+  LSDataFlowWorklist WorkList(PO, LSDataFlowDirection::Backward);
   while (!WorkList.empty()) {
-    SILBasicBlock *BB = WorkList.pop_back_val();
-    HandledBBs.erase(BB);
-    if (processBasicBlockWithGenKillSet(BB)) {
-      for (auto X : BB->getPreds()) {
-        // We do not push basic block into the worklist if its already 
-        // in the worklist.
-        if (HandledBBs.find(X) != HandledBBs.end())
-          continue;
-        WorkList.push_back(X);
-      }
-    }
+    SILBasicBlock *BB = WorkList.pop();
+    if (processBasicBlockWithGenKillSet(BB))
+      WorkList.pushDependents(BB);
   }
 }
 
@@ -1135,6 +1131,7 @@ bool DSEContext::run() {
   LSLocation::enumerateLSLocations(*F, LocationVault,
                                    LocToBitIndex,
                                    BaseToLocIndex, TE, LSCount);
+  LSLocation::collectRelevantBlocks(*F, LocationVault, RelevantBBs);
 
   // Check how to optimize this function.
   ProcessKind Kind = getProcessFunctionKind(LSCount.second);
@@ -17,15 +17,27 @@
 
 #define DEBUG_TYPE "sil-generic-specializer"
 
+#include "swift/AST/ASTContext.h"
+#include "swift/AST/DiagnosticEngine.h"
+#include "swift/AST/DiagnosticsSIL.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILOptimizer/Analysis/ProfileAnalysis.h"
 #include "swift/SILOptimizer/Utils/Generics.h"
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
 
 using namespace swift;
 
+/// The threshold (in 1/1000 of the maximum entry count) for a function to be
+/// considered hot in the unspecialized call report.
+static llvm::cl::opt<unsigned>
+ReportHotPerMille("sil-unspecialized-call-report-hot-permille",
+                  llvm::cl::init(10), llvm::cl::Hidden);
+
 namespace {
 
 class GenericSpecializer : public SILFunctionTransform {
@@ -93,6 +105,86 @@ bool GenericSpecializer::specializeAppliesInFunction(SILFunction &F) {
   return Changed;
 }
 
+/// Returns a description why \p Apply, which has substitutions, is (still) not
+/// specialized.
+static StringRef getUnspecializedReason(ApplySite Apply) {
+  auto *Callee = Apply.getReferencedFunction();
+  if (!Callee)
+    return "callee is not statically known";
+  if (!Callee->isDefinition())
+    return "body of callee is not available";
+  if (!Callee->shouldOptimize())
+    return "callee is excluded from optimization";
+  // Some substitutions are still archetypes of the caller.
+  // FIXME: Partial specialization could still bind the concrete ones.
+  if (hasUnboundGenericTypes(Apply.getSubstitutions()))
+    return "substitutions are not fully concrete";
+  if (hasDynamicSelfTypes(Apply.getSubstitutions()))
+    return "substitutions contain dynamic Self";
+  return "specialization not possible";
+}
+
+namespace {
+
+/// Reports the generic calls which remain unspecialized, together with the
+/// reason why they could not be specialized.
+///
+/// The generic specializer runs several times in the pipeline, so this is a
+/// separate pass which runs once after all optimizations. It emits a single
+/// warning per function, with a note for each call. If a profile is available
+/// (see -profile-use), only hot functions are reported.
+class UnspecializedCallReporter : public SILModuleTransform {
+
+  void reportFunction(SILFunction &F);
+
+  void run() override {
+    auto *PA = PM->getAnalysis<ProfileAnalysis>();
+    for (auto &F : *getModule()) {
+      if (!F.isDefinition())
+        continue;
+      if (PA->hasProfile() && !PA->isHot(&F, ReportHotPerMille))
+        continue;
+      reportFunction(F);
+    }
+  }
+
+  StringRef getName() override { return "Unspecialized Call Reporter"; }
+};
+
+} // end anonymous namespace
+
+void UnspecializedCallReporter::reportFunction(SILFunction &F) {
+  llvm::SmallVector<ApplySite, 8> Applies;
+  for (auto &BB : F) {
+    for (auto &I : BB) {
+      ApplySite Apply = ApplySite::isa(&I);
+      if (Apply && Apply.hasSubstitutions())
+        Applies.push_back(Apply);
+    }
+  }
+  if (Applies.empty())
+    return;
+
+  auto &Diags = F.getModule().getASTContext().Diags;
+  SourceLoc Loc = F.hasLocation() ? F.getLocation().getSourceLoc()
+                                  : SourceLoc();
+  if (Loc.isInvalid())
+    Loc = Applies.front().getLoc().getSourceLoc();
+  Diags.diagnose(Loc, diag::generic_calls_not_specialized, F.getName(),
+                 unsigned(Applies.size()));
+  for (ApplySite Apply : Applies) {
+    auto *Callee = Apply.getReferencedFunction();
+    Diags.diagnose(Apply.getLoc().getSourceLoc(),
+                   diag::generic_call_not_specialized,
+                   Callee ? Callee->getName() : StringRef("<unknown callee>"),
+                   getUnspecializedReason(Apply));
+  }
+}
+
 SILTransform *swift::createGenericSpecializer() {
   return new GenericSpecializer();
 }
+
+SILTransform *swift::createUnspecializedCallReporter() {
+  return new UnspecializedCallReporter();
+}
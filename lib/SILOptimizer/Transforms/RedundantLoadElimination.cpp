@@ -173,12 +173,15 @@ namespace {
 /// behavior or alias query we need to do in worst case is roughly linear to
 /// # of BBs x(times) # of locations.
 ///
-/// we could run RLE on functions with 128 basic blocks and 128 locations,
-/// which is a large function.  
+/// Only basic blocks which access memory are counted, as all other blocks are
+/// transparent to the data flow and are never scanned.
+///
+/// we could run RLE on functions with 128 memory accessing basic blocks and
+/// 128 locations, which is a large function.
 constexpr unsigned MaxLSLocationBBMultiplicationNone = 128*128;
 
-/// we could run optimistic RLE on functions with less than 64 basic blocks
-/// and 64 locations which is a sizeable function.
+/// we could run optimistic RLE on functions with less than 64 memory
+/// accessing basic blocks and 64 locations which is a sizeable function.
 constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 64*64;
 
 /// forward declaration.
@@ -473,6 +476,10 @@ private:
   /// walked, i.e. when the we generate the genset and killset.
   llvm::DenseSet<SILBasicBlock *> BBWithLoads;
 
+  /// The basic blocks which can have a non-empty genset or killset. All other
+  /// blocks are transparent to the data flow.
+  llvm::SmallPtrSet<SILBasicBlock *, 16> RelevantBBs;
+
 public:
   RLEContext(SILFunction *F, SILPassManager *PM, AliasAnalysis *AA,
              TypeExpansionAnalysis *TE, PostOrderFunctionInfo *PO);
@@ -1074,7 +1081,7 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
     return ProcessKind::ProcessNone;
 
   bool RunOneIteration = true;
-  unsigned BBCount = 0;
+  unsigned BBCount = RelevantBBs.size();
   unsigned LocationCount = LocationVault.size();
 
   if (LocationCount == 0) 
@@ -1087,7 +1094,6 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
   auto *PO = PM->getAnalysis<PostOrderAnalysis>()->get(Fn);
   llvm::DenseSet<SILBasicBlock *> HandledBBs;
   for (SILBasicBlock *B : PO->getReversePostOrder()) {
-    ++BBCount;
     for (auto X : B->getPreds()) {
       if (HandledBBs.find(X) == HandledBBs.end()) {
         RunOneIteration = false;
@@ -1302,6 +1308,11 @@ void RLEContext::processBasicBlocksForGenKillSet() {
     // Compute the AvailSetMax at the beginning of the basic block.
     S.mergePredecessorsAvailSetMax(*this);
 
+    // The genset and killset of a block which does not access memory are
+    // empty.
+    if (!RelevantBBs.count(BB))
+      continue;
+
     // Compute the genset and killset. 
     // 
     // To optimize this process, we also compute the AvailSetMax at particular
@@ -1324,34 +1335,18 @@ void RLEContext::processBasicBlocksForGenKillSet() {
 void RLEContext::processBasicBlocksWithGenKillSet() {
   // Process each basic block with the gen and kill set. Every time the
   // ForwardSetOut of a basic block changes, the optimization is rerun on its
-  // successors.
-  llvm::SmallVector<SILBasicBlock *, 16> WorkList;
-  llvm::DenseSet<SILBasicBlock *> HandledBBs;
-
-  // Push into the worklist in post order so that we can pop from the back and
-  // get reverse post order.
-  for (SILBasicBlock *BB : PO->getPostOrder()) {
-    WorkList.push_back(BB);
-    HandledBBs.insert(BB);
-  }
+  // successors. Pending blocks are always processed in reverse post order.
+  LSDataFlowWorklist WorkList(PO, LSDataFlowDirection::Forward);
   while (!WorkList.empty()) {
-    SILBasicBlock *BB = WorkList.pop_back_val();
-    HandledBBs.erase(BB);
+    SILBasicBlock *BB = WorkList.pop();
 
     // Intersection.
     BlockState &Forwarder = getBlockState(BB);
     // Compute the ForwardSetIn at the beginning of the basic block.
     Forwarder.mergePredecessorAvailSet(*this);
 
-    if (Forwarder.processBasicBlockWithGenKillSet()) {
-      for (auto &X : BB->getSuccessors()) {
-        // We do not push basic block into the worklist if its already
-        // in the worklist.
-        if (HandledBBs.find(X) != HandledBBs.end())
-          continue;
-        WorkList.push_back(X);
-      }
-    }
+    if (Forwarder.processBasicBlockWithGenKillSet())
+      WorkList.pushDependents(BB);
   }
 }
 
@@ -1442,6 +1437,7 @@ bool RLEContext::run() {
                                    LocToBitIndex,
                                    BaseToLocIndex, TE,
                                    LSCount);
+  LSLocation::collectRelevantBlocks(*Fn, LocationVault, RelevantBBs);
 
   // Check how to optimize this function.
   ProcessKind Kind = getProcessFunctionKind(LSCount.first, LSCount.second);
@@ -28,6 +28,9 @@ using namespace swift;
 /// *) alloc_ref instructions of native swift classes: if promoted, the [stack]
 ///    attribute is set in the alloc_ref and a dealloc_ref [stack] is inserted
 ///    at the end of the object's lifetime.
+/// *) partial_apply instructions which capture arguments: if promoted, the
+///    [stack] attribute is set in the partial_apply and a dealloc_ref [stack]
+///    of the closure is inserted at the end of the context's lifetime.
 /// *) Array buffers which are allocated by a call to swift_bufferAllocate: if
 ///    promoted the swift_bufferAllocate call is replaced by a call to
 ///    swift_bufferAllocateOnStack and a call to swift_bufferDeallocateFromStack
@@ -51,6 +54,9 @@ class StackPromoter {
   PostDominanceInfo *PDT;
   EscapeAnalysis *EA;
 
+  /// True if closure contexts of partial_apply instructions are promoted.
+  bool PromoteClosures;
+
   // Pseudo-functions for (de-)allocating array buffers on the stack.
 
   SILFunction *BufferAllocFunc = nullptr;
@@ -142,8 +148,9 @@ public:
 
   StackPromoter(SILFunction *F, EscapeAnalysis::ConnectionGraph *ConGraph,
                 DominanceInfo *DT, PostDominanceInfo *PDT,
-                EscapeAnalysis *EA) :
-    F(F), ConGraph(ConGraph), DT(DT), PDT(PDT), EA(EA) { }
+                EscapeAnalysis *EA, bool PromoteClosures) :
+    F(F), ConGraph(ConGraph), DT(DT), PDT(PDT), EA(EA),
+    PromoteClosures(PromoteClosures) { }
 
   /// What did the optimization change?
   enum class ChangeState {
@@ -157,13 +164,17 @@ public:
 };
 
 /// Returns true if instruction \p I is an allocation we can handle.
-static bool isPromotableAllocInst(SILInstruction *I) {
+static bool isPromotableAllocInst(SILInstruction *I, bool PromoteClosures) {
   // Check for swift object allocation.
   if (auto *ARI = dyn_cast<AllocRefInst>(I)) {
     if (!ARI->isObjC())
       return true;
     return false;
   }
+  // Check for closure context allocation. A partial_apply without arguments
+  // does not allocate a context.
+  if (auto *PAI = dyn_cast<PartialApplyInst>(I))
+    return PromoteClosures && PAI->getNumArguments() != 0;
   // Check for array buffer allocation.
   auto *AI = dyn_cast<ApplyInst>(I);
   if (AI && AI->getNumArguments() == 3) {
@@ -183,7 +194,7 @@ StackPromoter::ChangeState StackPromoter::promote() {
       // The allocation instruction may be moved, so increment Iter prior to
       // doing the optimization.
       SILInstruction *I = &*Iter++;
-      if (isPromotableAllocInst(I)) {
+      if (isPromotableAllocInst(I, PromoteClosures)) {
         tryPromoteAlloc(I);
       }
     }
@@ -217,6 +228,16 @@ void StackPromoter::tryPromoteAlloc(SILInstruction *I) {
     ChangedInsts = true;
     return;
   }
+  if (auto *PAI = dyn_cast<PartialApplyInst>(I)) {
+    assert(!AllocInsertionPoint && "can't move partial_apply");
+    // It's a closure context allocation. We set the [stack] attribute in the
+    // partial_apply and create a dealloc_ref [stack] at the end of the
+    // context's lifetime.
+    PAI->setStackAllocatable();
+    B.createDeallocRef(I->getLoc(), I, true);
+    ChangedInsts = true;
+    return;
+  }
   if (auto *AI = dyn_cast<ApplyInst>(I)) {
     assert(!AllocInsertionPoint && "can't move call to swift_bufferAlloc");
     // It's an array buffer allocation.
@@ -456,8 +477,13 @@ namespace {
 
 class StackPromotion : public SILFunctionTransform {
 
+  /// Closures are only promoted in the late run, after the closure
+  /// optimizations which can't handle stack allocated closures, like the
+  /// inliner and the ClosureSpecializer, are done.
+  bool PromoteClosures;
+
 public:
-  StackPromotion() {}
+  StackPromotion(bool PromoteClosures) : PromoteClosures(PromoteClosures) {}
 
 private:
   /// The entry point to the transformation.
@@ -470,7 +496,8 @@ private:
 
     SILFunction *F = getFunction();
     if (auto *ConGraph = EA->getConnectionGraph(F)) {
-      StackPromoter promoter(F, ConGraph, DA->get(F), PDA->get(F), EA);
+      StackPromoter promoter(F, ConGraph, DA->get(F), PDA->get(F), EA,
+                             PromoteClosures);
       switch (promoter.promote()) {
         case StackPromoter::ChangeState::None:
           break;
@@ -490,6 +517,12 @@ private:
 
 } // end anonymous namespace
 
+/// Stack promotion which leaves closure contexts on the heap.
+SILTransform *swift::createEarlyStackPromotion() {
+  return new StackPromotion(false);
+}
+
+/// Stack promotion of all supported allocations, including closure contexts.
 SILTransform *swift::createStackPromotion() {
-  return new StackPromotion();
+  return new StackPromotion(true);
 }
@@ -794,7 +794,8 @@ static ApplySite devirtualizeWitnessMethod(ApplySite AI, SILFunction *F,
                                  TAI->getNormalBB(), TAI->getErrorBB());
   if (auto *PAI = dyn_cast<PartialApplyInst>(AI))
     SAI = Builder.createPartialApply(Loc, FRI, SubstCalleeSILType,
-                                     NewSubs, Arguments, PAI->getType());
+                                     NewSubs, Arguments, PAI->getType(),
+                                     PAI->canAllocOnStack());
 
   NumWitnessDevirt++;
   return SAI;
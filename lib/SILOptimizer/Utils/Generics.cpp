@@ -194,7 +194,8 @@ static ApplySite replaceWithSpecializedCallee(ApplySite AI,
     SILType PTy = SILType::getPrimitiveObjectType(ReInfo.getSpecializedType());
     auto *NewPAI =
       Builder.createPartialApply(Loc, Callee, PTy, {}, Arguments,
-                                 SILType::getPrimitiveObjectType(NewPAType));
+                                 SILType::getPrimitiveObjectType(NewPAType),
+                                 PAI->canAllocOnStack());
     PAI->replaceAllUsesWith(NewPAI);
     return NewPAI;
   }
@@ -571,7 +572,8 @@ void swift::trySpecializeApplyOfGeneric(ApplySite Apply,
                                       PAI->getSubstCalleeSILType(),
                                       {},
                                       Arguments,
-                                      PAI->getType());
+                                      PAI->getType(),
+                                      PAI->canAllocOnStack());
     PAI->replaceAllUsesWith(NewPAI);
     return;
   }
@@ -262,3 +262,51 @@ LSLocation::enumerateLSLocations(SILFunction &F,
     }
   }
 }
+
+void LSLocation::collectRelevantBlocks(
+    SILFunction &F, const std::vector<LSLocation> &Locations,
+    llvm::SmallPtrSetImpl<SILBasicBlock *> &Blocks) {
+  // Blocks which define the base of a location invalidate the location.
+  for (auto &L : Locations) {
+    if (auto *I = dyn_cast<SILInstruction>(L.getBase()))
+      Blocks.insert(I->getParent());
+  }
+
+  for (auto &B : F) {
+    if (Blocks.count(&B))
+      continue;
+    for (auto &I : B) {
+      if (I.mayReadOrWriteMemory() || isa<DeallocStackInst>(&I) ||
+          isa<DebugValueAddrInst>(&I)) {
+        Blocks.insert(&B);
+        break;
+      }
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+//                         Load Store Data Flow Worklist
+//===----------------------------------------------------------------------===//
+SILBasicBlock *LSDataFlowWorklist::pop() {
+  int Index = Pending.find_first();
+  assert(Index >= 0 && "popping from an empty worklist");
+  Pending.reset(Index);
+  if (Direction == LSDataFlowDirection::Forward)
+    return *std::next(PO->getReversePostOrder().begin(), Index);
+  return *std::next(PO->getPostOrder().begin(), Index);
+}
+
+void LSDataFlowWorklist::pushDependents(SILBasicBlock *BB) {
+  auto push = [this](SILBasicBlock *Dependent) {
+    if (auto Index = getIndex(Dependent))
+      Pending.set(Index.getValue());
+  };
+  if (Direction == LSDataFlowDirection::Forward) {
+    for (auto &Succ : BB->getSuccessors())
+      push(Succ);
+    return;
+  }
+  for (auto *Pred : BB->getPreds())
+    push(Pred);
+}
@@ -942,6 +942,9 @@ static bool useDoesNotKeepClosureAlive(const SILInstruction *I) {
   case ValueKind::ReleaseValueInst:
   case ValueKind::DebugValueInst:
     return true;
+  // The end of a stack allocated closure context is deleted with the closure.
+  case ValueKind::DeallocRefInst:
+    return cast<DeallocRefInst>(I)->canAllocOnStack();
   default:
     return false;
   }
@@ -446,6 +446,26 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
     fn->setDebugScope(DS);
   }
 
+  // The function record may be followed by a side-effect summary.
+  {
+    BCOffsetRAII restoreEffectsOffset(SILCursor);
+    entry = SILCursor.advance(AF_DontPopBlockAtEnd);
+    if (entry.Kind == llvm::BitstreamEntry::Record) {
+      scratch.clear();
+      kind = SILCursor.readRecord(entry.ID, scratch);
+      if (kind == SIL_FUNCTION_EFFECTS) {
+        ArrayRef<uint64_t> rawSummary;
+        SILFunctionEffectsLayout::readRecord(scratch, rawSummary);
+        if (!fn->hasEffectsSummary()) {
+          SmallVector<uint8_t, 8> summary(rawSummary.begin(),
+                                          rawSummary.end());
+          fn->setEffectsSummary(summary);
+        }
+        restoreEffectsOffset.reset();
+      }
+    }
+  }
+
   GenericParamList *contextParams = nullptr;
   if (!declarationOnly) {
     // We need to construct a linked list of GenericParamList. The outermost
@@ -617,7 +637,8 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
   SILBuilder Builder(BB);
   Builder.setCurrentDebugScope(Fn->getDebugScope());
   unsigned OpCode = 0, TyCategory = 0, TyCategory2 = 0, TyCategory3 = 0,
-           Attr = 0, NumSubs = 0, NumConformances = 0, IsNonThrowingApply = 0;
+           Attr = 0, NumSubs = 0, NumConformances = 0, IsNonThrowingApply = 0,
+           IsOnStackPartialApply = 0;
   ValueID ValID, ValID2, ValID3;
   TypeID TyID, TyID2, TyID3;
   TypeID ConcreteTyID;
@@ -691,6 +712,10 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
       OpCode = (unsigned)ValueKind::ApplyInst;
       IsNonThrowingApply = true;
       break;
+    case SIL_STACK_PARTIAL_APPLY:
+      OpCode = (unsigned)ValueKind::PartialApplyInst;
+      IsOnStackPartialApply = true;
+      break;
         
     default:
       llvm_unreachable("unexpected apply inst kind");
@@ -986,7 +1011,8 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
     // FIXME: Why the arbitrary order difference in IRBuilder type argument?
     ResultVal = Builder.createPartialApply(Loc, FnVal, SubstFnTy,
                                            Substitutions, Args,
-                                           closureTy);
+                                           closureTy,
+                                           IsOnStackPartialApply != 0);
     break;
   }
   case ValueKind::BuiltinInst: {
@@ -138,6 +138,7 @@ namespace sil_block {
     SIL_WITNESS_ASSOC_ENTRY,
     SIL_GENERIC_OUTER_PARAMS,
     SIL_INST_WITNESS_METHOD,
+    SIL_FUNCTION_EFFECTS,
 
     // We also share these layouts from the decls block. Their enumerators must
     // not overlap with ours.
@@ -299,7 +300,8 @@ namespace sil_block {
     SIL_PARTIAL_APPLY,
     SIL_BUILTIN,
     SIL_TRY_APPLY,
-    SIL_NON_THROWING_APPLY
+    SIL_NON_THROWING_APPLY,
+    SIL_STACK_PARTIAL_APPLY
   };
   
   using SILInstApplyLayout = BCRecordLayout<
@@ -361,6 +363,13 @@ namespace sil_block {
     BCArray<ValueIDField>  // SILDeclRef
     // may be trailed by an inline protocol conformance
   >;
+
+  /// The side-effect summary of a function. Immediately follows the function's
+  /// SIL_FUNCTION record. The encoding is defined by SideEffectAnalysis.
+  using SILFunctionEffectsLayout = BCRecordLayout<
+    SIL_FUNCTION_EFFECTS,
+    BCArray<BCFixed<8>>
+  >;
 }
 
 } // end namespace serialization
@@ -272,6 +272,12 @@ void SILSerializer::writeSILFunction(const SILFunction &F, bool DeclOnly) {
       (unsigned)F.getInlineStrategy(), (unsigned)F.getEffectsKind(), FnID,
       SemanticsIDs);
 
+  if (F.hasEffectsSummary()) {
+    SILFunctionEffectsLayout::emitRecord(
+        Out, ScratchRecord, SILAbbrCodes[SILFunctionEffectsLayout::Code],
+        F.getEffectsSummary());
+  }
+
   if (NoBody)
     return;
 
@@ -664,12 +670,13 @@ void SILSerializer::writeSILInstruction(const SILInstruction &SI) {
   }
   case ValueKind::PartialApplyInst: {
     const PartialApplyInst *PAI = cast<PartialApplyInst>(&SI);
-        SmallVector<ValueID, 4> Args;
+    SmallVector<ValueID, 4> Args;
     for (auto Arg: PAI->getArguments()) {
       Args.push_back(addValueRef(Arg));
     }
     SILInstApplyLayout::emitRecord(Out, ScratchRecord,
-        SILAbbrCodes[SILInstApplyLayout::Code], SIL_PARTIAL_APPLY,
+        SILAbbrCodes[SILInstApplyLayout::Code],
+        PAI->canAllocOnStack() ? SIL_STACK_PARTIAL_APPLY : SIL_PARTIAL_APPLY,
         PAI->getSubstitutions().size(),
         S.addTypeRef(PAI->getCallee()->getType().getSwiftRValueType()),
         S.addTypeRef(PAI->getSubstCalleeType()),
@@ -1645,6 +1652,7 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
 
   registerSILAbbr<SILInstCastLayout>();
   registerSILAbbr<SILInstWitnessMethodLayout>();
+  registerSILAbbr<SILFunctionEffectsLayout>();
 
   // Register the abbreviation codes so these layouts can exist in both
   // decl blocks and sil blocks.
@@ -1712,8 +1720,13 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
 
   // Now write function declarations for every function we've
   // emitted a reference to without emitting a function body for.
+  // Public functions with a side-effect summary are also declared, so that
+  // clients can pick up the summary.
   for (const SILFunction &F : *SILMod) {
-    if (!shouldEmitFunctionBody(F) && FuncsToDeclare.count(&F))
+    if (shouldEmitFunctionBody(F))
+      continue;
+    if (FuncsToDeclare.count(&F) ||
+        (F.hasEffectsSummary() && hasPublicVisibility(F.getLinkage())))
       writeSILFunction(F, true);
   }
 }
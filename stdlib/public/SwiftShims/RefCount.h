@@ -274,8 +274,9 @@ class WeakRefCount {
   uint32_t refCount;
 
   enum : uint32_t {
-    // There isn't really a flag here.
-    RC_UNUSED_FLAG = 1,
+    // The object has a side table entry, which is referenced by the object's
+    // weak references. See HeapObject.cpp.
+    RC_SIDE_TABLE_FLAG = 1,
 
     RC_FLAGS_COUNT = 1,
     RC_FLAGS_MASK = 1,
@@ -352,6 +353,16 @@ class WeakRefCount {
   uint32_t getCount() const {
     return __atomic_load_n(&refCount, __ATOMIC_RELAXED) >> RC_FLAGS_COUNT;
   }
+
+  // Mark the object as having a side table entry.
+  void setHasSideTable() {
+    __atomic_fetch_or(&refCount, RC_SIDE_TABLE_FLAG, __ATOMIC_RELAXED);
+  }
+
+  // Return true if a side table entry was allocated for the object.
+  bool hasSideTable() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_SIDE_TABLE_FLAG;
+  }
 };
 
 static_assert(swift::IsTriviallyConstructible<StrongRefCount>::value,
@@ -28,9 +28,12 @@
 #include "ErrorObject.h"
 #include "ExistentialMetadataImpl.h"
 #include "Private.h"
+#include "StatisticsImpl.h"
 #include "../SwiftShims/RuntimeShims.h"
 #include "stddef.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <mutex>
 #include <type_traits>
@@ -529,6 +532,35 @@ swift::swift_dynamicCastClassUnconditional(const void *object,
   swift_dynamicCastFailure(_swift_getClass(object), targetType);
 }
 
+void swift::swift_dynamicCastFillInlineCache(
+                                     DynamicCastInlineCacheEntry **cache,
+                                     const Metadata *type,
+                                     const WitnessTable * const *witnessTables,
+                                     size_t numWitnessTables) {
+  incrementRuntimeStatistic(RuntimeStatistic::DynamicCastInlineCacheMisses);
+
+  auto &slot =
+    *reinterpret_cast<std::atomic<DynamicCastInlineCacheEntry *> *>(cache);
+
+  // The cache site already saw another type.
+  if (slot.load(std::memory_order_relaxed))
+    return;
+
+  auto entry = reinterpret_cast<DynamicCastInlineCacheEntry *>(
+    malloc(sizeof(DynamicCastInlineCacheEntry) +
+           numWitnessTables * sizeof(const WitnessTable *)));
+  entry->Type = type;
+  std::copy(witnessTables, witnessTables + numWitnessTables,
+            entry->getWitnessTables());
+
+  // Another thread may have filled the cache in the meantime.
+  DynamicCastInlineCacheEntry *expected = nullptr;
+  if (!slot.compare_exchange_strong(expected, entry,
+                                    std::memory_order_release,
+                                    std::memory_order_relaxed))
+    free(entry);
+}
+
 #if SWIFT_OBJC_INTEROP
 static bool _unknownClassConformsToObjCProtocol(const OpaqueValue *value,
                                           const ProtocolDescriptor *protocol) {
@@ -2053,6 +2085,8 @@ bool swift::swift_dynamicCast(OpaqueValue *dest,
                               const Metadata *targetType,
                               DynamicCastFlags flags)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  incrementRuntimeStatistic(RuntimeStatistic::DynamicCasts);
+
   auto unwrapResult = checkDynamicCastFromOptional(dest, src, srcType,
                                                    targetType, flags);
   srcType = unwrapResult.payloadType;
@@ -254,6 +254,57 @@ swift::swift_storeEnumTagSinglePayload(OpaqueValue *value,
   memcpy(extraTagBitAddr, &extraTagIndex, numExtraTagBytes);
 }
 
+namespace {
+/// The layout of the tag of a multi-payload enum.
+///
+/// swift_initEnumMetadataMultiPayload precomputes this layout and caches it in
+/// the high byte of the payload size word of the metadata, so that the case
+/// accessors don't need to derive it from the value witness table each time.
+/// Metadata whose payload size word has no cached layout (e.g. metadata which
+/// was statically emitted by the compiler) falls back to computing it.
+struct MultiPayloadLayout {
+  size_t payloadSize;
+  size_t numTagBytes;
+
+  /// True if the tag and the payload part of the case index can be accessed
+  /// with 32-bit word loads and stores, which don't reach beyond the value.
+  bool useWordAccess;
+
+  /// The number of bits of the payload area which hold the index of an empty
+  /// case.
+  unsigned getNumPayloadValueBits() const {
+    return std::min(payloadSize, sizeof(uint32_t)) * CHAR_BIT;
+  }
+};
+
+/// The cached layout is stored in the high byte of the payload size word.
+/// Payload sizes which don't fit into the remaining bits are never cached.
+constexpr unsigned CachedLayoutShift = sizeof(size_t) * CHAR_BIT - 8;
+constexpr size_t CachedLayoutIsValid = size_t(0x80) << CachedLayoutShift;
+constexpr size_t CachedLayoutNumTagBytesMask
+  = size_t(0x07) << CachedLayoutShift;
+constexpr size_t CachedLayoutPayloadSizeMask
+  = (size_t(1) << CachedLayoutShift) - 1;
+}
+
+/// Returns the cached payload size word for the given layout, or just the
+/// payload size if the layout is not eligible for word-sized tag access.
+static size_t getCachedMultiPayloadLayout(size_t payloadSize,
+                                          size_t numTagBytes) {
+  // Word access loads the 32-bit word which ends at the end of the tag bytes,
+  // so the value must be at least that big. Like the byte-wise accessors, the
+  // tag and payload value are stored in host byte order, which is only
+  // equivalent to a word access on little-endian hosts.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (numTagBytes > 0 &&
+      payloadSize + numTagBytes >= sizeof(uint32_t) &&
+      payloadSize <= CachedLayoutPayloadSizeMask)
+    return payloadSize | CachedLayoutIsValid
+      | (numTagBytes << CachedLayoutShift);
+#endif
+  return payloadSize;
+}
+
 void
 swift::swift_initEnumMetadataMultiPayload(ValueWitnessTable *vwtable,
                                      EnumMetadata *enumType,
@@ -271,13 +322,16 @@ swift::swift_initEnumMetadataMultiPayload(ValueWitnessTable *vwtable,
     isBT &= payloadLayout->flags.isBitwiseTakable();
   }
   
-  // Store the max payload size in the metadata.
-  enumType->getPayloadSize() = payloadSize;
-  
-  // The total size includes space for the tag.
-  unsigned totalSize = payloadSize + getNumTagBytes(payloadSize,
+  unsigned numTagBytes = getNumTagBytes(payloadSize,
                                 enumType->Description->Enum.getNumEmptyCases(),
                                 numPayloads);
+
+  // Store the max payload size in the metadata, together with the tag layout.
+  enumType->getPayloadSize() = getCachedMultiPayloadLayout(payloadSize,
+                                                           numTagBytes);
+  
+  // The total size includes space for the tag.
+  unsigned totalSize = payloadSize + numTagBytes;
   
   // Set up the layout info in the vwtable.
   vwtable->size = totalSize;
@@ -295,22 +349,64 @@ swift::swift_initEnumMetadataMultiPayload(ValueWitnessTable *vwtable,
   installCommonValueWitnesses(vwtable);
 }
 
-namespace {
-struct MultiPayloadLayout {
-  size_t payloadSize;
-  size_t numTagBytes;
-};
-}
-
 static MultiPayloadLayout getMultiPayloadLayout(const EnumMetadata *enumType) {
-  size_t payloadSize = enumType->getPayloadSize();
+  size_t payloadSizeWord = enumType->getPayloadSize();
+  if (payloadSizeWord & CachedLayoutIsValid)
+    return {payloadSizeWord & CachedLayoutPayloadSizeMask,
+            (payloadSizeWord & CachedLayoutNumTagBytesMask)
+              >> CachedLayoutShift,
+            true};
+
   size_t totalSize = enumType->getValueWitnesses()->size;
-  return {payloadSize, totalSize - payloadSize};
+  return {payloadSizeWord, totalSize - payloadSizeWord, false};
+}
+
+static uint32_t loadWord(const char *addr) {
+  uint32_t word;
+  memcpy(&word, addr, sizeof(word));
+  return word;
+}
+
+static void storeWord(char *addr, uint32_t word) {
+  memcpy(addr, &word, sizeof(word));
+}
+
+/// The tag bytes are the high bytes of the word which ends at the end of the
+/// tag. Returns the shift amount of the tag within that word.
+static unsigned getTagShiftInLastWord(MultiPayloadLayout layout) {
+  return (sizeof(uint32_t) - layout.numTagBytes) * CHAR_BIT;
+}
+
+static char *getLastWord(OpaqueValue *value, MultiPayloadLayout layout) {
+  return reinterpret_cast<char *>(value) + layout.payloadSize
+    + layout.numTagBytes - sizeof(uint32_t);
+}
+
+static const char *getLastWord(const OpaqueValue *value,
+                               MultiPayloadLayout layout) {
+  return getLastWord(const_cast<OpaqueValue *>(value), layout);
+}
+
+/// The mask of the bits of the first word of the payload area which hold the
+/// index of an empty case.
+static uint32_t getPayloadValueMask(MultiPayloadLayout layout) {
+  return uint32_t((uint64_t(1) << layout.getNumPayloadValueBits()) - 1);
 }
 
 static void storeMultiPayloadTag(OpaqueValue *value,
                                  MultiPayloadLayout layout,
                                  unsigned tag) {
+  if (layout.useWordAccess) {
+    // Replace the high bytes of the last word, keeping the payload bytes
+    // which share the word with the tag.
+    char *lastWord = getLastWord(value, layout);
+    unsigned shift = getTagShiftInLastWord(layout);
+    uint32_t keepMask = ~(~uint32_t(0) << shift);
+    storeWord(lastWord,
+              (loadWord(lastWord) & keepMask) | (uint32_t(tag) << shift));
+    return;
+  }
+
   auto tagBytes = reinterpret_cast<char *>(value) + layout.payloadSize;
   small_memcpy(tagBytes, &tag, layout.numTagBytes);
 }
@@ -319,9 +415,16 @@ static void storeMultiPayloadValue(OpaqueValue *value,
                                    MultiPayloadLayout layout,
                                    unsigned payloadValue) {
   auto bytes = reinterpret_cast<char *>(value);
-  
-  memcpy(bytes, &payloadValue,
-         std::min(layout.payloadSize, sizeof(payloadValue)));
+
+  if (layout.useWordAccess) {
+    // If the payload is smaller than a word, the rest of the word is the tag,
+    // which is stored afterwards.
+    uint32_t mask = getPayloadValueMask(layout);
+    storeWord(bytes, (loadWord(bytes) & ~mask) | (payloadValue & mask));
+  } else {
+    memcpy(bytes, &payloadValue,
+           std::min(layout.payloadSize, sizeof(payloadValue)));
+  }
   
   // If the payload is larger than the value, zero out the rest.
   if (layout.payloadSize > sizeof(payloadValue))
@@ -331,6 +434,10 @@ static void storeMultiPayloadValue(OpaqueValue *value,
 
 static unsigned loadMultiPayloadTag(const OpaqueValue *value,
                                     MultiPayloadLayout layout) {
+  if (layout.useWordAccess)
+    return loadWord(getLastWord(value, layout))
+      >> getTagShiftInLastWord(layout);
+
   auto tagBytes = reinterpret_cast<const char *>(value) + layout.payloadSize;
 
   unsigned tag = 0;
@@ -342,6 +449,9 @@ static unsigned loadMultiPayloadTag(const OpaqueValue *value,
 static unsigned loadMultiPayloadValue(const OpaqueValue *value,
                                       MultiPayloadLayout layout) {
   auto bytes = reinterpret_cast<const char *>(value);
+  if (layout.useWordAccess)
+    return loadWord(bytes) & getPayloadValueMask(layout);
+
   unsigned payloadValue = 0;
   memcpy(&payloadValue, bytes,
          std::min(layout.payloadSize, sizeof(payloadValue)));
@@ -359,19 +469,16 @@ swift::swift_storeEnumTagMultiPayload(OpaqueValue *value,
     storeMultiPayloadTag(value, layout, whichCase);
   } else {
     // For an empty case, factor out the parts that go in the payload and
-    // tag areas.
+    // tag areas. If the payload area holds at least 32 bits, the empty case
+    // index fits completely into it; the shift is done in 64 bits so that
+    // this doesn't need a separate path.
     unsigned whichEmptyCase = whichCase - numPayloads;
-    unsigned whichTag, whichPayloadValue;
-    if (layout.payloadSize >= 4) {
-      whichTag = numPayloads;
-      whichPayloadValue = whichEmptyCase;
-    } else {
-      unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
-      whichTag = numPayloads + (whichEmptyCase >> numPayloadBits);
-      whichPayloadValue = whichEmptyCase & ((1U << numPayloads) - 1U);
-    }
-    storeMultiPayloadTag(value, layout, whichTag);
+    unsigned numPayloadBits = layout.getNumPayloadValueBits();
+    unsigned whichTag
+      = numPayloads + (uint64_t(whichEmptyCase) >> numPayloadBits);
+    unsigned whichPayloadValue = whichEmptyCase & getPayloadValueMask(layout);
     storeMultiPayloadValue(value, layout, whichPayloadValue);
+    storeMultiPayloadTag(value, layout, whichTag);
   }
 }
 
@@ -386,15 +493,12 @@ swift::swift_getEnumCaseMultiPayload(const OpaqueValue *value,
     // If the tag indicates a payload, then we're done.
     return tag;
   } else {
-    // Otherwise, the other part of the discriminator is in the payload.
+    // Otherwise, the other part of the discriminator is in the payload. If the
+    // payload area holds at least 32 bits, the tag is always numPayloads and
+    // the 64-bit shift yields zero.
     unsigned payloadValue = loadMultiPayloadValue(value, layout);
-    
-    if (layout.payloadSize >= 4) {
-      return numPayloads + payloadValue;
-    } else {
-      unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
-      return (payloadValue | (tag - numPayloads) << numPayloadBits)
-             + numPayloads;
-    }
+    unsigned numPayloadBits = layout.getNumPayloadValueBits();
+    return (payloadValue | (uint64_t(tag - numPayloads) << numPayloadBits))
+           + numPayloads;
   }
 }
@@ -19,15 +19,20 @@
 #include "swift/Runtime/Heap.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/ABI/System.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/MathExtras.h"
 #include "MetadataCache.h"
 #include "Private.h"
+#include "StatisticsImpl.h"
 #include "swift/Runtime/Debug.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 #include "../SwiftShims/RuntimeShims.h"
 #if SWIFT_OBJC_INTEROP
@@ -60,6 +65,8 @@ SWIFT_RT_ENTRY_IMPL(swift_allocObject)(HeapMetadata const *metadata,
                                        size_t requiredAlignmentMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
   assert(isAlignmentMask(requiredAlignmentMask));
+  incrementRuntimeStatistic(RuntimeStatistic::ObjectAllocations);
+
   auto object = reinterpret_cast<HeapObject *>(
       SWIFT_RT_ENTRY_CALL(swift_slowAlloc)(requiredSize,
                                            requiredAlignmentMask));
@@ -236,6 +243,8 @@ swift::swift_allocBox(const Metadata *type) {
 SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 BoxPair::Return SWIFT_RT_ENTRY_IMPL(swift_allocBox)(const Metadata *type) {
+  incrementRuntimeStatistic(RuntimeStatistic::BoxAllocations);
+
   // Get the heap metadata for the box.
   auto &B = Boxes.get();
   const void *typeArg = type;
@@ -603,6 +612,8 @@ static inline void memset_pattern8(void *b, const void *pattern8, size_t len) {
 }
 #endif
 
+static void detachSideTable(HeapObject *object);
+
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_deallocObject(HeapObject *object,
                                 size_t allocatedSize,
@@ -619,6 +630,10 @@ void swift::swift_deallocObject(HeapObject *object,
   // If we are tracking leaks, stop tracking this object.
   SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
 
+  // Weak references can't reach the object anymore once its memory is freed.
+  if (object->weakRefCount.hasSideTable())
+    detachSideTable(object);
+
   // Drop the initial weak retain of the object.
   //
   // If the outstanding weak retain count is 1 (i.e. only the initial
@@ -693,27 +708,178 @@ void swift::swift_deallocObject(HeapObject *object,
   }
 }
 
+/*****************************************************************************/
+/****************************** WEAK REFERENCES ******************************/
+/*****************************************************************************/
+
+// Weak references don't point to the object itself, but to a side table entry
+// which is allocated when the first weak reference to the object is formed.
+// The entry is reference counted by the weak references and by the object.
+// This lets swift_deallocObject free the object as soon as the strong and
+// unowned reference counts drop to zero, instead of keeping the object's
+// memory alive until all weak references are gone.
+//
+// Weak loads only access the entry and don't take any locks. A lock is only
+// taken when forming a weak reference and when deallocating an object which
+// has a side table. The map from objects to entries is split into shards by
+// object address, each with its own lock, so that threads which form weak
+// references to different objects rarely contend.
+
+namespace {
+
+class HeapObjectSideTableEntry {
+  /// The object, or null once the object is deallocated.
+  std::atomic<HeapObject *> Object;
+
+  /// The number of weak references to the entry, plus one for the object
+  /// until it is deallocated.
+  std::atomic<uint32_t> RefCount;
+
+  /// The number of weak loads which are currently trying to retain Object.
+  /// The object's memory must not be freed while this is nonzero.
+  std::atomic<uint32_t> ActiveLoads;
+
+public:
+  explicit HeapObjectSideTableEntry(HeapObject *object)
+    : Object(object), RefCount(1), ActiveLoads(0) {}
+
+  void retain() {
+    RefCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void release() {
+    if (RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
+
+  /// Returns false if the object was already deallocated. This is only a
+  /// hint, the object may be deallocated concurrently.
+  bool isObjectAlive() const {
+    return Object.load(std::memory_order_relaxed) != nullptr;
+  }
+
+  /// Retains and returns the object, or returns null if the object is
+  /// deallocating.
+  HeapObject *tryRetainObject() {
+    // Announce the access before loading the object pointer, so that
+    // detachObject either sees the access and waits for it, or we see the
+    // cleared pointer. This needs sequentially consistent ordering on both
+    // sides.
+    ActiveLoads.fetch_add(1, std::memory_order_seq_cst);
+    HeapObject *object = Object.load(std::memory_order_seq_cst);
+    if (object && !object->refCount.tryIncrement())
+      object = nullptr;
+    ActiveLoads.fetch_sub(1, std::memory_order_release);
+    return object;
+  }
+
+  /// Called when the object is deallocated, before its memory is freed.
+  void detachObject() {
+    Object.store(nullptr, std::memory_order_seq_cst);
+
+    // Wait for weak loads which might still access the object's reference
+    // count. They fail to retain the object, because it is deallocating.
+    while (ActiveLoads.load(std::memory_order_acquire) != 0)
+      sched_yield();
+  }
+};
+
+} // end anonymous namespace
+
+namespace {
+
+/// A part of the map from objects to their side table entries.
+///
+/// Each shard is on its own cache line, so that the locks of different shards
+/// don't share a cache line.
+struct alignas(64) SideTableShard {
+  pthread_mutex_t Lock;
+
+  /// Guarded by Lock.
+  llvm::DenseMap<HeapObject *, HeapObjectSideTableEntry *> Entries;
+
+  SideTableShard() {
+    pthread_mutex_init(&Lock, nullptr);
+  }
+};
+
+/// Maps objects to their side table entries.
+struct SideTableMap {
+  enum : unsigned { NumShards = 64 };
+
+  SideTableShard Shards[NumShards];
+
+  SideTableShard &getShard(HeapObject *object) {
+    // The low bits of an object address are always zero. Fold in some higher
+    // bits, as objects of the same size class are allocated at regular
+    // distances.
+    uintptr_t bits = reinterpret_cast<uintptr_t>(object) >> 4;
+    return Shards[(bits ^ (bits >> 6) ^ (bits >> 12)) % NumShards];
+  }
+};
+
+} // end anonymous namespace
+
+static Lazy<SideTableMap> SideTables;
+
+/// Returns the side table entry of \p object, allocating it if necessary, with
+/// an additional reference for a new weak reference.
+static HeapObjectSideTableEntry *retainSideTable(HeapObject *object) {
+  SideTableShard &shard = SideTables->getShard(object);
+  pthread_mutex_lock(&shard.Lock);
+  auto &entry = shard.Entries[object];
+  if (!entry) {
+    entry = new HeapObjectSideTableEntry(object);
+    object->weakRefCount.setHasSideTable();
+  }
+  entry->retain();
+  pthread_mutex_unlock(&shard.Lock);
+  return entry;
+}
+
+/// Clears the object pointer in the side table entry of \p object and drops
+/// the object's reference to the entry.
+static void detachSideTable(HeapObject *object) {
+  SideTableShard &shard = SideTables->getShard(object);
+  pthread_mutex_lock(&shard.Lock);
+  auto found = shard.Entries.find(object);
+  assert(found != shard.Entries.end() && "object has no side table");
+  HeapObjectSideTableEntry *entry = found->second;
+  shard.Entries.erase(found);
+  pthread_mutex_unlock(&shard.Lock);
+
+  entry->detachObject();
+  entry->release();
+}
+
+static HeapObjectSideTableEntry *getSideTable(const WeakReference *ref) {
+  return reinterpret_cast<HeapObjectSideTableEntry *>(
+    reinterpret_cast<uintptr_t>(ref->Value) & ~NativeWeakReferenceMarker);
+}
+
+static void setSideTable(WeakReference *ref, HeapObjectSideTableEntry *entry) {
+  ref->Value = entry ? reinterpret_cast<HeapObject *>(
+    reinterpret_cast<uintptr_t>(entry) | NativeWeakReferenceMarker) : nullptr;
+}
+
 void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
-  ref->Value = value;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(value);
+  setSideTable(ref, value ? retainSideTable(value) : nullptr);
 }
 
 void swift::swift_weakAssign(WeakReference *ref, HeapObject *newValue) {
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(newValue);
-  auto oldValue = ref->Value;
-  ref->Value = newValue;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(oldValue);
+  auto oldEntry = getSideTable(ref);
+  swift_weakInit(ref, newValue);
+  if (oldEntry)
+    oldEntry->release();
 }
 
 HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
-  auto object = ref->Value;
-  if (object == nullptr) return nullptr;
-  if (object->refCount.isDeallocating()) {
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    ref->Value = nullptr;
-    return nullptr;
-  }
-  return swift_tryRetain(object);
+  // Don't clear the reference if the object is gone: loads may happen
+  // concurrently on the same reference. The entry is freed once the
+  // reference is destroyed or reassigned.
+  auto entry = getSideTable(ref);
+  if (entry == nullptr) return nullptr;
+  return entry->tryRetainObject();
 }
 
 HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
@@ -723,46 +889,40 @@ HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
 }
 
 void swift::swift_weakDestroy(WeakReference *ref) {
-  auto tmp = ref->Value;
+  auto entry = getSideTable(ref);
   ref->Value = nullptr;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(tmp);
+  if (entry)
+    entry->release();
 }
 
 void swift::swift_weakCopyInit(WeakReference *dest, WeakReference *src) {
-  auto object = src->Value;
-  if (object == nullptr) {
-    dest->Value = nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    src->Value = nullptr;
+  auto entry = getSideTable(src);
+  if (entry == nullptr || !entry->isObjectAlive()) {
     dest->Value = nullptr;
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
   } else {
-    dest->Value = object;
-    SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(object);
+    entry->retain();
+    setSideTable(dest, entry);
   }
 }
 
 void swift::swift_weakTakeInit(WeakReference *dest, WeakReference *src) {
-  auto object = src->Value;
-  dest->Value = object;
-  if (object != nullptr && object->refCount.isDeallocating()) {
-    dest->Value = nullptr;
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  dest->Value = src->Value;
 }
 
 void swift::swift_weakCopyAssign(WeakReference *dest, WeakReference *src) {
-  if (auto object = dest->Value) {
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (dest == src) return;
+  auto oldEntry = getSideTable(dest);
   swift_weakCopyInit(dest, src);
+  if (oldEntry)
+    oldEntry->release();
 }
 
 void swift::swift_weakTakeAssign(WeakReference *dest, WeakReference *src) {
-  if (auto object = dest->Value) {
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (dest == src) return;
+  auto oldEntry = getSideTable(dest);
   swift_weakTakeInit(dest, src);
+  if (oldEntry)
+    oldEntry->release();
 }
 
 void swift::_swift_abortRetainUnowned(const void *object) {
@@ -36,6 +36,7 @@
 #include "ExistentialMetadataImpl.h"
 #include "swift/Runtime/Debug.h"
 #include "Private.h"
+#include "StatisticsImpl.h"
 
 #if defined(__APPLE__)
 #include <mach/vm_page_size.h>
@@ -273,9 +274,13 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
     SWIFT_CC(RegisterPreservingCC_IMPL) {
   auto genericArgs = (const void * const *) arguments;
   size_t numGenericArgs = pattern->NumKeyArguments;
+  incrementRuntimeStatistic(RuntimeStatistic::GenericMetadataLookups);
 
   auto entry = getCache(pattern).findOrAdd(genericArgs, numGenericArgs,
     [&]() -> GenericCacheEntry* {
+      incrementRuntimeStatistic(
+                          RuntimeStatistic::GenericMetadataInstantiations);
+
       // Create new metadata to cache.
       auto metadata = pattern->CreateFunction(pattern, arguments);
       auto entry = GenericCacheEntry::getFromMetadata(pattern, metadata);
@@ -1031,6 +1036,7 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
 
       // Copy the function witnesses in, either from the proposed
       // witnesses or from the standard table.
+      bool usesNonPODTupleWitnesses = false;
       if (!proposedWitnesses) {
         // For a tuple with a single element, just use the witnesses for
         // the element type.
@@ -1054,6 +1060,7 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
         } else if (layout.flags.isInlineStorage()
                    && !layout.flags.isPOD()) {
           proposedWitnesses = &tuple_witnesses_nonpod_inline;
+          usesNonPODTupleWitnesses = true;
         } else if (!layout.flags.isInlineStorage()
                    && layout.flags.isPOD()) {
           proposedWitnesses = &tuple_witnesses_pod_noninline;
@@ -1061,6 +1068,7 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
           assert(!layout.flags.isInlineStorage()
                  && !layout.flags.isPOD());
           proposedWitnesses = &tuple_witnesses_nonpod_noninline;
+          usesNonPODTupleWitnesses = true;
         }
       }
 #define ASSIGN_TUPLE_WITNESS(NAME) \
@@ -1068,6 +1076,12 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
       FOR_ALL_FUNCTION_VALUE_WITNESSES(ASSIGN_TUPLE_WITNESS)
 #undef ASSIGN_TUPLE_WITNESS
 
+      // The generic non-POD witnesses take each element separately. If all
+      // elements are bitwise-takable, take the whole tuple (or array of
+      // tuples) with a memcpy instead.
+      if (usesNonPODTupleWitnesses)
+        installCommonValueWitnesses(witnesses);
+
       // We have extra inhabitants if the first element does.
       // FIXME: generalize this.
       if (auto firstEltEIVWT = dyn_cast<ExtraInhabitantsValueWitnessTable>(
@@ -1451,14 +1465,13 @@ static inline ClassROData *getROData(ClassMetadata *theClass) {
 
 static void _swift_initGenericClassObjCName(ClassMetadata *theClass) {
   // Use the remangler to generate a mangled name from the type metadata.
-  auto demangling = _swift_buildDemanglingForMetadata(theClass);
+  Demangle::NodeFactory Factory;
+  auto demangling = _swift_buildDemanglingForMetadata(theClass, Factory);
 
   // Remangle that into a new type mangling string.
-  auto typeNode
-    = Demangle::NodeFactory::create(Demangle::Node::Kind::TypeMangling);
+  auto typeNode = Factory.create(Demangle::Node::Kind::TypeMangling);
   typeNode->addChild(demangling);
-  auto globalNode
-    = Demangle::NodeFactory::create(Demangle::Node::Kind::Global);
+  auto globalNode = Factory.create(Demangle::Node::Kind::Global);
   globalNode->addChild(typeNode);
   
   auto string = Demangle::mangleNode(globalNode);
@@ -2613,6 +2626,9 @@ swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
   auto &cache = getCache(genericTable);
   auto entry = cache.findOrAdd(args, numGenericArgs,
     [&]() -> WitnessTableCacheEntry* {
+      incrementRuntimeStatistic(
+                          RuntimeStatistic::GenericWitnessTableInstantiations);
+
       // Allocate the witness table and fill it in.
       auto entry = allocateWitnessTable(genericTable,
                                         cache.getAllocator(),
@@ -33,6 +33,7 @@
 #include <link.h>
 #endif
 
+#include <atomic>
 #include <dlfcn.h>
 #include <mutex>
 
@@ -69,15 +70,39 @@ namespace {
   struct TypeMetadataCacheEntry {
   private:
     std::string Name;
-    const Metadata *Metadata;
+    std::atomic<const Metadata *> Metadata;
+    std::atomic<uintptr_t> FailureGeneration;
 
   public:
     TypeMetadataCacheEntry(const llvm::StringRef name,
-                           const ::Metadata *metadata)
-      : Name(name.str()), Metadata(metadata) {}
+                           const ::Metadata *metadata,
+                           uintptr_t failureGeneration)
+      : Name(name.str()), Metadata(metadata),
+        FailureGeneration(failureGeneration) {}
 
-    const ::Metadata *getMetadata(void) {
-      return Metadata;
+    bool isSuccessful() const {
+      return Metadata.load(std::memory_order_relaxed) != nullptr;
+    }
+
+    void makeSuccessful(const ::Metadata *metadata) {
+      Metadata.store(metadata, std::memory_order_release);
+    }
+
+    void updateFailureGeneration(uintptr_t failureGeneration) {
+      assert(!isSuccessful());
+      FailureGeneration.store(failureGeneration, std::memory_order_relaxed);
+    }
+
+    /// Get the cached metadata, if successful.
+    const ::Metadata *getMetadata(void) const {
+      assert(isSuccessful());
+      return Metadata.load(std::memory_order_acquire);
+    }
+
+    /// Get the generation number under which this lookup failed.
+    uintptr_t getFailureGeneration() const {
+      assert(!isSuccessful());
+      return FailureGeneration.load(std::memory_order_relaxed);
     }
 
     int compareWithKey(llvm::StringRef aName) const {
@@ -98,11 +123,43 @@ struct TypeMetadataState {
   std::vector<TypeMetadataSection> SectionsToScan;
   pthread_mutex_t SectionsToScanLock;
 
-  TypeMetadataState() {
+  /// The size of SectionsToScan, which can be read without taking the lock.
+  std::atomic<unsigned> NumSections;
+
+  /// The name index of the records in SectionsToScan. Guarded by
+  /// SectionsToScanLock.
+  TypeNameIndex NameIndex;
+
+  TypeMetadataState() : NumSections(0) {
     SectionsToScan.reserve(16);
     pthread_mutex_init(&SectionsToScanLock, nullptr);
     _initializeCallbacksToInspectDylib();
   }
+
+  /// Returns a number which changes whenever type metadata records or
+  /// protocol conformance records are registered. A failed lookup only needs
+  /// to be repeated if the generation changed since it failed.
+  uintptr_t getLookupGeneration() const {
+    return uintptr_t(NumSections.load(std::memory_order_acquire)) +
+           _getNumProtocolConformanceSections();
+  }
+
+  void cacheSuccess(llvm::StringRef typeName, const Metadata *metadata) {
+    auto result = Cache.getOrInsert(typeName, metadata, uintptr_t(0));
+
+    // If the entry was already present, it may be a failed lookup.
+    if (!result.second)
+      result.first->makeSuccessful(metadata);
+  }
+
+  void cacheFailure(llvm::StringRef typeName, uintptr_t failureGeneration) {
+    auto result = Cache.getOrInsert(typeName, (const Metadata *) nullptr,
+                                    failureGeneration);
+
+    // If the entry was already present, we may need to update it.
+    if (!result.second && !result.first->isSuccessful())
+      result.first->updateFailureGeneration(failureGeneration);
+  }
 };
 
 static Lazy<TypeMetadataState> TypeMetadataRecords;
@@ -113,6 +170,7 @@ _registerTypeMetadataRecords(TypeMetadataState &T,
                              const TypeMetadataRecord *end) {
   pthread_mutex_lock(&T.SectionsToScanLock);
   T.SectionsToScan.push_back(TypeMetadataSection{begin, end});
+  T.NumSections.store(T.SectionsToScan.size(), std::memory_order_release);
   pthread_mutex_unlock(&T.SectionsToScanLock);
 }
 
@@ -271,44 +329,78 @@ swift::_matchMetadataByMangledTypeName(const llvm::StringRef typeName,
   return metadata;
 }
 
+void TypeNameIndex::addRecord(const Metadata *metadata,
+                              const NominalTypeDescriptor *ntd) {
+  if (metadata != nullptr) {
+    assert(ntd == nullptr);
+    ntd = metadata->getNominalTypeDescriptor();
+    if (ntd == nullptr)
+      return;
+  } else if (!ntd->getGenericMetadataPattern() ||
+             ntd->GenericParams.isGeneric()) {
+    // Only non-generic resilient types can be instantiated from their
+    // descriptor, see _matchMetadataByMangledTypeName.
+    return;
+  }
+
+  // Don't overwrite the record of an earlier section.
+  Index.insert({ntd->Name.get(), Entry{metadata, metadata ? nullptr : ntd}});
+}
+
+const Metadata *TypeNameIndex::lookup(llvm::StringRef typeName) const {
+  auto iter = Index.find(typeName);
+  if (iter == Index.end())
+    return nullptr;
+  return _matchMetadataByMangledTypeName(typeName, iter->second.Type,
+                                         iter->second.Descriptor);
+}
+
 // returns the type metadata for the type named by typeName
 static const Metadata *
-_searchTypeMetadataRecords(const TypeMetadataState &T,
+_searchTypeMetadataRecords(TypeMetadataState &T,
                            const llvm::StringRef typeName) {
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = T.SectionsToScan.size();
-  const Metadata *foundMetadata = nullptr;
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = T.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
-
-      if (foundMetadata != nullptr)
-        return foundMetadata;
-    }
-  }
+  pthread_mutex_lock(&T.SectionsToScanLock);
+  // Index the sections of images which were loaded since the last lookup.
+  T.NameIndex.update(T.SectionsToScan);
+  auto foundMetadata = T.NameIndex.lookup(typeName);
+  pthread_mutex_unlock(&T.SectionsToScanLock);
+  return foundMetadata;
+}
 
+static const Metadata *
+_searchObjCClassByMangledName(const llvm::StringRef typeName) {
+#if SWIFT_OBJC_INTEROP
+  // Check for ObjC class
+  // FIXME does this have any value? any ObjC class with a Swift name
+  // should already be registered as a Swift type.
+  std::string prefixedName("_Tt" + typeName.str());
+  return reinterpret_cast<ClassMetadata *>
+    (objc_lookUpClass(prefixedName.c_str()));
+#else
   return nullptr;
+#endif
 }
 
 static const Metadata *
 _typeByMangledName(const llvm::StringRef typeName) {
-  const Metadata *foundMetadata = nullptr;
   auto &T = TypeMetadataRecords.get();
 
+  // Records which are registered after this point are not guaranteed to be
+  // seen by the search below, so the generation must be read before.
+  uintptr_t generation = T.getLookupGeneration();
+
   // Look for an existing entry.
-  // Find the bucket for the metadata entry.
-  if (auto Value = T.Cache.find(typeName))
-    return Value->getMetadata();
+  if (auto Value = T.Cache.find(typeName)) {
+    if (Value->isSuccessful())
+      return Value->getMetadata();
+
+    // The lookup failed before, and no new records were registered since.
+    if (Value->getFailureGeneration() == generation)
+      return _searchObjCClassByMangledName(typeName);
+  }
 
   // Check type metadata records
-  pthread_mutex_lock(&T.SectionsToScanLock);
-  foundMetadata = _searchTypeMetadataRecords(T, typeName);
-  pthread_mutex_unlock(&T.SectionsToScanLock);
+  const Metadata *foundMetadata = _searchTypeMetadataRecords(T, typeName);
 
   // Check protocol conformances table. Note that this has no support for
   // resolving generic types yet.
@@ -316,21 +408,12 @@ _typeByMangledName(const llvm::StringRef typeName) {
     foundMetadata = _searchConformancesByMangledTypeName(typeName);
 
   if (foundMetadata) {
-    T.Cache.getOrInsert(typeName, foundMetadata);
+    T.cacheSuccess(typeName, foundMetadata);
+    return foundMetadata;
   }
 
-#if SWIFT_OBJC_INTEROP
-  // Check for ObjC class
-  // FIXME does this have any value? any ObjC class with a Swift name
-  // should already be registered as a Swift type.
-  if (foundMetadata == nullptr) {
-    std::string prefixedName("_Tt" + typeName.str());
-    foundMetadata = reinterpret_cast<ClassMetadata *>
-      (objc_lookUpClass(prefixedName.c_str()));
-  }
-#endif
-
-  return foundMetadata;
+  T.cacheFailure(typeName, generation);
+  return _searchObjCClassByMangledName(typeName);
 }
 
 /// Return the type metadata for a given mangled name, used in the
@@ -17,6 +17,7 @@
 #include "Private.h"
 #include "swift/Runtime/Once.h"
 #include "swift/Runtime/Debug.h"
+#include <atomic>
 #include <type_traits>
 
 using namespace swift;
@@ -28,7 +29,45 @@ using namespace swift;
 #include <dispatch/dispatch.h>
 static_assert(std::is_same<swift_once_t, dispatch_once_t>::value,
               "swift_once_t and dispatch_once_t must stay in sync");
+#else
+
+#include <pthread.h>
+
+// On other platforms, the predicate is zero until some thread starts the
+// initialization, SwiftOnceRunning while the initializer runs and
+// SwiftOnceDone after it completed. Threads which find the initialization
+// running wait on a condition variable. It is shared by all predicates,
+// because this only happens if threads race on the first access.
+static const swift_once_t SwiftOnceRunning = 1;
+static pthread_mutex_t OnceMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t OnceCondition = PTHREAD_COND_INITIALIZER;
+
+static_assert(sizeof(std::atomic<swift_once_t>) == sizeof(swift_once_t),
+              "swift_once_t must be usable as an atomic word");
+
+LLVM_ATTRIBUTE_NOINLINE
+static void swift_once_slow(std::atomic<swift_once_t> &state,
+                            void (*fn)(void *)) {
+  swift_once_t expected = 0;
+  if (state.compare_exchange_strong(expected, SwiftOnceRunning,
+                                    std::memory_order_acquire)) {
+    fn(nullptr);
+
+    pthread_mutex_lock(&OnceMutex);
+    state.store(SwiftOnceDone, std::memory_order_release);
+    pthread_cond_broadcast(&OnceCondition);
+    pthread_mutex_unlock(&OnceMutex);
+    return;
+  }
+
+  // Another thread started the initialization. Wait until it completed.
+  pthread_mutex_lock(&OnceMutex);
+  while (state.load(std::memory_order_acquire) != SwiftOnceDone)
+    pthread_cond_wait(&OnceCondition, &OnceMutex);
+  pthread_mutex_unlock(&OnceMutex);
+}
 #endif
+
 // The compiler generates the swift_once_t values as word-sized zero-initialized
 // variables, so we want to make sure swift_once_t isn't larger than the
 // platform word or the function below might overwrite something it shouldn't.
@@ -41,15 +80,12 @@ static_assert(sizeof(swift_once_t) <= sizeof(void*),
 void swift::swift_once(swift_once_t *predicate, void (*fn)(void *)) {
 #if defined(__APPLE__)
   dispatch_once_f(predicate, nullptr, fn);
-#elif defined(__CYGWIN__)
-  _swift_once_f(predicate, nullptr, fn);
 #else
-  // FIXME: We're relying here on the coincidence that libstdc++ uses pthread's
-  // pthread_once, and that on glibc pthread_once follows a compatible init
-  // process (the token is a word that is atomically incremented from 0 to
-  // 1 to 2 during initialization) to work. We should implement our own version
-  // that we can rely on to continue to work that way.
-  // For more information, see rdar://problem/18499385
-  std::call_once(*predicate, [fn]() { fn(nullptr); });
+  // The compiler already checks for the done state inline, so this is usually
+  // only reached on the first access. Check again for callers which don't.
+  auto &state = *reinterpret_cast<std::atomic<swift_once_t> *>(predicate);
+  if (LLVM_LIKELY(state.load(std::memory_order_acquire) == SwiftOnceDone))
+    return;
+  swift_once_slow(state, fn);
 #endif
 }
@@ -20,6 +20,7 @@
 #include "swift/Basic/Demangle.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Metadata.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Compiler.h"
 
 // Opaque ISAs need to use object_getClass which is in runtime.h
@@ -69,6 +70,26 @@ namespace swift {
     return object == nullptr || isObjCTaggedPointer(object);
   }
 
+  /// Native weak references point to the side table entry of the object
+  /// instead of the object itself. The entry pointer is tagged with this
+  /// marker, which is the lowest bit not reserved for ObjC tagged pointers, so
+  /// that native references can be told apart from references which are
+  /// managed by the ObjC runtime.
+#if SWIFT_OBJC_INTEROP
+  static const uintptr_t NativeWeakReferenceMarker =
+    uintptr_t(1) << heap_object_abi::ObjCReservedLowBits;
+  static const uintptr_t NativeWeakReferenceMarkerMask =
+    heap_object_abi::ObjCReservedBitsMask | NativeWeakReferenceMarker;
+
+  /// Does the given weak reference contain a native Swift weak reference?
+  static inline bool isNativeWeakReference(const WeakReference *ref) {
+    return (((uintptr_t) ref->Value) & NativeWeakReferenceMarkerMask) ==
+      NativeWeakReferenceMarker;
+  }
+#else
+  static const uintptr_t NativeWeakReferenceMarker = 0;
+#endif
+
   /// Return the class of an object which is known to be an allocated
   /// heap object.
   /// Note, in this case, the object may or may not have a non-pointer ISA.
@@ -156,8 +177,60 @@ namespace swift {
   const Metadata *
   _searchConformancesByMangledTypeName(const llvm::StringRef typeName);
 
+  /// Returns the number of registered protocol conformance sections. The
+  /// number only grows, so it tells whether new conformances were registered
+  /// since a previous call.
+  unsigned _getNumProtocolConformanceSections();
+
+  /// Maps mangled type names to the type metadata and nominal type
+  /// descriptors referenced by the records of registered sections, so that
+  /// looking up a type by name doesn't need to scan all records.
+  ///
+  /// The index is extended with the records of new sections before each
+  /// lookup. If records of multiple sections have the same name, the first
+  /// one is found, like in a linear scan of the sections.
+  ///
+  /// The index is not thread-safe; it must be protected by the lock of the
+  /// sections it indexes.
+  class TypeNameIndex {
+    struct Entry {
+      const Metadata *Type;
+      const NominalTypeDescriptor *Descriptor;
+    };
+
+    llvm::StringMap<Entry> Index;
+
+    /// The number of sections whose records are already in the index.
+    unsigned NumIndexedSections = 0;
+
+    void addRecord(const Metadata *metadata, const NominalTypeDescriptor *ntd);
+
+  public:
+    /// Adds the records of all sections in \p sections which are not indexed
+    /// yet. Sections can only be appended to \p sections.
+    template <class SectionList>
+    void update(const SectionList &sections) {
+      for (; NumIndexedSections < sections.size(); ++NumIndexedSections) {
+        for (const auto &record : sections[NumIndexedSections]) {
+          if (auto metadata = record.getCanonicalTypeMetadata())
+            addRecord(metadata, nullptr);
+          else if (auto ntd = record.getNominalTypeDescriptor())
+            addRecord(nullptr, ntd);
+        }
+      }
+    }
+
+    /// Returns the type metadata for \p typeName, or null if no indexed
+    /// record has this name.
+    const Metadata *lookup(llvm::StringRef typeName) const;
+  };
+
 #if SWIFT_OBJC_INTEROP
-  Demangle::NodePointer _swift_buildDemanglingForMetadata(const Metadata *type);
+  /// Builds a demangle tree for \p type. The nodes are allocated in
+  /// \p Factory.
+  Demangle::NodePointer
+  _swift_buildDemanglingForMetadata(const Metadata *type,
+                                    Demangle::NodeFactory &Factory);
 #endif
 
 #if defined(__CYGWIN__)
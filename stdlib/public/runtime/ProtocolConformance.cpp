@@ -19,6 +19,7 @@
 #include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Metadata.h"
 #include "Private.h"
+#include "StatisticsImpl.h"
 
 #if defined(__APPLE__) && defined(__MACH__)
 #include <mach-o/dyld.h>
@@ -233,8 +234,15 @@ struct ConformanceState {
   ConcurrentMap<ConformanceCacheEntry> Cache;
   std::vector<ConformanceSection> SectionsToScan;
   pthread_mutex_t SectionsToScanLock;
+
+  /// The size of SectionsToScan, which can be read without taking the lock.
+  std::atomic<unsigned> NumSections;
+
+  /// The name index of the conforming types in SectionsToScan, which is used
+  /// by _searchConformancesByMangledTypeName. Guarded by SectionsToScanLock.
+  TypeNameIndex TypeNames;
   
-  ConformanceState() {
+  ConformanceState() : NumSections(0) {
     SectionsToScan.reserve(16);
     pthread_mutex_init(&SectionsToScanLock, nullptr);
     _initializeCallbacksToInspectDylib();
@@ -277,6 +285,7 @@ _registerProtocolConformances(ConformanceState &C,
                               const ProtocolConformanceRecord *end) {
   pthread_mutex_lock(&C.SectionsToScanLock);
   C.SectionsToScan.push_back(ConformanceSection{begin, end});
+  C.NumSections.store(C.SectionsToScan.size(), std::memory_order_release);
   pthread_mutex_unlock(&C.SectionsToScanLock);
 }
 
@@ -509,8 +518,11 @@ swift::swift_conformsToProtocol(const Metadata *type,
   auto &C = Conformances.get();
   auto origType = type;
   unsigned numSections = 0;
+  bool countedCacheMiss = false;
   ConformanceCacheEntry *foundEntry;
 
+  incrementRuntimeStatistic(RuntimeStatistic::ConformanceLookups);
+
 recur:
   // See if we have a cached conformance. The ConcurrentMap data structure
   // allows us to insert and search the map concurrently without locking.
@@ -526,6 +538,12 @@ recur:
       return FoundConformance.first;
   }
 
+  // Count the miss only once, even if the search starts over.
+  if (!countedCacheMiss) {
+    incrementRuntimeStatistic(RuntimeStatistic::ConformanceCacheMisses);
+    countedCacheMiss = true;
+  }
+
   unsigned failedGeneration = ConformanceCacheGeneration;
 
   // If we didn't have an up-to-date cache entry, scan the conformance records.
@@ -616,29 +634,16 @@ recur:
 const Metadata *
 swift::_searchConformancesByMangledTypeName(const llvm::StringRef typeName) {
   auto &C = Conformances.get();
-  const Metadata *foundMetadata = nullptr;
 
   pthread_mutex_lock(&C.SectionsToScanLock);
-
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = C.SectionsToScan.size();
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = C.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
-
-      if (foundMetadata != nullptr)
-        break;
-    }
-    if (foundMetadata != nullptr)
-      break;
-  }
-
+  // Index the sections of images which were loaded since the last lookup.
+  C.TypeNames.update(C.SectionsToScan);
+  const Metadata *foundMetadata = C.TypeNames.lookup(typeName);
   pthread_mutex_unlock(&C.SectionsToScanLock);
 
   return foundMetadata;
 }
+
+unsigned swift::_getNumProtocolConformanceSections() {
+  return Conformances.get().NumSections.load(std::memory_order_acquire);
+}
@@ -0,0 +1,146 @@
+//===--- Statistics.cpp - Swift runtime statistics ------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Aggregation and reporting of the runtime's per-thread event counters.
+//
+//===----------------------------------------------------------------------===//
+
+#include "StatisticsImpl.h"
+#include "swift/Basic/Lazy.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <pthread.h>
+
+using namespace swift;
+
+LLVM_LIBRARY_VISIBILITY SWIFT_STATISTICS_TLS_MODEL LLVM_THREAD_LOCAL
+ThreadStatistics *swift::_swift_currentThreadStatistics;
+
+namespace {
+struct StatisticsState {
+  /// The list of the blocks of all threads. Blocks are only ever prepended.
+  std::atomic<ThreadStatistics *> AllThreads;
+
+  /// A key with a destructor which retires the block of an exiting thread.
+  pthread_key_t ThreadExitKey;
+
+  /// The sums of the counters at the last reset.
+  uint64_t Baseline[NumRuntimeStatistics];
+
+  /// Protects Baseline.
+  pthread_mutex_t BaselineLock;
+
+  StatisticsState();
+};
+} // end anonymous namespace
+
+static Lazy<StatisticsState> Statistics;
+
+static void retireThreadStatistics(void *block) {
+  // If the thread counts more events while it is torn down, it gets a new
+  // block, which is retired in another round of key destructors.
+  _swift_currentThreadStatistics = nullptr;
+  static_cast<ThreadStatistics *>(block)->InUse.store(
+                                              false, std::memory_order_release);
+}
+
+static void dumpRuntimeStatisticsAtExit() {
+  swift_dumpRuntimeStatistics();
+}
+
+StatisticsState::StatisticsState() : AllThreads(nullptr), Baseline{} {
+  pthread_key_create(&ThreadExitKey, retireThreadStatistics);
+  pthread_mutex_init(&BaselineLock, nullptr);
+
+  if (getenv("SWIFT_RUNTIME_DUMP_STATISTICS"))
+    atexit(dumpRuntimeStatisticsAtExit);
+}
+
+ThreadStatistics *swift::_swift_allocateThreadStatistics() {
+  auto &state = Statistics.get();
+
+  // Take over the block of an exited thread, if there is one.
+  ThreadStatistics *statistics = nullptr;
+  for (auto block = state.AllThreads.load(std::memory_order_acquire);
+       block; block = block->Next) {
+    bool inUse = false;
+    if (!block->InUse.load(std::memory_order_relaxed) &&
+        block->InUse.compare_exchange_strong(inUse, true,
+                                             std::memory_order_acquire)) {
+      statistics = block;
+      break;
+    }
+  }
+
+  if (!statistics) {
+    statistics = new (malloc(sizeof(ThreadStatistics))) ThreadStatistics();
+    statistics->InUse.store(true, std::memory_order_relaxed);
+
+    auto head = state.AllThreads.load(std::memory_order_relaxed);
+    do {
+      statistics->Next = head;
+    } while (!state.AllThreads.compare_exchange_weak(head, statistics,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed));
+  }
+
+  pthread_setspecific(state.ThreadExitKey, statistics);
+  _swift_currentThreadStatistics = statistics;
+  return statistics;
+}
+
+/// Sums up the counters of all threads. The caller must hold BaselineLock.
+static void sumThreadStatistics(StatisticsState &state, uint64_t *sums) {
+  for (unsigned i = 0; i < NumRuntimeStatistics; ++i)
+    sums[i] = 0;
+
+  for (auto block = state.AllThreads.load(std::memory_order_acquire);
+       block; block = block->Next) {
+    for (unsigned i = 0; i < NumRuntimeStatistics; ++i)
+      sums[i] += block->Counters[i].load(std::memory_order_relaxed);
+  }
+}
+
+void swift::swift_getRuntimeStatistics(RuntimeStatistics *statistics) {
+  auto &state = Statistics.get();
+  uint64_t sums[NumRuntimeStatistics];
+
+  pthread_mutex_lock(&state.BaselineLock);
+  sumThreadStatistics(state, sums);
+  for (unsigned i = 0; i < NumRuntimeStatistics; ++i)
+    sums[i] -= state.Baseline[i];
+  pthread_mutex_unlock(&state.BaselineLock);
+
+#define RUNTIME_STATISTIC(Id, Description) \
+  statistics->Id = sums[unsigned(RuntimeStatistic::Id)];
+#include "swift/Runtime/Statistics.def"
+}
+
+void swift::swift_resetRuntimeStatistics() {
+  auto &state = Statistics.get();
+
+  pthread_mutex_lock(&state.BaselineLock);
+  sumThreadStatistics(state, state.Baseline);
+  pthread_mutex_unlock(&state.BaselineLock);
+}
+
+void swift::swift_dumpRuntimeStatistics() {
+  RuntimeStatistics statistics;
+  swift_getRuntimeStatistics(&statistics);
+
+  fprintf(stderr, "Swift runtime statistics:\n");
+#define RUNTIME_STATISTIC(Id, Description) \
+  fprintf(stderr, "%12llu %s\n", (unsigned long long)statistics.Id, \
+          Description);
+#include "swift/Runtime/Statistics.def"
+}
@@ -0,0 +1,91 @@
+//===--- StatisticsImpl.h - Counting runtime events -------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The runtime's implementation of the counters in swift/Runtime/Statistics.h.
+//
+// Counting an event is an increment of a counter in a thread-local block of
+// counters, without any atomic read-modify-write operation. The blocks of all
+// threads are summed up by swift_getRuntimeStatistics.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_STATISTICSIMPL_H
+#define SWIFT_RUNTIME_STATISTICSIMPL_H
+
+#include "swift/Runtime/Statistics.h"
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <stdint.h>
+
+namespace swift {
+
+enum class RuntimeStatistic : unsigned {
+#define RUNTIME_STATISTIC(Id, Description) Id,
+#include "swift/Runtime/Statistics.def"
+};
+
+enum : unsigned {
+  NumRuntimeStatistics = sizeof(RuntimeStatistics) / sizeof(uint64_t)
+};
+
+/// The counters of a thread.
+///
+/// Blocks are never deallocated. When a thread exits, its block is retired
+/// and handed to the next new thread, which continues counting where the
+/// exited thread stopped. Therefore the sum over all blocks includes the
+/// events of exited threads.
+struct ThreadStatistics {
+  /// Only the thread which owns the block writes its counters. Readers may
+  /// see slightly outdated values.
+  std::atomic<uint64_t> Counters[NumRuntimeStatistics];
+
+  /// True while the block is owned by a thread.
+  std::atomic<bool> InUse;
+
+  /// The next block in the list of all blocks.
+  ThreadStatistics *Next;
+};
+
+/// The TLS model of _swift_currentThreadStatistics.
+///
+/// The variable is only accessed from within the runtime library, which is
+/// loaded at program startup. With the initial-exec model (and hidden
+/// visibility) it is accessed at a fixed offset from the thread pointer,
+/// instead of calling __tls_get_addr on every counted event.
+#if defined(__ELF__)
+#define SWIFT_STATISTICS_TLS_MODEL __attribute__((tls_model("initial-exec")))
+#else
+#define SWIFT_STATISTICS_TLS_MODEL
+#endif
+
+/// The block of the current thread, or null if the thread did not count any
+/// events yet.
+extern LLVM_LIBRARY_VISIBILITY SWIFT_STATISTICS_TLS_MODEL LLVM_THREAD_LOCAL
+ThreadStatistics *_swift_currentThreadStatistics;
+
+/// Assigns a block to the current thread.
+ThreadStatistics *_swift_allocateThreadStatistics();
+
+/// Counts one event of the given kind on the current thread.
+static inline void incrementRuntimeStatistic(RuntimeStatistic statistic) {
+  ThreadStatistics *statistics = _swift_currentThreadStatistics;
+  if (LLVM_UNLIKELY(!statistics))
+    statistics = _swift_allocateThreadStatistics();
+
+  auto &counter = statistics->Counters[unsigned(statistic)];
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+
+} // end namespace swift
+
+#endif
@@ -874,6 +874,10 @@ void swift::swift_unknownUnownedTakeAssign(UnownedReference *dest,
 /****************************** WEAK REFERENCES ******************************/
 /*****************************************************************************/
 
+// Native weak references point to a side table entry and are tagged with
+// NativeWeakReferenceMarker. Everything else is a null or tagged pointer, or a
+// weak reference which is managed by the ObjC runtime.
+//
 // FIXME: these are not really valid implementations; they assume too
 // much about the implementation of ObjC weak references, and the
 // loads from ->Value can race with clears by the runtime.
@@ -887,10 +891,10 @@ static void doWeakInit(WeakReference *addr, void *value, bool valueIsNative) {
   }
 }
 
-static void doWeakDestroy(WeakReference *addr, bool valueIsNative) {
-  if (valueIsNative) {
+static void doWeakDestroy(WeakReference *addr) {
+  if (isNativeWeakReference(addr)) {
     swift_weakDestroy(addr);
-  } else {
+  } else if (!isObjCTaggedPointerOrNull(addr->Value)) {
     objc_destroyWeak((id*) &addr->Value);
   }
 }
@@ -914,74 +918,67 @@ void swift::swift_unknownWeakAssign(WeakReference *addr, void *newValue) {
 
   bool newIsNative = usesNativeSwiftReferenceCounting_allocated(newValue);
 
-  // If the existing value is not allocated, this is just an initialize.
-  void *oldValue = addr->Value;
-  if (isObjCTaggedPointerOrNull(oldValue))
-    return doWeakInit(addr, newValue, newIsNative);
-
-  bool oldIsNative = usesNativeSwiftReferenceCounting_allocated(oldValue);
-
   // If they're both native, we can use the native function.
+  bool oldIsNative = isNativeWeakReference(addr);
   if (oldIsNative && newIsNative)
     return swift_weakAssign(addr, (HeapObject*) newValue);
 
+  // If the existing value is not allocated, this is just an initialize.
+  void *oldValue = addr->Value;
+  if (!oldIsNative && isObjCTaggedPointerOrNull(oldValue))
+    return doWeakInit(addr, newValue, newIsNative);
+
   // If neither is native, we can use the ObjC function.
   if (!oldIsNative && !newIsNative)
     return (void) objc_storeWeak((id*) &addr->Value, (id) newValue);
 
   // Otherwise, destroy according to one set of semantics and
   // re-initialize with the other.
-  doWeakDestroy(addr, oldIsNative);
+  doWeakDestroy(addr);
   doWeakInit(addr, newValue, newIsNative);
 }
 
 void *swift::swift_unknownWeakLoadStrong(WeakReference *addr) {
+  if (isNativeWeakReference(addr))
+    return swift_weakLoadStrong(addr);
+
   void *value = addr->Value;
   if (isObjCTaggedPointerOrNull(value)) return value;
-
-  if (usesNativeSwiftReferenceCounting_allocated(value)) {
-    return swift_weakLoadStrong(addr);
-  } else {
-    return (void*) objc_loadWeakRetained((id*) &addr->Value);
-  }
+  return (void*) objc_loadWeakRetained((id*) &addr->Value);
 }
 
 void *swift::swift_unknownWeakTakeStrong(WeakReference *addr) {
+  if (isNativeWeakReference(addr))
+    return swift_weakTakeStrong(addr);
+
   void *value = addr->Value;
   if (isObjCTaggedPointerOrNull(value)) return value;
-
-  if (usesNativeSwiftReferenceCounting_allocated(value)) {
-    return swift_weakTakeStrong(addr);
-  } else {
-    void *result = (void*) objc_loadWeakRetained((id*) &addr->Value);
-    objc_destroyWeak((id*) &addr->Value);
-    return result;
-  }
+  void *result = (void*) objc_loadWeakRetained((id*) &addr->Value);
+  objc_destroyWeak((id*) &addr->Value);
+  return result;
 }
 
 void swift::swift_unknownWeakDestroy(WeakReference *addr) {
-  id object = (id) addr->Value;
-  if (isObjCTaggedPointerOrNull(object)) return;
-  doWeakDestroy(addr, usesNativeSwiftReferenceCounting_allocated(object));
+  doWeakDestroy(addr);
 }
 void swift::swift_unknownWeakCopyInit(WeakReference *dest, WeakReference *src) {
+  if (isNativeWeakReference(src))
+    return swift_weakCopyInit(dest, src);
   id object = (id) src->Value;
   if (isObjCTaggedPointerOrNull(object)) {
     dest->Value = (HeapObject*) object;
     return;
   }
-  if (usesNativeSwiftReferenceCounting_allocated(object))
-    return swift_weakCopyInit(dest, src);
   objc_copyWeak((id*) &dest->Value, (id*) src);
 }
 void swift::swift_unknownWeakTakeInit(WeakReference *dest, WeakReference *src) {
+  if (isNativeWeakReference(src))
+    return swift_weakTakeInit(dest, src);
   id object = (id) src->Value;
   if (isObjCTaggedPointerOrNull(object)) {
     dest->Value = (HeapObject*) object;
     return;
   }
-  if (usesNativeSwiftReferenceCounting_allocated(object))
-    return swift_weakTakeInit(dest, src);
   objc_moveWeak((id*) &dest->Value, (id*) &src->Value);
 }
 void swift::swift_unknownWeakCopyAssign(WeakReference *dest, WeakReference *src) {
@@ -323,6 +323,16 @@ Runtime.test("typeByName") {
   expectTrue(_typeByName("Swift.NonObjectiveCBase") == NonObjectiveCBase.self)
 }
 
+Runtime.test("typeByName/cached") {
+  // Repeated lookups are answered from the cache, including failed ones.
+  for _ in 0..<3 {
+    expectTrue(_typeByName("a.SomeClass") == SomeClass.self)
+    expectTrue(_typeByName("a.SomeConformingClass") == SomeConformingClass.self)
+    expectTrue(_typeByName("a.NoSuchClass") == nil)
+    expectTrue(_typeByName("") == nil)
+  }
+}
+
 Runtime.test("demangleName") {
   expectEqual("", _stdlib_demangleName(""))
   expectEqual("abc", _stdlib_demangleName("abc"))
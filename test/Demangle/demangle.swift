@@ -9,6 +9,21 @@ RUN: sed -ne '/--->/s/^.*---> *//p' < %S/Inputs/manglings.txt > %t.check
 RUN: swift-demangle < %t.input > %t.output
 RUN: diff %t.check %t.output
 
+Demangle the input in many small chunks on multiple threads. The input is
+repeated so that the demangled names are taken from the per-thread caches.
+RUN: cat %t.input %t.input > %t.input2
+RUN: cat %t.check %t.check > %t.check2
+RUN: swift-demangle -j=4 -chunk-size=64 -input-file=%t.input2 > %t.output2
+RUN: diff %t.check2 %t.output2
+RUN: swift-demangle -j=3 -chunk-size=1 -max-cached-names=8 < %t.input2 > %t.output3
+RUN: diff %t.check2 %t.output3
+
+Read the input in very small parts, so that symbols span parts.
+RUN: swift-demangle -chunk-size=0 < %t.input2 > %t.output4
+RUN: diff %t.check2 %t.output4
+RUN: swift-demangle -j=2 -chunk-size=5 < %t.input2 > %t.output5
+RUN: diff %t.check2 %t.output5
+
 ; RUN: swift-demangle __TtSi | FileCheck %s -check-prefix=DOUBLE
 ; DOUBLE: _TtSi ---> Swift.Int
 
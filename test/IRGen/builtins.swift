@@ -369,16 +369,17 @@ func testCondFail(b: Bool, c: Bool) {
 
 // CHECK-LABEL: define hidden void @_TF8builtins8testOnce{{.*}}(i8*, i8*) {{.*}} {
 // CHECK:         [[PRED_PTR:%.*]] = bitcast i8* %0 to [[WORD:i64|i32]]*
-// CHECK-objc:    [[PRED:%.*]] = load {{.*}} [[WORD]]* [[PRED_PTR]]
-// CHECK-objc:    [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
-// CHECK-objc:    br i1 [[IS_DONE]], label %[[DONE:.*]], label %[[NOT_DONE:.*]]
-// CHECK-objc:  [[NOT_DONE]]:
+// CHECK-objc:    [[PRED:%.*]] = load [[WORD]], [[WORD]]* [[PRED_PTR]], align
+// CHECK-native:  [[PRED:%.*]] = load atomic [[WORD]], [[WORD]]* [[PRED_PTR]] acquire
+// CHECK:         [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
+// CHECK:         br i1 [[IS_DONE]], label %[[DONE:.*]], label %[[NOT_DONE:.*]]
+// CHECK:       [[NOT_DONE]]:
 // CHECK:         call void @swift_once([[WORD]]* [[PRED_PTR]], i8* %1)
-// CHECK-objc:    br label %[[DONE]]
-// CHECK-objc:  [[DONE]]:
-// CHECK-objc:    [[PRED:%.*]] = load {{.*}} [[WORD]]* [[PRED_PTR]]
-// CHECK-objc:    [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
-// CHECK-objc:    call void @llvm.assume(i1 [[IS_DONE]])
+// CHECK:         br label %[[DONE]]
+// CHECK:       [[DONE]]:
+// CHECK:         [[PRED:%.*]] = load {{.*}} [[WORD]]* [[PRED_PTR]]
+// CHECK:         [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
+// CHECK:         call void @llvm.assume(i1 [[IS_DONE]])
 
 func testOnce(p: Builtin.RawPointer, f: @convention(thin) () -> ()) {
   Builtin.once(p, f)
@@ -499,6 +500,34 @@ func copyGenArray<T>(dest: Builtin.RawPointer, src: Builtin.RawPointer, count: B
   Builtin.takeArrayBackToFront(T.self, dest, src, count)
 }
 
+struct GenStruct<T> {
+  var x: T
+  var c: C
+}
+
+// Arrays of generic structs are destroyed and copied with the array witnesses
+// of the struct, which the runtime replaces if the struct is POD or
+// bitwise-takable.
+// CHECK-LABEL: define hidden void @_TF8builtins21destroyGenStructArray{{.*}}
+// CHECK-NOT:   loop:
+// CHECK:         call void %destroyArray
+func destroyGenStructArray<T>(array: Builtin.RawPointer, count: Builtin.Word, _: T) {
+  Builtin.destroyArray(GenStruct<T>.self, array, count)
+}
+
+// CHECK-LABEL: define hidden void @_TF8builtins18copyGenStructArray{{.*}}
+// CHECK-NOT:   loop:
+// CHECK:         call %swift.opaque* %initializeArrayWithCopy
+// CHECK-NOT:   loop:
+// CHECK:         call %swift.opaque* %initializeArrayWithTakeFrontToBack
+// CHECK-NOT:   loop:
+// CHECK:         call %swift.opaque* %initializeArrayWithTakeBackToFront
+func copyGenStructArray<T>(dest: Builtin.RawPointer, src: Builtin.RawPointer, count: Builtin.Word, _: T) {
+  Builtin.copyArray(GenStruct<T>.self, dest, src, count)
+  Builtin.takeArrayFrontToBack(GenStruct<T>.self, dest, src, count)
+  Builtin.takeArrayBackToFront(GenStruct<T>.self, dest, src, count)
+}
+
 // CHECK-LABEL: define hidden void @_TF8builtins24conditionallyUnreachableFT_T_
 // CHECK-NEXT:  entry
 // CHECK-NEXT:    unreachable
@@ -0,0 +1,69 @@
+// RUN: %target-run-simple-swift | FileCheck %s
+// REQUIRES: executable_test
+
+// Casts to protocol types remember the witness tables of the first type they
+// see in an inline cache. Check that other types still cast correctly.
+
+protocol Named : class {
+  var name: String { get }
+}
+
+class A : Named {
+  var name: String { return "A" }
+}
+
+class B : Named {
+  var name: String { return "B" }
+}
+
+class SubA : A {}
+
+class Unnamed {}
+
+func describe(x: AnyObject) -> String {
+  if let named = x as? Named {
+    return named.name
+  }
+  return "unnamed"
+}
+
+// CHECK: unnamed
+print(describe(Unnamed()))
+// CHECK: A
+print(describe(A()))
+// CHECK: A
+print(describe(A()))
+// CHECK: B
+print(describe(B()))
+// CHECK: A
+print(describe(SubA()))
+// CHECK: unnamed
+print(describe(Unnamed()))
+
+protocol HasKind {
+  static var kind: String { get }
+}
+
+struct S : HasKind {
+  static var kind: String { return "S" }
+}
+
+struct T : HasKind {
+  static var kind: String { return "T" }
+}
+
+func kind(t: Any.Type) -> String {
+  if let k = t as? HasKind.Type {
+    return k.kind
+  }
+  return "none"
+}
+
+// CHECK: S
+print(kind(S.self))
+// CHECK: S
+print(kind(S.self))
+// CHECK: T
+print(kind(T.self))
+// CHECK: none
+print(kind(Int.self))
@@ -0,0 +1,21 @@
+// RUN: %target-swift-frontend -O -emit-sil -primary-file %s | FileCheck %s
+
+// Stack promotion of closure contexts must not prevent the closure
+// optimizations from specializing or removing the closures which are passed
+// to map and filter.
+
+// CHECK-LABEL: sil @_TF23closure_stack_promotion7testMap
+// CHECK-NOT: partial_apply
+// CHECK-NOT: dealloc_ref [stack]
+// CHECK: return
+public func testMap(a: [Int], k: Int) -> [Int] {
+  return a.map { $0 + k }
+}
+
+// CHECK-LABEL: sil @_TF23closure_stack_promotion10testFilter
+// CHECK-NOT: partial_apply
+// CHECK-NOT: dealloc_ref [stack]
+// CHECK: return
+public func testFilter(a: [Int], k: Int) -> [Int] {
+  return a.filter { $0 > k }
+}
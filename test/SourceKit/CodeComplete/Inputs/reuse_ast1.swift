@@ -0,0 +1,13 @@
+struct Foo {
+  var bigPower: Int = 0
+  func advancedFeatures(x: Int) {}
+}
+
+func foo() {
+  let x = Foo()
+  x.
+}
+
+func bar() -> Int {
+  return 1
+}
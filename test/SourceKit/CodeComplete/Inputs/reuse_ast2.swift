@@ -0,0 +1,14 @@
+struct Foo {
+  var bigPower: Int = 0
+  func advancedFeatures(x: Int) {}
+}
+
+func foo() {
+  let x = Foo()
+  let localVariable = x.bigPower
+  
+}
+
+func bar() -> Int {
+  return 1
+}
@@ -0,0 +1,14 @@
+struct Foo {
+  var bigPower: Int = 0
+  func advancedFeatures(x: Int) {}
+}
+
+func foo() {
+  let x = Foo()
+} func newFunc(newParam: Int) {
+  
+}
+
+func bar() -> Int {
+  return 1
+}
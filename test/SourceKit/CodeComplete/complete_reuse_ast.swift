@@ -0,0 +1,38 @@
+// Consecutive completions in the same function body reuse the AST of the
+// previous completion. Check that the edited body is parsed again.
+
+// RUN: %sourcekitd-test \
+// RUN:   -req=complete -pos=8:5 -text-input %S/Inputs/reuse_ast1.swift %t.swift -- -parse-as-library %t.swift == \
+// RUN:   -req=complete -pos=9:3 -text-input %S/Inputs/reuse_ast2.swift %t.swift -- -parse-as-library %t.swift == \
+// RUN:   -req=complete -pos=12:3 -text-input %S/Inputs/reuse_ast2.swift %t.swift -- -parse-as-library %t.swift \
+// RUN:   | FileCheck %s
+
+// The member completion in the original body.
+// CHECK-LABEL: key.results: [
+// CHECK: key.name: "advancedFeatures(x:)"
+// CHECK: key.name: "bigPower"
+// CHECK: ]
+
+// The unqualified completion in the edited body sees the new local variable.
+// CHECK-LABEL: key.results: [
+// CHECK: key.name: "localVariable"
+// CHECK: ]
+
+// A completion in a different function doesn't see it.
+// CHECK-LABEL: key.results: [
+// CHECK-NOT: key.name: "localVariable"
+// CHECK: ]
+
+// An edit which ends the declaration early and starts a new one can't reuse
+// the AST.
+// RUN: %sourcekitd-test \
+// RUN:   -req=complete -pos=8:5 -text-input %S/Inputs/reuse_ast1.swift %t.swift -- -parse-as-library %t.swift == \
+// RUN:   -req=complete -pos=9:3 -text-input %S/Inputs/reuse_ast3.swift %t.swift -- -parse-as-library %t.swift \
+// RUN:   | FileCheck %s -check-prefix=MOVED
+
+// MOVED-LABEL: key.results: [
+// MOVED: key.name: "bigPower"
+// MOVED: ]
+// MOVED-LABEL: key.results: [
+// MOVED: key.name: "newParam"
+// MOVED: ]
@@ -0,0 +1,10 @@
+// RUN: rm -rf %t.mod
+// RUN: mkdir %t.mod
+// RUN: %swift -emit-module -o %t.mod/cake.swiftmodule %S/Inputs/cake.swift -parse-as-library
+
+// The second request only reports the declaration of 'MyEnum', and reuses the
+// interface that was printed for the first one.
+// RUN: %sourcekitd-test -req=doc-info -module cake -- -I %t.mod \
+// RUN:   == -req=doc-info -module cake -offset=196 -length=37 -- -I %t.mod > %t.response
+// RUN: cat %S/doc_swift_module.swift.response %s.response > %t.expected
+// RUN: diff -u %t.expected %t.response
@@ -7,6 +7,12 @@
 // RUN: %sourcekitd-test -req=index %t/test_module.swiftmodule | %sed_clean > %t.response
 // RUN: diff -u %S/Inputs/test_module.index.response %t.response
 
+// Indexing the module again in the same process reports the recorded symbols,
+// which must be the same.
+// RUN: %sourcekitd-test -req=index %t/test_module.swiftmodule == -req=index %t/test_module.swiftmodule | %sed_clean > %t.response2
+// RUN: cat %t.response %t.response > %t.response2.expected
+// RUN: diff -u %t.response2.expected %t.response2
+
 import test_module
 
 func foo(a: TwoInts) {
@@ -475,9 +475,18 @@ public:
                                 std::function<void(ArrayRef<StringRef>,
                                                    StringRef Error)> Receiver) = 0;
 
+  /// Reports the doc info of a module, or of the source in \p InputBuf if
+  /// \p ModuleName is empty.
+  ///
+  /// If \p Range is set, only the part of the response for the text at
+  /// (offset, length) is reported: the text itself, the top-level entities
+  /// that start in it and the annotations in it. The offsets stay relative to
+  /// the whole text, so a client can request a large module in consecutive
+  /// pages and concatenate them.
   virtual void getDocInfo(llvm::MemoryBuffer *InputBuf,
                           StringRef ModuleName,
                           ArrayRef<const char *> Args,
+                          Optional<std::pair<unsigned, unsigned>> Range,
                           DocInfoConsumer &Consumer) = 0;
 
   static std::unique_ptr<LangSupport> createSwiftLangSupport(
@@ -14,7 +14,9 @@
 #define LLVM_SOURCEKIT_LIB_SUPPORT_FUZZYSTRINGMATCHER_H
 
 #include "SourceKit/Core/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/BitVector.h"
+#include <cstdint>
 #include <string>
 
 namespace SourceKit {
@@ -32,6 +34,9 @@ class FuzzyStringMatcher {
   double maxScore; ///< The maximum possible raw score for this pattern.
   /// If (and only if) c is in pattern, charactersInPattern[c] == 1
   llvm::BitVector charactersInPattern;
+  /// The case-insensitive "character bag" of the pattern, see
+  /// getCharacterMask().
+  uint64_t patternCharacterMask;
 
 public:
   bool normalize = false; ///< Whether to normalize scores to [0, 1].
@@ -45,8 +50,30 @@ public:
   /// the candidate's score.
   bool matchesCandidate(StringRef candidate) const;
 
+  /// Whether \p candidate contains every character of the pattern, ignoring
+  /// case and order.
+  ///
+  /// This is a necessary condition for matchesCandidate(). It is cheaper
+  /// than the in-order check and rejects most non-matching candidates.
+  bool mayMatchCandidate(StringRef candidate) const;
+
+  /// Returns a set of the characters in \p str, folded into 64 bits.
+  ///
+  /// Upper- and lowercase letters map to the same bit, so do some of the
+  /// non-alphanumeric characters.
+  static uint64_t getCharacterMask(StringRef str);
+
   /// Calculates the numerical score for \p candidate.
   double scoreCandidate(StringRef candidate) const;
+
+  /// Calculates the score of each of \p candidates into \p scores, which
+  /// must have the same size.
+  ///
+  /// Scoring is much more expensive than matching, so large sets of
+  /// candidates (at least 8192) are split into chunks that are scored
+  /// concurrently.
+  void scoreCandidates(ArrayRef<StringRef> candidates,
+                       llvm::MutableArrayRef<double> scores) const;
 };
 
 } // end namespace SourceKit
@@ -21,10 +21,14 @@
 #include "llvm/Support/Mutex.h"
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace llvm {
   class MemoryBuffer;
-  class SourceMgr;
+}
+
+namespace clang {
+  class RewriteRope;
 }
 
 namespace SourceKit {
@@ -70,8 +74,11 @@ private:
 };
 
 class ImmutableTextBuffer : public ImmutableTextUpdate {
-  std::unique_ptr<llvm::SourceMgr> SrcMgr;
-  unsigned BufId;
+  std::unique_ptr<llvm::MemoryBuffer> MemBuf;
+
+  /// The byte offsets of the starts of all lines, for mapping offsets to
+  /// lines with a binary search.
+  std::vector<unsigned> LineStarts;
 
 public:
   explicit ImmutableTextBuffer(std::unique_ptr<llvm::MemoryBuffer> MemBuf,
@@ -158,8 +165,17 @@ class EditableTextBuffer : public ThreadSafeRefCountedBase<EditableTextBuffer> {
   ImmutableTextUpdateRef CurrUpd;
   std::string Filename;
 
+  /// The text after all updates up to \c CurrUpd.
+  ///
+  /// Edits are applied to the rope in logarithmic time, and the text pieces
+  /// are shared with the previous versions. This avoids replaying all updates
+  /// since the last materialized buffer whenever the latest snapshot is
+  /// materialized.
+  std::unique_ptr<clang::RewriteRope> CurrText;
+
 public:
   explicit EditableTextBuffer(StringRef Filename, StringRef Text = StringRef());
+  ~EditableTextBuffer();
 
   StringRef getFilename() const { return Filename; }
 
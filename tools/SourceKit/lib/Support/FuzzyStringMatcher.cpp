@@ -11,9 +11,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "SourceKit/Support/FuzzyStringMatcher.h"
+#include "SourceKit/Support/Concurrency.h"
 #include "clang/Basic/CharInfo.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallString.h"
+#include <condition_variable>
+#include <mutex>
 
 using namespace SourceKit;
 using clang::toUppercase;
@@ -33,6 +36,7 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
     charactersInPattern.set(static_cast<unsigned char>(toUppercase(c)));
   }
   assert(pattern.size() == lowercasePattern.size());
+  patternCharacterMask = getCharacterMask(pattern);
 
   // FIXME: pull out the magic constants.
   // This depends on the inner details of the matching algorithm and will need
@@ -50,12 +54,63 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
   }
 }
 
+namespace {
+/// Maps each byte to its bit in the character mask.
+struct CharacterMaskTable {
+  uint8_t bits[256];
+
+  CharacterMaskTable() {
+    for (unsigned c = 0; c < 256; ++c) {
+      if (c >= 'a' && c <= 'z')
+        bits[c] = c - 'a';
+      else if (c >= 'A' && c <= 'Z')
+        bits[c] = c - 'A';
+      else if (c >= '0' && c <= '9')
+        bits[c] = 26 + (c - '0');
+      else if (c == '_')
+        bits[c] = 36;
+      else
+        bits[c] = 37 + c % 27;
+    }
+  }
+};
+} // end anonymous namespace
+
+uint64_t FuzzyStringMatcher::getCharacterMask(StringRef str) {
+  static const CharacterMaskTable table;
+  const uint8_t *bits = table.bits;
+  const unsigned char *data = str.bytes_begin();
+  size_t size = str.size();
+
+  // Use independent accumulators so that the loop isn't serialized on a
+  // single register and the compiler is free to vectorize it.
+  uint64_t mask0 = 0, mask1 = 0, mask2 = 0, mask3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    mask0 |= uint64_t(1) << bits[data[i]];
+    mask1 |= uint64_t(1) << bits[data[i + 1]];
+    mask2 |= uint64_t(1) << bits[data[i + 2]];
+    mask3 |= uint64_t(1) << bits[data[i + 3]];
+  }
+  for (; i < size; ++i)
+    mask0 |= uint64_t(1) << bits[data[i]];
+  return mask0 | mask1 | mask2 | mask3;
+}
+
+bool FuzzyStringMatcher::mayMatchCandidate(StringRef candidate) const {
+  return (patternCharacterMask & ~getCharacterMask(candidate)) == 0;
+}
+
 bool FuzzyStringMatcher::matchesCandidate(StringRef candidate) const {
   unsigned patternLength = pattern.size();
   unsigned candidateLength = candidate.size();
   if (patternLength > candidateLength)
     return false;
 
+  // Most candidates don't even contain all of the pattern characters.
+  if (!mayMatchCandidate(candidate))
+    return false;
+
   // Do all of the pattern characters match the candidate in order?
   unsigned pidx = 0, cidx = 0;
   while (pidx < patternLength && cidx < candidateLength) {
@@ -529,3 +584,42 @@ CandidateSpecificMatcher::scoreCandidateTrial(unsigned firstPatternPos) {
 
   return trialScore;
 }
+
+void FuzzyStringMatcher::scoreCandidates(
+    ArrayRef<StringRef> candidates,
+    llvm::MutableArrayRef<double> scores) const {
+  assert(candidates.size() == scores.size());
+  const size_t chunkSize = 2048;
+  auto scoreChunk = [this, candidates, scores](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      scores[i] = scoreCandidate(candidates[i]);
+  };
+
+  if (candidates.size() < 4 * chunkSize) {
+    scoreChunk(0, candidates.size());
+    return;
+  }
+
+  std::mutex mtx;
+  std::condition_variable cond;
+  size_t pendingChunks = 0;
+  size_t size = candidates.size();
+  for (size_t begin = chunkSize; begin < size; begin += chunkSize) {
+    size_t end = std::min(begin + chunkSize, size);
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      ++pendingChunks;
+    }
+    WorkQueue::dispatchConcurrent([&, begin, end] {
+      scoreChunk(begin, end);
+      std::lock_guard<std::mutex> lock(mtx);
+      if (--pendingChunks == 0)
+        cond.notify_all();
+    }, WorkQueue::Priority::High);
+  }
+
+  // Score the first chunk on this thread while waiting for the others.
+  scoreChunk(0, chunkSize);
+  std::unique_lock<std::mutex> lock(mtx);
+  cond.wait(lock, [&] { return pendingChunks == 0; });
+}
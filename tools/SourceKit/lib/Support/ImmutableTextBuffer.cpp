@@ -13,7 +13,7 @@
 #include "SourceKit/Support/ImmutableTextBuffer.h"
 #include "clang/Rewrite/Core/RewriteRope.h"
 #include "llvm/Support/MemoryBuffer.h"
-#include "llvm/Support/SourceMgr.h"
+#include <algorithm>
 
 using namespace SourceKit;
 using namespace llvm;
@@ -23,10 +23,13 @@ void ImmutableTextUpdate::anchor() {}
 
 ImmutableTextBuffer::ImmutableTextBuffer(
     std::unique_ptr<llvm::MemoryBuffer> MemBuf, uint64_t Stamp)
-  : ImmutableTextUpdate(Kind::Buffer, Stamp) {
-    SrcMgr.reset(new SourceMgr);
-    BufId = SrcMgr->AddNewSourceBuffer(std::move(MemBuf), SMLoc());
-  }
+  : ImmutableTextUpdate(Kind::Buffer, Stamp), MemBuf(std::move(MemBuf)) {
+  StringRef Text = this->MemBuf->getBuffer();
+  LineStarts.push_back(0);
+  for (size_t Pos = Text.find('\n'); Pos != StringRef::npos;
+       Pos = Text.find('\n', Pos + 1))
+    LineStarts.push_back(Pos + 1);
+}
 
 ImmutableTextBuffer::ImmutableTextBuffer(StringRef Filename, StringRef Text,
                                          uint64_t Stamp)
@@ -37,26 +40,28 @@ ImmutableTextBuffer::ImmutableTextBuffer(StringRef Filename, StringRef Text,
 }
 
 StringRef ImmutableTextBuffer::getFilename() const {
-  return SrcMgr->getMemoryBuffer(BufId)->getBufferIdentifier();
+  return MemBuf->getBufferIdentifier();
 }
 
 StringRef ImmutableTextBuffer::getText() const {
-
-  return SrcMgr->getMemoryBuffer(BufId)->getBuffer();
+  return MemBuf->getBuffer();
 }
 
 const llvm::MemoryBuffer *ImmutableTextBuffer::getInternalBuffer() const {
-  return SrcMgr->getMemoryBuffer(BufId);
+  return MemBuf.get();
 }
 
 std::pair<unsigned, unsigned>
 ImmutableTextBuffer::getLineAndColumn(unsigned ByteOffset) const {
-  auto Buf = SrcMgr->getMemoryBuffer(BufId);
-  if (ByteOffset > Buf->getBufferSize())
+  if (ByteOffset > MemBuf->getBufferSize())
     return std::make_pair(0, 0);
 
-  SMLoc Loc = SMLoc::getFromPointer(Buf->getBufferStart() + ByteOffset);
-  return SrcMgr->getLineAndColumn(Loc, 0);
+  // Find the last line which starts at or before the offset.
+  auto LineStart = std::upper_bound(LineStarts.begin(), LineStarts.end(),
+                                    ByteOffset) - 1;
+  unsigned Line = LineStart - LineStarts.begin() + 1;
+  unsigned Column = ByteOffset - *LineStart + 1;
+  return std::make_pair(Line, Column);
 }
 
 ReplaceImmutableTextUpdate::ReplaceImmutableTextUpdate(
@@ -123,8 +128,12 @@ EditableTextBuffer::EditableTextBuffer(StringRef Filename, StringRef Text) {
   this->Filename = Filename;
   Root = new ImmutableTextBuffer(Filename, Text, ++Generation);
   CurrUpd = Root;
+  CurrText.reset(new RewriteRope);
+  CurrText->assign(Text.begin(), Text.end());
 }
 
+EditableTextBuffer::~EditableTextBuffer() {}
+
 ImmutableTextSnapshotRef EditableTextBuffer::getSnapshot() const {
   return new ImmutableTextSnapshot(const_cast<EditableTextBuffer*>(this), Root,
                                    CurrUpd);
@@ -165,18 +174,19 @@ ImmutableTextSnapshotRef EditableTextBuffer::addAtomicUpdate(
   CurrUpd->Next = NewUpd;
   CurrUpd = NewUpd;
 
+  if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(NewUpd)) {
+    CurrText->erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
+    StringRef Text = ReplaceUpd->getText();
+    CurrText->insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
+  }
+
   return new ImmutableTextSnapshot(this, Root, CurrUpd);
 }
 
 static std::unique_ptr<llvm::MemoryBuffer>
 getMemBufferFromRope(StringRef Filename, const RewriteRope &Rope) {
-  size_t Length = 0;
-  for (RewriteRope::iterator I = Rope.begin(), E = Rope.end(); I != E;
-       I.MoveToNextPiece()) {
-    Length += I.piece().size();
-  }
-
-  auto MemBuf = llvm::MemoryBuffer::getNewUninitMemBuffer(Length, Filename);
+  auto MemBuf = llvm::MemoryBuffer::getNewUninitMemBuffer(Rope.size(),
+                                                          Filename);
   char *Ptr = (char*)MemBuf->getBufferStart();
   for (RewriteRope::iterator I = Rope.begin(), E = Rope.end(); I != E;
        I.MoveToNextPiece()) {
@@ -198,6 +208,23 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     if (auto Buf = dyn_cast<ImmutableTextBuffer>(Next))
       return Buf;
 
+  {
+    llvm::sys::ScopedLock L(EditMtx);
+    refresh();
+    if (Snap.DiffEnd == CurrUpd) {
+      // This is the latest snapshot, which is the common case for an editor
+      // document. Its text is already up-to-date in the rope.
+      auto MemBuf = getMemBufferFromRope(getFilename(), *CurrText);
+      ImmutableTextBufferRef ImmBuf =
+          new ImmutableTextBuffer(std::move(MemBuf), Snap.getStamp());
+      CurrUpd->Next = ImmBuf;
+      refresh();
+      return ImmBuf;
+    }
+  }
+
+  // This is an older snapshot. Replay its updates on top of the last buffer
+  // which was materialized before it.
   // Check if a buffer was created in the middle of the snapshot updates.
   ImmutableTextBufferRef StartBuf = Snap.BufferStart;
   ImmutableTextUpdateRef Upd = StartBuf;  
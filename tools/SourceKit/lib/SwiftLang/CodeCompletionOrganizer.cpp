@@ -476,6 +476,20 @@ bool FilterRules::hideCompletion(Completion *completion) const {
   return hideAll;
 }
 
+/// Sets the match score of each of \p matches.
+static void scoreMatches(const FuzzyStringMatcher &pattern,
+                         MutableArrayRef<std::unique_ptr<Item>> matches) {
+  std::vector<StringRef> names;
+  names.reserve(matches.size());
+  for (auto &item : matches)
+    names.push_back(static_cast<Result *>(item.get())->value->getName());
+
+  std::vector<double> scores(matches.size());
+  pattern.scoreCandidates(names, scores);
+  for (size_t i = 0, e = matches.size(); i != e; ++i)
+    static_cast<Result *>(matches[i].get())->matchScore = scores[i];
+}
+
 void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText, Options options,
     const FilterRules &rules, Completion *&exactMatch) {
@@ -542,6 +556,7 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
 
   FuzzyStringMatcher pattern(filterText);
   pattern.normalize = true;
+  unsigned firstMatch = contents.size();
   for (Completion *completion : completions) {
     if (rules.hideCompletion(completion))
       continue;
@@ -572,13 +587,13 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     }
 
     // Build wrapper and add to results.
-    if (match) {
-      auto wrapper = make_result(completion);
-      if (options.fuzzyMatching)
-        wrapper->matchScore = pattern.scoreCandidate(completion->getName());
-      contents.push_back(std::move(wrapper));
-    }
+    if (match)
+      contents.push_back(make_result(completion));
   }
+
+  if (options.fuzzyMatching)
+    scoreMatches(pattern,
+                 llvm::makeMutableArrayRef(contents).slice(firstMatch));
 }
 
 static double getSemanticContextScore(bool useImportDepth,
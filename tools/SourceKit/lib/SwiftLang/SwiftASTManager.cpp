@@ -157,6 +157,7 @@ namespace SourceKit {
   struct ASTUnit::Implementation {
     const uint64_t Generation;
     SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
+    SmallVector<std::pair<std::string, uint64_t>, 8> DependencyStamps;
     EditorDiagConsumer CollectDiagConsumer;
     CompilerInstance CompInst;
     OwnedResolver TypeResolver{ nullptr, nullptr };
@@ -202,6 +203,11 @@ namespace SourceKit {
     return Impl.Snapshots;
   }
 
+  ArrayRef<std::pair<std::string, uint64_t>>
+  ASTUnit::getDependencyStamps() const {
+    return Impl.DependencyStamps;
+  }
+
   SourceFile &ASTUnit::getPrimarySourceFile() const {
     return *Impl.CompInst.getPrimarySourceFile();
   }
@@ -798,12 +804,19 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   llvm::SmallPtrSet<Module *, 16> Visited;
   SmallVector<std::string, 8> Filenames;
   collectModuleDependencies(CompIns.getMainModule(), Visited, Filenames);
+  // The imported header is not a module file, so it is not found above.
+  const std::string &ImportedHeader =
+      Invocation.getFrontendOptions().ImplicitObjCHeaderPath;
+  if (!ImportedHeader.empty())
+    Filenames.push_back(ImportedHeader);
   // FIXME: There exists a small window where the module file may have been
   // modified after compilation finished and before we get its stamp.
   for (auto &Filename : Filenames) {
     DependencyStamps.push_back(std::make_pair(Filename,
                                               MgrImpl.getBufferStamp(Filename)));
   }
+  ASTRef->Impl.DependencyStamps.append(DependencyStamps.begin(),
+                                       DependencyStamps.end());
 
   // Since we only typecheck the primary file (plus referenced constructs
   // from other files), any error is likely to break SIL generation.
@@ -53,6 +53,9 @@ public:
   swift::CompilerInstance &getCompilerInstance() const;
   uint64_t getGeneration() const;
   ArrayRef<ImmutableTextSnapshotRef> getSnapshots() const;
+  /// The files other than the inputs which the AST depends on, like imported
+  /// modules, with their stamps at the time the AST was built.
+  ArrayRef<std::pair<std::string, uint64_t>> getDependencyStamps() const;
   EditorDiagConsumer &getEditorDiagConsumer() const;
   swift::SourceFile &getPrimarySourceFile() const;
 };
@@ -19,7 +19,9 @@
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/IDE/CodeCompletionCache.h"
+#include "swift/Subsystems.h"
 
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 using namespace SourceKit;
@@ -102,6 +104,226 @@ struct SwiftCodeCompletionConsumer
 };
 } // anonymous namespace
 
+//===----------------------------------------------------------------------===//
+// CodeCompletion::CompletionASTCache
+//===----------------------------------------------------------------------===//
+
+namespace SourceKit {
+namespace CodeCompletion {
+/// The compiler instance of a finished code completion request.
+struct CompletionAST {
+  /// Displays diagnostics to stderr. Must outlive \c CI.
+  PrintingDiagnosticConsumer printDiags;
+  CompilerInstance CI;
+  CompilerInvocation invocation;
+  std::vector<std::string> args;
+
+  /// The code completion buffer of the request which created the AST. The
+  /// invocation refers to it.
+  std::unique_ptr<llvm::MemoryBuffer> inputBuffer;
+
+  /// The text of the input file, without the code completion point.
+  std::string text;
+
+  /// The declaration which contained the code completion point. It is not
+  /// part of the AST, so it can be parsed again after an edit.
+  PersistentParserState::DelayedDeclInfo decl;
+
+  /// The offsets of the start of the declaration, of its last token and of the
+  /// token before the declaration, in \c text.
+  unsigned declStart;
+  unsigned declEnd;
+  Optional<unsigned> prevTokenOffset;
+
+  /// The other input files and the files of the loaded modules, with their
+  /// modification times when the AST was built.
+  std::vector<std::pair<std::string, llvm::sys::TimeValue>> files;
+
+  /// Each reuse adds a buffer and the nodes of a declaration to the AST.
+  unsigned numReuses = 0;
+
+  /// Returns true if one of the files which the AST was built from changed
+  /// since then.
+  bool isStale() const {
+    for (auto &file : files) {
+      llvm::sys::fs::file_status status;
+      if (llvm::sys::fs::status(file.first, status) ||
+          status.getLastModificationTime() != file.second)
+        return true;
+    }
+    return false;
+  }
+};
+} // end namespace CodeCompletion
+} // end namespace SourceKit
+
+using CodeCompletion::CompletionAST;
+using CodeCompletion::CompletionASTCache;
+
+CompletionASTCache::CompletionASTCache() {}
+CompletionASTCache::~CompletionASTCache() {}
+
+std::unique_ptr<CompletionAST> CompletionASTCache::take() {
+  llvm::sys::ScopedLock L(mtx);
+  return std::move(ast);
+}
+
+void CompletionASTCache::set(std::unique_ptr<CompletionAST> newAST) {
+  llvm::sys::ScopedLock L(mtx);
+  ast = std::move(newAST);
+}
+
+/// The number of completions after which the AST is rebuilt, to limit the
+/// memory growth of a reused AST.
+static const unsigned MaxNumReusesOfCompletionAST = 64;
+
+static int getBraceBalance(StringRef text) {
+  return int(text.count('{')) - int(text.count('}'));
+}
+
+/// Checks if code completion at \p Offset in \p Text can reuse \p AST.
+///
+/// This is the case if the request is for the same file and arguments, and
+/// the text outside of the declaration which contained the previous code
+/// completion point did not change. Returns the end offset of the declaration
+/// in \p Text in that case.
+static Optional<unsigned> canReuseCompletionAST(CompletionAST &AST,
+                                                StringRef BufferName,
+                                                StringRef Text, unsigned Offset,
+                                                ArrayRef<const char *> Args) {
+  if (AST.numReuses >= MaxNumReusesOfCompletionAST)
+    return None;
+
+  SourceFile *SF = AST.CI.getPrimarySourceFile();
+  if (!SF || SF->Kind != SourceFileKind::Library)
+    return None;
+  if (AST.decl.Kind != PersistentParserState::DelayedDeclKind::Decl)
+    return None;
+
+  if (AST.inputBuffer->getBufferIdentifier() != BufferName)
+    return None;
+  if (AST.args.size() != Args.size() ||
+      !std::equal(AST.args.begin(), AST.args.end(), Args.begin()))
+    return None;
+
+  if (AST.isStale())
+    return None;
+
+  StringRef OldText = AST.text;
+  unsigned SuffixLength = OldText.size() - AST.declEnd;
+  if (Text.size() < AST.declStart + SuffixLength)
+    return None;
+  unsigned NewDeclEnd = Text.size() - SuffixLength;
+  if (Offset < AST.declStart || Offset > NewDeclEnd)
+    return None;
+
+  if (Text.substr(0, AST.declStart) != OldText.substr(0, AST.declStart) ||
+      Text.substr(NewDeclEnd) != OldText.substr(AST.declEnd))
+    return None;
+
+  // The end of the declaration was found by skipping to the matching brace.
+  // If the edit changed the nesting of braces, the declaration could end
+  // somewhere else now.
+  StringRef OldDecl = OldText.slice(AST.declStart, AST.declEnd);
+  StringRef NewDecl = Text.slice(AST.declStart, NewDeclEnd);
+  if (getBraceBalance(OldDecl) != getBraceBalance(NewDecl))
+    return None;
+
+  return NewDeclEnd;
+}
+
+/// Runs code completion in \p NewBuffer, which contains the code completion
+/// point at \p Offset, by parsing and type-checking only the declaration which
+/// contains the code completion point. The declaration ends at \p DeclEnd.
+///
+/// Returns false, without reporting any results, if the edited declaration
+/// ends before \p DeclEnd. Then the AST can't be reused.
+static bool reuseCompletionAST(CompletionAST &AST,
+                               std::unique_ptr<llvm::MemoryBuffer> NewBuffer,
+                               unsigned Offset, unsigned DeclEnd,
+                               SwiftLangSupport &Lang,
+                               SwiftCodeCompletionConsumer &SwiftConsumer) {
+  auto &SM = AST.CI.getSourceMgr();
+  unsigned BufferID = SM.addNewSourceBuffer(std::move(NewBuffer));
+  SM.setCodeCompletionPoint(BufferID, Offset);
+
+  // Map the declaration to the new buffer. The offsets before the code
+  // completion point did not change, the ones after it moved by one for the
+  // code completion token.
+  PersistentParserState::DelayedDeclInfo Decl = AST.decl;
+  Decl.BodyRange = SourceRange(SM.getLocForOffset(BufferID, AST.declStart),
+                               SM.getLocForOffset(BufferID, DeclEnd + 1));
+  Decl.PreviousLoc = AST.prevTokenOffset.hasValue()
+      ? SM.getLocForOffset(BufferID, *AST.prevTokenOffset)
+      : SourceLoc();
+
+  auto swiftCache = Lang.getCodeCompletionCache(); // Pin the cache.
+  ide::CodeCompletionContext CompletionContext(swiftCache->getCache());
+  std::unique_ptr<CodeCompletionCallbacksFactory> CompletionCallbacksFactory(
+      ide::makeCodeCompletionCallbacksFactory(CompletionContext,
+                                              SwiftConsumer));
+
+  CloseClangModuleFiles scopedCloseFiles(
+      *AST.CI.getASTContext().getClangModuleLoader());
+  SwiftConsumer.setContext(&AST.CI.getASTContext(), &AST.invocation,
+                           &CompletionContext);
+  bool Reused = performCodeCompletionReparse(*AST.CI.getPrimarySourceFile(),
+                                             BufferID, Decl,
+                                             CompletionCallbacksFactory.get());
+  SwiftConsumer.clearContext();
+  ++AST.numReuses;
+  return Reused;
+}
+
+/// Records the modification times of the files which \p AST was built from,
+/// except of the primary input file \p PrimaryFile, which comes from the
+/// request.
+static void recordCompletionASTFiles(CompletionAST &AST,
+                                     StringRef PrimaryFile) {
+  auto addFile = [&](StringRef Filename) {
+    llvm::sys::fs::file_status Status;
+    if (Filename.empty() || Filename == PrimaryFile ||
+        llvm::sys::fs::status(Filename, Status))
+      return;
+    AST.files.emplace_back(Filename, Status.getLastModificationTime());
+  };
+
+  for (auto &Input : AST.invocation.getInputFilenames())
+    addFile(Input);
+  for (auto &Loaded : AST.CI.getASTContext().LoadedModules) {
+    for (auto File : Loaded.second->getFiles()) {
+      if (auto LF = dyn_cast<LoadedFile>(File))
+        addFile(LF->getFilename());
+    }
+  }
+}
+
+/// Records the declaration which contained the code completion point, so that
+/// a following code completion request can reuse the AST.
+static bool recordCompletionDecl(CompletionAST &AST,
+                                 unsigned CodeCompletionOffset) {
+  auto Decl = AST.CI.getCodeCompletionDecl();
+  if (!Decl.hasValue())
+    return false;
+
+  auto &SM = AST.CI.getSourceMgr();
+  unsigned BufferID = SM.getCodeCompletionBufferID();
+  unsigned DeclStart =
+      SM.getLocOffsetInBuffer(Decl->BodyRange.Start, BufferID);
+  unsigned DeclEnd = SM.getLocOffsetInBuffer(Decl->BodyRange.End, BufferID);
+  if (DeclStart > CodeCompletionOffset || DeclEnd <= CodeCompletionOffset)
+    return false;
+
+  AST.decl = *Decl;
+  AST.declStart = DeclStart;
+  // Skip the code completion token.
+  AST.declEnd = DeclEnd - 1;
+  if (Decl->PreviousLoc.isValid())
+    AST.prevTokenOffset =
+        SM.getLocOffsetInBuffer(Decl->PreviousLoc, BufferID);
+  return true;
+}
+
 static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
                                   llvm::MemoryBuffer *UnresolvedInputFile,
                                   unsigned Offset,
@@ -131,22 +353,6 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
       UnresolvedInputFile->getBuffer(),
       Lang.resolvePathSymlinks(UnresolvedInputFile->getBufferIdentifier()));
 
-  CompilerInstance CI;
-  // Display diagnostics to stderr.
-  PrintingDiagnosticConsumer PrintDiags;
-  CI.addDiagnosticConsumer(&PrintDiags);
-
-  CompilerInvocation Invocation;
-  bool Failed = Lang.getASTManager().initCompilerInvocation(
-      Invocation, Args, CI.getDiags(), InputFile->getBufferIdentifier(), Error);
-  if (Failed) {
-    return false;
-  }
-  if (Invocation.getInputFilenames().empty()) {
-    Error = "no input filenames specified";
-    return false;
-  }
-
   auto origBuffSize = InputFile->getBufferSize();
   unsigned CodeCompletionOffset = Offset;
   if (CodeCompletionOffset > origBuffSize) {
@@ -162,6 +368,46 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
   *NewPos = '\0';
   std::copy(Position, InputFile->getBufferEnd(), NewPos+1);
 
+  // Consecutive completions are usually in the same function body. If nothing
+  // else changed, reuse the AST of the previous request.
+  auto &ASTCache = Lang.getCodeCompletionASTCache();
+  std::unique_ptr<CompletionAST> AST = ASTCache.take();
+  if (AST) {
+    if (auto DeclEnd = canReuseCompletionAST(
+            *AST, InputFile->getBufferIdentifier(), InputFile->getBuffer(),
+            CodeCompletionOffset, Args)) {
+      TracedOp.finish();
+      auto ReuseBuffer = llvm::MemoryBuffer::getMemBufferCopy(
+          NewBuffer->getBuffer(), NewBuffer->getBufferIdentifier());
+      if (reuseCompletionAST(*AST, std::move(ReuseBuffer),
+                             CodeCompletionOffset, *DeclEnd, Lang,
+                             SwiftConsumer)) {
+        AST->text = InputFile->getBuffer();
+        AST->declEnd = *DeclEnd;
+        ASTCache.set(std::move(AST));
+        return true;
+      }
+      // The edit moved the end of the declaration, e.g. by closing it and
+      // starting a new one. Build a new AST.
+    }
+  }
+
+  AST.reset(new CompletionAST);
+  CompilerInstance &CI = AST->CI;
+  // Display diagnostics to stderr.
+  CI.addDiagnosticConsumer(&AST->printDiags);
+
+  CompilerInvocation &Invocation = AST->invocation;
+  bool Failed = Lang.getASTManager().initCompilerInvocation(
+      Invocation, Args, CI.getDiags(), InputFile->getBufferIdentifier(), Error);
+  if (Failed) {
+    return false;
+  }
+  if (Invocation.getInputFilenames().empty()) {
+    Error = "no input filenames specified";
+    return false;
+  }
+
   Invocation.setCodeCompletionPoint(NewBuffer.get(), CodeCompletionOffset);
 
   auto swiftCache = Lang.getCodeCompletionCache(); // Pin the cache.
@@ -204,12 +450,25 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
                       std::to_string(CodeCompletionOffset))});
   }
 
-  CloseClangModuleFiles scopedCloseFiles(
-      *CI.getASTContext().getClangModuleLoader());
-  SwiftConsumer.setContext(&CI.getASTContext(), &Invocation,
-                           &CompletionContext);
-  CI.performSema();
-  SwiftConsumer.clearContext();
+  {
+    CloseClangModuleFiles scopedCloseFiles(
+        *CI.getASTContext().getClangModuleLoader());
+    SwiftConsumer.setContext(&CI.getASTContext(), &Invocation,
+                             &CompletionContext);
+    CI.performSema();
+    SwiftConsumer.clearContext();
+  }
+
+  // The factory only lives for this request.
+  Invocation.setCodeCompletionFactory(nullptr);
+  if (recordCompletionDecl(*AST, CodeCompletionOffset)) {
+    for (auto Arg : Args)
+      AST->args.push_back(Arg);
+    AST->text = InputFile->getBuffer();
+    AST->inputBuffer = std::move(NewBuffer);
+    recordCompletionASTFiles(*AST, InputFile->getBufferIdentifier());
+    ASTCache.set(std::move(AST));
+  }
   return true;
 }
 
@@ -27,6 +27,7 @@
 #include "swift/Sema/IDETypeChecking.h"
 #include "swift/Config.h"
 
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
@@ -53,6 +54,10 @@ namespace {
 struct TextRange {
   unsigned Offset;
   unsigned Length;
+
+  bool contains(unsigned Pos) const {
+    return Pos >= Offset && Pos - Offset < Length;
+  }
 };
 
 struct TextEntity {
@@ -375,20 +380,47 @@ static void reportDocEntities(ASTContext &Ctx,
   }
 }
 
+/// Reports the top-level \p Entities that start in \p Range.
+static void reportDocEntities(ASTContext &Ctx,
+                              ArrayRef<TextEntity> Entities,
+                              TextRange Range,
+                              DocInfoConsumer &Consumer) {
+  // Top-level entities are in the order of the text.
+  auto Begin = std::lower_bound(Entities.begin(), Entities.end(), Range.Offset,
+    [](const TextEntity &Entity, unsigned Offset) {
+      return Entity.Range.Offset < Offset;
+    });
+  auto End = Begin;
+  while (End != Entities.end() && Range.contains(End->Range.Offset))
+    ++End;
+  reportDocEntities(Ctx, llvm::makeArrayRef(Begin, End), Consumer);
+}
+
+/// Returns the part of a text of \p TextLength bytes that a request asked
+/// for, or all of it.
+static TextRange getReportedRange(Optional<std::pair<unsigned, unsigned>> Range,
+                                  unsigned TextLength) {
+  if (!Range)
+    return TextRange{ 0, TextLength };
+  unsigned Offset = std::min(Range->first, TextLength);
+  return TextRange{ Offset, std::min(Range->second, TextLength - Offset) };
+}
+
 namespace {
 class DocSyntaxWalker : public SyntaxModelWalker {
   SourceManager &SM;
   unsigned BufferID;
   ArrayRef<TextReference> References;
-  DocInfoConsumer &Consumer;
+  std::vector<DocEntityInfo> &Annotations;
   SourceLoc LastArgLoc;
   SourceLoc LastParamLoc;
 
 public:
   DocSyntaxWalker(SourceManager &SM, unsigned BufferID,
                   ArrayRef<TextReference> References,
-                  DocInfoConsumer &Consumer)
-    : SM(SM), BufferID(BufferID), References(References), Consumer(Consumer) {}
+                  std::vector<DocEntityInfo> &Annotations)
+    : SM(SM), BufferID(BufferID), References(References),
+      Annotations(Annotations) {}
 
   bool walkToNodePre(SyntaxNode Node) override {
     unsigned Offset = SM.getLocOffsetInBuffer(Node.Range.getStart(), BufferID);
@@ -434,7 +466,7 @@ public:
     Info.Kind = SwiftLangSupport::getUIDForSyntaxNodeKind(Node.Kind);
     Info.Offset = Offset;
     Info.Length = Length;
-    Consumer.handleAnnotation(Info);
+    Annotations.push_back(std::move(Info));
     return true;
   }
 
@@ -457,7 +489,7 @@ public:
         Info.Kind = Kind;
         Info.Offset = Offset;
         Info.Length = Length;
-        Consumer.handleAnnotation(Info);
+        Annotations.push_back(std::move(Info));
       };
 
       // Argument
@@ -486,7 +518,7 @@ private:
       Info.Offset = Ref.Range.Offset;
       Info.Length = Ref.Range.Length;
       Info.Ty = Ref.Ty;
-      Consumer.handleAnnotation(Info);
+      Annotations.push_back(std::move(Info));
     }
   }
 };
@@ -641,9 +673,9 @@ static void addParameterEntities(CompilerInstance &CI,
   }
 }
 
-static void reportSourceAnnotations(const SourceTextInfo &IFaceInfo,
-                                    CompilerInstance &CI,
-                                    DocInfoConsumer &Consumer) {
+static void collectSourceAnnotations(const SourceTextInfo &IFaceInfo,
+                                     CompilerInstance &CI,
+                                     std::vector<DocEntityInfo> &Annotations) {
   for (auto Unit : CI.getMainModule()->getFiles()) {
     auto SF = dyn_cast<SourceFile>(Unit);
     if (!SF)
@@ -651,12 +683,21 @@ static void reportSourceAnnotations(const SourceTextInfo &IFaceInfo,
 
     SyntaxModelContext SyntaxContext(*SF);
     DocSyntaxWalker SyntaxWalker(CI.getSourceMgr(), *SF->getBufferID(),
-                                 IFaceInfo.References, Consumer);
+                                 IFaceInfo.References, Annotations);
     SyntaxContext.walk(SyntaxWalker);
     SyntaxWalker.finished();
   }
 }
 
+static void reportSourceAnnotations(ArrayRef<DocEntityInfo> Annotations,
+                                    TextRange Range,
+                                    DocInfoConsumer &Consumer) {
+  for (auto &Info : Annotations) {
+    if (Range.contains(Info.Offset))
+      Consumer.handleAnnotation(Info);
+  }
+}
+
 static bool getModuleInterfaceInfo(ASTContext &Ctx, StringRef ModuleName,
                                    SourceTextInfo &Info) {
   // Load standard library so that Clang importer can use it.
@@ -684,34 +725,127 @@ static bool getModuleInterfaceInfo(ASTContext &Ctx, StringRef ModuleName,
   return false;
 }
 
-static bool reportModuleDocInfo(CompilerInvocation Invocation,
-                                StringRef ModuleName,
-                                DocInfoConsumer &Consumer) {
-  CompilerInstance CI;
+namespace SourceKit {
+/// The printed interface of a module, with everything that is needed to
+/// report its doc info.
+struct ModuleDocInfo {
+  /// The module name and the compiler arguments of the request.
+  std::string Key;
+  /// The files of the module, with their modification times when the
+  /// interface was printed.
+  std::vector<std::pair<std::string, llvm::sys::TimeValue>> Files;
+
   // Display diagnostics to stderr.
   PrintingDiagnosticConsumer PrintDiags;
-  CI.addDiagnosticConsumer(&PrintDiags);
+  CompilerInstance CI;
+  OwnedResolver TypeResolver{ nullptr, nullptr };
+  CompilerInstance ParseCI;
+  SourceTextInfo IFaceInfo;
+  std::vector<DocEntityInfo> Annotations;
+
+  /// Returns true if one of the module files changed since the interface was
+  /// printed.
+  bool isStale() const {
+    for (auto &File : Files) {
+      llvm::sys::fs::file_status Status;
+      if (llvm::sys::fs::status(File.first, Status) ||
+          Status.getLastModificationTime() != File.second)
+        return true;
+    }
+    return false;
+  }
+};
+} // end namespace SourceKit
+
+SwiftModuleDocInfoCache::SwiftModuleDocInfoCache() {}
+SwiftModuleDocInfoCache::~SwiftModuleDocInfoCache() {}
 
+std::unique_ptr<ModuleDocInfo> SwiftModuleDocInfoCache::take() {
+  llvm::sys::ScopedLock L(Mtx);
+  return std::move(Info);
+}
+
+void SwiftModuleDocInfoCache::set(std::unique_ptr<ModuleDocInfo> NewInfo) {
+  llvm::sys::ScopedLock L(Mtx);
+  Info = std::move(NewInfo);
+}
+
+static std::string getModuleDocInfoKey(StringRef ModuleName,
+                                       ArrayRef<const char *> Args) {
+  std::string Key = ModuleName.str();
+  for (auto Arg : Args) {
+    Key += '\0';
+    Key += Arg;
+  }
+  return Key;
+}
+
+static std::unique_ptr<ModuleDocInfo>
+createModuleDocInfo(const CompilerInvocation &Invocation, StringRef ModuleName,
+                    std::string Key) {
+  std::unique_ptr<ModuleDocInfo> Info(new ModuleDocInfo());
+  Info->Key = std::move(Key);
+
+  CompilerInstance &CI = Info->CI;
+  CI.addDiagnosticConsumer(&Info->PrintDiags);
   if (CI.setup(Invocation))
-    return true;
+    return nullptr;
 
   ASTContext &Ctx = CI.getASTContext();
   // Setup a typechecker for protocol conformance resolving.
-  OwnedResolver TypeResolver = createLazyResolver(Ctx);
+  Info->TypeResolver = createLazyResolver(Ctx);
 
-  SourceTextInfo IFaceInfo;
-  if (getModuleInterfaceInfo(Ctx, ModuleName, IFaceInfo))
-    return true;
+  if (getModuleInterfaceInfo(Ctx, ModuleName, Info->IFaceInfo))
+    return nullptr;
+  for (auto File : getModuleByFullName(Ctx, ModuleName)->getFiles()) {
+    auto LF = dyn_cast<LoadedFile>(File);
+    if (!LF)
+      continue;
+    StringRef Filename = LF->getFilename();
+    llvm::sys::fs::file_status Status;
+    if (Filename.empty() || llvm::sys::fs::status(Filename, Status))
+      continue;
+    Info->Files.emplace_back(Filename, Status.getLastModificationTime());
+  }
 
-  CompilerInstance ParseCI;
-  if (makeParserAST(ParseCI, IFaceInfo.Text))
+  if (makeParserAST(Info->ParseCI, Info->IFaceInfo.Text))
+    return nullptr;
+  addParameterEntities(Info->ParseCI, Info->IFaceInfo);
+  collectSourceAnnotations(Info->IFaceInfo, Info->ParseCI, Info->Annotations);
+  return Info;
+}
+
+static bool reportModuleDocInfo(const CompilerInvocation &Invocation,
+                                StringRef ModuleName,
+                                ArrayRef<const char *> Args,
+                                Optional<std::pair<unsigned, unsigned>> Range,
+                                SwiftModuleDocInfoCache &Cache,
+                                DocInfoConsumer &Consumer) {
+  // Printing the interface of a large module takes much longer than reporting
+  // a page of it, so paged requests reuse the interface of the previous
+  // request. A request for the whole interface doesn't need it afterwards.
+  bool IsPaged = Range.hasValue();
+  std::string Key = getModuleDocInfoKey(ModuleName, Args);
+  std::unique_ptr<ModuleDocInfo> Info;
+  if (IsPaged)
+    Info = Cache.take();
+  if (!Info || Info->Key != Key || Info->isStale())
+    Info = createModuleDocInfo(Invocation, ModuleName, std::move(Key));
+  if (!Info)
     return true;
-  addParameterEntities(ParseCI, IFaceInfo);
-  
-  Consumer.handleSourceText(IFaceInfo.Text);
-  reportDocEntities(Ctx, IFaceInfo.TopEntities, Consumer);
-  reportSourceAnnotations(IFaceInfo, ParseCI, Consumer);
 
+  const SourceTextInfo &IFaceInfo = Info->IFaceInfo;
+  TextRange ReportedRange = getReportedRange(Range, IFaceInfo.Text.size());
+  Consumer.handleSourceText(StringRef(IFaceInfo.Text).substr(
+      ReportedRange.Offset, ReportedRange.Length));
+  reportDocEntities(Info->CI.getASTContext(), IFaceInfo.TopEntities,
+                    ReportedRange, Consumer);
+  reportSourceAnnotations(Info->Annotations, ReportedRange, Consumer);
+
+  // Keep the interface for the next page, unless this was the last one.
+  if (IsPaged &&
+      ReportedRange.Offset + ReportedRange.Length < IFaceInfo.Text.size())
+    Cache.set(std::move(Info));
   return false;
 }
 
@@ -802,6 +936,7 @@ static bool getSourceTextInfo(CompilerInstance &CI,
 
 static bool reportSourceDocInfo(CompilerInvocation Invocation,
                                 llvm::MemoryBuffer *InputBuf,
+                                Optional<std::pair<unsigned, unsigned>> Range,
                                 DocInfoConsumer &Consumer) {
   CompilerInstance CI;
   // Display diagnostics to stderr.
@@ -827,12 +962,17 @@ static bool reportSourceDocInfo(CompilerInvocation Invocation,
   if (getSourceTextInfo(CI, SourceInfo))
     return true;
   addParameterEntities(CI, SourceInfo);
+  std::vector<DocEntityInfo> Annotations;
+  collectSourceAnnotations(SourceInfo, CI, Annotations);
 
-  reportDocEntities(Ctx, SourceInfo.TopEntities, Consumer);
-  reportSourceAnnotations(SourceInfo, CI, Consumer);
+  TextRange ReportedRange = getReportedRange(Range, SourceInfo.Text.size());
+  reportDocEntities(Ctx, SourceInfo.TopEntities, ReportedRange, Consumer);
+  reportSourceAnnotations(Annotations, ReportedRange, Consumer);
   for (auto &Diag : DiagConsumer.getDiagnosticsForBuffer(
-                                                CI.getInputBufferIDs().back()))
-    Consumer.handleDiagnostic(Diag);
+                                                CI.getInputBufferIDs().back())) {
+    if (!Range || ReportedRange.contains(Diag.Offset))
+      Consumer.handleDiagnostic(Diag);
+  }
 
   return false;
 }
@@ -840,6 +980,7 @@ static bool reportSourceDocInfo(CompilerInvocation Invocation,
 void SwiftLangSupport::getDocInfo(llvm::MemoryBuffer *InputBuf,
                                   StringRef ModuleName,
                                   ArrayRef<const char *> Args,
+                                  Optional<std::pair<unsigned, unsigned>> Range,
                                   DocInfoConsumer &Consumer) {
   CompilerInstance CI;
   // Display diagnostics to stderr.
@@ -859,13 +1000,14 @@ void SwiftLangSupport::getDocInfo(llvm::MemoryBuffer *InputBuf,
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
   if (!ModuleName.empty()) {
-    bool Error = reportModuleDocInfo(Invocation, ModuleName, Consumer);
+    bool Error = reportModuleDocInfo(Invocation, ModuleName, Args, Range,
+                                     getModuleDocInfoCache(), Consumer);
     if (Error)
       Consumer.failed("Error occurred");
     return;
   }
 
-  Failed = reportSourceDocInfo(Invocation, InputBuf, Consumer);
+  Failed = reportSourceDocInfo(Invocation, InputBuf, Range, Consumer);
   if (Failed)
     Consumer.failed("Error occurred");
 }
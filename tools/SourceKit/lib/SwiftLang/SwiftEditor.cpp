@@ -32,10 +32,15 @@
 #include "swift/IDE/CommentConversion.h"
 #include "swift/IDE/SyntaxModel.h"
 #include "swift/IDE/SourceEntityWalker.h"
+#include "swift/Parse/Lexer.h"
 #include "swift/Subsystems.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/SaveAndRestore.h"
 
 using namespace SourceKit;
 using namespace swift;
@@ -431,6 +436,12 @@ struct SwiftSemanticToken {
 };
 static_assert(sizeof(SwiftSemanticToken) == 8, "Too big");
 
+/// The semantic tokens of groups of top-level declarations, keyed by a hash of
+/// the text of the group and of the interfaces of the files of the module.
+/// The offsets of the tokens are relative to the start of the group.
+typedef llvm::DenseMap<uint64_t, std::vector<SwiftSemanticToken>>
+  DeclGroupTokenMap;
+
 class SwiftDocumentSemanticInfo :
     public ThreadSafeRefCountedBase<SwiftDocumentSemanticInfo> {
 
@@ -447,6 +458,8 @@ class SwiftDocumentSemanticInfo :
   ImmutableTextSnapshotRef DiagSnapshot;
   std::vector<DiagnosticEntryInfo> SemaDiags;
 
+  DeclGroupTokenMap DeclGroupTokens;
+
   mutable llvm::sys::Mutex Mtx;
 
 public:
@@ -463,6 +476,18 @@ public:
 
   void setCompilerArgs(ArrayRef<const char *> Args) {
     InvokRef = ASTMgr.getInvocation(Args, Filename, CompilerArgsError);
+    setDeclGroupTokens(DeclGroupTokenMap());
+  }
+
+  /// Takes the semantic tokens of the top-level declarations of the last
+  /// annotated AST.
+  DeclGroupTokenMap takeDeclGroupTokens() {
+    llvm::sys::ScopedLock L(Mtx);
+    return std::move(DeclGroupTokens);
+  }
+  void setDeclGroupTokens(DeclGroupTokenMap Tokens) {
+    llvm::sys::ScopedLock L(Mtx);
+    DeclGroupTokens = std::move(Tokens);
   }
 
   void readSemanticInfo(ImmutableTextSnapshotRef NewSnapshot,
@@ -539,6 +564,10 @@ public:
       TracedOp.start(trace::OperationKind::SimpleParse, Info);
     }
     
+    // Record the interface tokens, like a regular parse of a source file does.
+    // The interface hash tells if an edit can affect other files.
+    llvm::SaveAndRestore<bool> S(P.IsParsingInterfaceTokens, true);
+
     bool Done = false;
     while (!Done) {
       P.parseTopLevel();
@@ -550,6 +579,13 @@ public:
     return Parser->getSourceFile();
   }
 
+  /// Returns the hash of the interface-contributing tokens of the file. The
+  /// hash does not change for edits of whitespace, comments or function
+  /// bodies.
+  void getInterfaceHash(llvm::SmallString<32> &Hash) {
+    getSourceFile().getInterfaceHash(Hash);
+  }
+
   unsigned getBufferID() {
     return BufferID;
   }
@@ -847,6 +883,126 @@ public:
 
 } // anonymous namespace
 
+/// Returns a hash of the interfaces of all source files of \p M.
+///
+/// The interface of a file doesn't include function bodies, so it only
+/// changes if a declaration that a reference may resolve to changes.
+static llvm::hash_code getModuleInterfaceHash(Module &M) {
+  llvm::hash_code Hash = 0;
+  for (auto File : M.getFiles()) {
+    auto SF = dyn_cast<SourceFile>(File);
+    if (!SF)
+      continue;
+    // Finalize a copy, the hash of the file must stay usable.
+    llvm::MD5 State = SF->getInterfaceHashState();
+    llvm::MD5::MD5Result Result;
+    State.final(Result);
+    SmallString<32> ResultStr;
+    llvm::MD5::stringifyResult(Result, ResultStr);
+    Hash = llvm::hash_combine(Hash, ResultStr.str());
+  }
+  return Hash;
+}
+
+/// Returns true if \p D is a top-level declaration which is left out of the
+/// interface hash of its file, see IgnorePrivateDeclTokens in the parser.
+static bool isExcludedFromInterfaceHash(Decl *D) {
+  auto *Attr = D->getAttrs().getAttribute<AbstractAccessibilityAttr>();
+  return Attr && Attr->getAccess() == Accessibility::Private;
+}
+
+/// Annotates the source file \p SF.
+///
+/// The top-level declarations are split into groups of non-overlapping text
+/// ranges, which also cover the text between the declarations. The tokens of
+/// a group only change if its text changes or if a declaration it may refer to
+/// changes. The latter is covered by the interface of the module, the text of
+/// the private top-level declarations of \p SF and the stamps of the modules
+/// and headers in \p DependencyStamps. The groups found in \p Cache aren't
+/// walked again. On return, \p Cache contains the tokens of the groups of
+/// \p SF.
+static std::vector<SwiftSemanticToken>
+annotateSourceFile(SourceFile &SF, unsigned BufferID,
+                   ArrayRef<std::pair<std::string, uint64_t>> DependencyStamps,
+                   DeclGroupTokenMap &Cache) {
+  SourceManager &SM = SF.getASTContext().SourceMgr;
+  StringRef Text = SM.getEntireTextForBuffer(BufferID);
+
+  struct DeclGroup {
+    unsigned Start;
+    unsigned End;
+    SmallVector<Decl *, 1> Decls;
+    bool HasPrivateDecl;
+  };
+  SmallVector<DeclGroup, 64> Groups;
+  for (Decl *D : SF.Decls) {
+    SourceRange Range = D->getSourceRange();
+    if (Range.isInvalid()) {
+      // An implicit declaration, which doesn't have tokens of its own.
+      if (Groups.empty())
+        Groups.push_back({ 0, 0, {}, false });
+      Groups.back().Decls.push_back(D);
+      continue;
+    }
+    bool IsPrivate = isExcludedFromInterfaceHash(D);
+
+    CharSourceRange CharRange =
+        Lexer::getCharSourceRangeFromSourceRange(SM, Range);
+    unsigned Start = SM.getLocOffsetInBuffer(CharRange.getStart(), BufferID);
+    unsigned End = SM.getLocOffsetInBuffer(CharRange.getEnd(), BufferID);
+    if (!Groups.empty() && Start < Groups.back().End) {
+      // E.g. the variables of a pattern binding.
+      Groups.back().End = std::max(Groups.back().End, End);
+      Groups.back().Decls.push_back(D);
+      Groups.back().HasPrivateDecl |= IsPrivate;
+      continue;
+    }
+    unsigned GroupStart = Groups.empty() ? 0 : Groups.back().End;
+    Groups.push_back({ GroupStart, End, { D }, IsPrivate });
+  }
+
+  // A reference may resolve to a declaration of another group, of another
+  // file or of an imported module.
+  llvm::hash_code ContextHash = getModuleInterfaceHash(*SF.getParentModule());
+  for (auto &Group : Groups) {
+    if (Group.HasPrivateDecl)
+      ContextHash = llvm::hash_combine(ContextHash,
+                                       Text.slice(Group.Start, Group.End));
+  }
+  for (auto &Dependency : DependencyStamps)
+    ContextHash = llvm::hash_combine(ContextHash, Dependency.first,
+                                     Dependency.second);
+
+  std::vector<SwiftSemanticToken> SemaToks;
+  DeclGroupTokenMap NewCache;
+  for (auto &Group : Groups) {
+    uint64_t Key = llvm::hash_combine(ContextHash,
+                                      Text.slice(Group.Start, Group.End));
+    auto Found = Cache.find(Key);
+    if (Found == Cache.end()) {
+      SemanticAnnotator Annotator(SM, BufferID);
+      for (Decl *D : Group.Decls)
+        Annotator.walk(D);
+      std::vector<SwiftSemanticToken> GroupToks;
+      for (auto Tok : Annotator.SemaToks) {
+        Tok.ByteOffset -= Group.Start;
+        GroupToks.push_back(Tok);
+      }
+      Found = Cache.insert(std::make_pair(Key, std::move(GroupToks))).first;
+    }
+
+    for (auto Tok : Found->second) {
+      Tok.ByteOffset += Group.Start;
+      SemaToks.push_back(Tok);
+    }
+    NewCache[Key] = std::move(Found->second);
+    Cache.erase(Found);
+  }
+
+  Cache = std::move(NewCache);
+  return SemaToks;
+}
+
 namespace {
 
 class AnnotAndDiagASTConsumer : public SwiftASTConsumer {
@@ -915,9 +1071,11 @@ public:
       TracedOp.start(trace::OperationKind::AnnotAndDiag, SwiftArgs);
     }
 
-    SemanticAnnotator Annotator(CompIns.getSourceMgr(), BufferID);
-    Annotator.walk(AstUnit->getPrimarySourceFile());
-    SemaToks = std::move(Annotator.SemaToks);
+    auto DeclGroupTokens = SemaInfoRef->takeDeclGroupTokens();
+    SemaToks = annotateSourceFile(AstUnit->getPrimarySourceFile(), BufferID,
+                                  AstUnit->getDependencyStamps(),
+                                  DeclGroupTokens);
+    SemaInfoRef->setDeclGroupTokens(std::move(DeclGroupTokens));
 
     TracedOp.finish();
 
@@ -976,6 +1134,14 @@ struct SwiftEditorDocument::Implementation {
 
   std::shared_ptr<SwiftDocumentSyntaxInfo> SyntaxInfo;
 
+  /// The interface hash of the document when the semantic info of the other
+  /// open documents of the module was last updated.
+  llvm::SmallString<32> DependentsInterfaceHash;
+
+  /// True if there was an edit which requested semantic info since the
+  /// semantic info of the other open documents was last updated.
+  bool HasEditForDependents = false;
+
   std::shared_ptr<SwiftDocumentSyntaxInfo> getSyntaxInfo() {
     llvm::sys::ScopedLock L(AccessMtx);
     return SyntaxInfo;
@@ -989,6 +1155,8 @@ struct SwiftEditorDocument::Implementation {
   }
 
   void buildSwiftInv(trace::SwiftInvocation &Inv);
+
+  void updateSemaInfoOfDependents(SwiftEditorDocument *EditedDoc);
 };
 
 void SwiftEditorDocument::Implementation::buildSwiftInv(
@@ -1004,6 +1172,24 @@ void SwiftEditorDocument::Implementation::buildSwiftInv(
   Inv.Files.push_back(std::make_pair(FilePath, Text));
 }
 
+void SwiftEditorDocument::Implementation::updateSemaInfoOfDependents(
+    SwiftEditorDocument *EditedDoc) {
+  auto Invok = SemanticInfo->getInvocation();
+  if (!Invok)
+    return;
+
+  // Update semantic info for open editor documents of the same module.
+  CompilerInvocation CI;
+  Invok->applyTo(CI);
+  auto &EditorDocs = LangSupport.getEditorDocuments();
+  for (auto &Input : CI.getInputFilenames()) {
+    if (auto EditorDoc = EditorDocs.findByPath(Input)) {
+      if (EditorDoc.get() != EditedDoc)
+        EditorDoc->updateSemaInfo();
+    }
+  }
+}
+
 namespace  {
 
 static UIdent getAccessibilityUID(Accessibility Access) {
@@ -1354,15 +1540,26 @@ public:
 
     ++NestingLevel;
     SourceLoc StartLoc = Node.Range.getStart();
+    unsigned Offset = SrcManager.getByteDistance(
+                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
+    // Note that the length can span multiple lines.
+    unsigned Length = Node.Range.getByteLength();
+
+    // On an edit, most nodes are outside of the affected range. Skip them
+    // based on their byte offsets, before doing the more expensive line
+    // lookups. The affected range always starts at the beginning of the first
+    // edited line, so a node which ends before it is entirely before the
+    // edited line range.
+    if (EditedLineRange.isValid() &&
+        (Offset + Length <= AffectedRange.first ||
+         Offset > AffectedRange.first + AffectedRange.second))
+      return true;
+
     auto StartLineAndColumn = SrcManager.getLineAndColumn(StartLoc);
     auto EndLineAndColumn = SrcManager.getLineAndColumn(Node.Range.getEnd());
     unsigned StartLine = StartLineAndColumn.first;
     unsigned EndLine = EndLineAndColumn.second > 1 ? EndLineAndColumn.first
                                                    : EndLineAndColumn.first - 1;
-    unsigned Offset = SrcManager.getByteDistance(
-                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
-    // Note that the length can span multiple lines.
-    unsigned Length = Node.Range.getByteLength();
 
     SwiftSyntaxToken Token(StartLineAndColumn.second, Length,
                            Node.Kind);
@@ -2442,6 +2639,8 @@ ImmutableTextSnapshotRef SwiftEditorDocument::initializeText(
   Impl.SemanticInfo =
       new SwiftDocumentSemanticInfo(Impl.FilePath, Impl.LangSupport);
   Impl.SemanticInfo->setCompilerArgs(Args);
+  Impl.DependentsInterfaceHash.clear();
+  Impl.HasEditForDependents = false;
   return Impl.EditableBuffer->getSnapshot();
 }
 
@@ -2460,20 +2659,10 @@ ImmutableTextSnapshotRef SwiftEditorDocument::replaceText(
     if (Length != 0 || Buf->getBufferSize() != 0) {
       updateSemaInfo();
 
-      if (auto Invok = Impl.SemanticInfo->getInvocation()) {
-        // Update semantic info for open editor documents of the same module.
-        // FIXME: Detect edits that don't affect other files, e.g. whitespace,
-        // comments, inside a function body, etc.
-        CompilerInvocation CI;
-        Invok->applyTo(CI);
-        auto &EditorDocs = Impl.LangSupport.getEditorDocuments();
-        for (auto &Input : CI.getInputFilenames()) {
-          if (auto EditorDoc = EditorDocs.findByPath(Input)) {
-            if (EditorDoc.get() != this)
-              EditorDoc->updateSemaInfo();
-          }
-        }
-      }
+      // The other open documents of the module are only updated if the edit
+      // changes the interface of this file. This is checked when the new
+      // snapshot is parsed.
+      Impl.HasEditForDependents = true;
     }
   }
 
@@ -2544,6 +2733,20 @@ void SwiftEditorDocument::parse(ImmutableTextSnapshotRef Snapshot,
     new SwiftDocumentSyntaxInfo(CompInv, Snapshot, Args, Impl.FilePath));
 
   Impl.SyntaxInfo->parse();
+
+  // Edits of whitespace, comments or function bodies don't change the
+  // interface hash and can't affect other files.
+  llvm::SmallString<32> InterfaceHash;
+  Impl.SyntaxInfo->getInterfaceHash(InterfaceHash);
+  if (Impl.DependentsInterfaceHash.empty()) {
+    // This is the initial parse of the document.
+    Impl.DependentsInterfaceHash = InterfaceHash;
+  } else if (Impl.HasEditForDependents &&
+             Impl.DependentsInterfaceHash != InterfaceHash) {
+    Impl.updateSemaInfoOfDependents(this);
+    Impl.DependentsInterfaceHash = InterfaceHash;
+  }
+  Impl.HasEditForDependents = false;
 }
 
 void SwiftEditorDocument::readSyntaxInfo(EditorConsumer &Consumer) {
@@ -84,6 +84,301 @@ public:
   }
 };
 
+} // anonymous namespace
+
+namespace SourceKit {
+/// Everything that was reported when indexing a module file: its hash, its
+/// dependencies and its symbols, in the order in which they were reported.
+///
+/// The strings of all events are kept in a single buffer, which keeps the
+/// memory cost of large modules like Foundation low.
+struct RecordedModuleIndex {
+  /// A string in \c Strings.
+  struct StringSlice {
+    unsigned Offset;
+    unsigned Length;
+  };
+
+  struct DependencyEvent {
+    bool IsStart;
+    UIdent Kind;
+    StringSlice Name;
+    StringSlice Path;
+    bool IsSystem;
+    StringSlice Hash;
+  };
+
+  struct Event {
+    enum EventKind { StartEntity, RelatedEntity, FinishEntity };
+    EventKind Kind;
+    EntityInfo::TypeKind EntityType;
+    UIdent EntityKind;
+    StringSlice Name;
+    StringSlice USR;
+    unsigned Line;
+    unsigned Column;
+    bool IsTestCandidate;
+    StringSlice ReceiverUSR;
+    bool IsDynamic;
+  };
+
+  /// The size and modification time of a file that the module hash covers.
+  struct FileStamp {
+    std::string Path;
+    bool Exists;
+    uint64_t Size;
+    uint64_t ModTime;
+
+    bool operator==(const FileStamp &Other) const {
+      return Path == Other.Path && Exists == Other.Exists &&
+             Size == Other.Size && ModTime == Other.ModTime;
+    }
+  };
+
+  std::string Strings;
+  std::string Hash;
+  std::vector<DependencyEvent> Dependencies;
+  std::vector<Event> Events;
+  std::vector<FileStamp> Files;
+
+  StringSlice addString(StringRef Str) {
+    StringSlice Slice{ unsigned(Strings.size()), unsigned(Str.size()) };
+    Strings.append(Str.begin(), Str.end());
+    return Slice;
+  }
+  StringRef getString(StringSlice Slice) const {
+    return StringRef(Strings.data() + Slice.Offset, Slice.Length);
+  }
+
+  void recordDependency(UIdent Kind, StringRef Name, StringRef Path,
+                        bool IsSystem, StringRef Hash);
+  void recordDependencyEnd(UIdent Kind);
+  void record(Event::EventKind Kind, const EntityInfo &Info);
+  void record(UIdent FinishedKind);
+
+  /// Returns false if one of the files that the hash covers changed since it
+  /// was recorded.
+  bool isUpToDate() const;
+
+  /// The approximate number of bytes that the recorded index uses.
+  size_t getMemorySize() const;
+
+  /// Reports the recorded index to \p Consumer, like indexing the module
+  /// with \p KnownHash. Returns false if the consumer cancelled.
+  bool report(IndexingConsumer &Consumer, StringRef KnownHash) const;
+};
+} // end namespace SourceKit
+
+static RecordedModuleIndex::FileStamp getFileStamp(StringRef Path) {
+  // This matches the file information that hashFileReference() hashes.
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(Path, Status))
+    return { Path, false, 0, 0 };
+  return { Path, true, Status.getSize(),
+           Status.getLastModificationTime().toEpochTime() };
+}
+
+void RecordedModuleIndex::recordDependency(UIdent Kind, StringRef Name,
+                                           StringRef Path, bool IsSystem,
+                                           StringRef Hash) {
+  Dependencies.push_back({ true, Kind, addString(Name), addString(Path),
+                           IsSystem, addString(Hash) });
+}
+
+void RecordedModuleIndex::recordDependencyEnd(UIdent Kind) {
+  Dependencies.push_back({ false, Kind, StringSlice(), StringSlice(), false,
+                           StringSlice() });
+}
+
+void RecordedModuleIndex::record(Event::EventKind Kind,
+                                 const EntityInfo &Info) {
+  Event E{ Kind, Info.EntityType, Info.Kind, addString(Info.Name),
+           addString(Info.USR), Info.Line, Info.Column, false, StringSlice(),
+           false };
+  if (Info.EntityType == EntityInfo::FuncDecl) {
+    auto &FuncInfo = static_cast<const FuncDeclEntityInfo &>(Info);
+    E.IsTestCandidate = FuncInfo.IsTestCandidate;
+  } else if (Info.EntityType == EntityInfo::CallReference) {
+    auto &CallInfo = static_cast<const CallRefEntityInfo &>(Info);
+    E.ReceiverUSR = addString(CallInfo.ReceiverUSR);
+    E.IsDynamic = CallInfo.IsDynamic;
+  }
+  Events.push_back(E);
+}
+
+void RecordedModuleIndex::record(UIdent FinishedKind) {
+  Events.push_back({ Event::FinishEntity, EntityInfo::Base, FinishedKind,
+                     StringSlice(), StringSlice(), 0, 0, false, StringSlice(),
+                     false });
+}
+
+bool RecordedModuleIndex::isUpToDate() const {
+  for (auto &File : Files) {
+    if (!(getFileStamp(File.Path) == File))
+      return false;
+  }
+  return true;
+}
+
+size_t RecordedModuleIndex::getMemorySize() const {
+  size_t Size = sizeof(*this) + Strings.capacity() + Hash.capacity() +
+                Dependencies.capacity() * sizeof(DependencyEvent) +
+                Events.capacity() * sizeof(Event) +
+                Files.capacity() * sizeof(FileStamp);
+  for (auto &File : Files)
+    Size += File.Path.capacity();
+  return Size;
+}
+
+bool RecordedModuleIndex::report(IndexingConsumer &Consumer,
+                                 StringRef KnownHash) const {
+  bool HashIsKnown = Hash == KnownHash;
+  if (!Consumer.recordHash(Hash, HashIsKnown))
+    return false;
+
+  // The dependencies are always reported, even if the hash is known.
+  for (const DependencyEvent &D : Dependencies) {
+    bool Continue = D.IsStart
+        ? Consumer.startDependency(D.Kind, getString(D.Name),
+                                   getString(D.Path), D.IsSystem,
+                                   getString(D.Hash))
+        : Consumer.finishDependency(D.Kind);
+    if (!Continue)
+      return false;
+  }
+  if (HashIsKnown)
+    return true;
+
+  for (const Event &E : Events) {
+    if (E.Kind == Event::FinishEntity) {
+      if (!Consumer.finishSourceEntity(E.EntityKind))
+        return false;
+      continue;
+    }
+
+    FuncDeclEntityInfo FuncInfo;
+    CallRefEntityInfo CallInfo;
+    EntityInfo BaseInfo;
+    EntityInfo *Info = &BaseInfo;
+    if (E.EntityType == EntityInfo::FuncDecl) {
+      FuncInfo.IsTestCandidate = E.IsTestCandidate;
+      Info = &FuncInfo;
+    } else if (E.EntityType == EntityInfo::CallReference) {
+      CallInfo.ReceiverUSR = getString(E.ReceiverUSR);
+      CallInfo.IsDynamic = E.IsDynamic;
+      Info = &CallInfo;
+    }
+    Info->Kind = E.EntityKind;
+    Info->Name = getString(E.Name);
+    Info->USR = getString(E.USR);
+    Info->Line = E.Line;
+    Info->Column = E.Column;
+
+    bool Continue = E.Kind == Event::StartEntity
+                        ? Consumer.startSourceEntity(*Info)
+                        : Consumer.recordRelatedEntity(*Info);
+    if (!Continue)
+      return false;
+  }
+  return true;
+}
+
+std::shared_ptr<const RecordedModuleIndex>
+SwiftModuleIndexCache::get(StringRef Key) const {
+  llvm::sys::ScopedLock L(Mtx);
+  auto It = Indexes.find(Key);
+  if (It == Indexes.end())
+    return nullptr;
+  return It->second;
+}
+
+void SwiftModuleIndexCache::set(
+    StringRef Key, std::shared_ptr<const RecordedModuleIndex> Index) {
+  size_t Size = Index->getMemorySize();
+  if (Size > MaxSize)
+    return;
+
+  llvm::sys::ScopedLock L(Mtx);
+  auto It = Indexes.find(Key);
+  if (It != Indexes.end()) {
+    TotalSize -= It->second->getMemorySize();
+    Indexes.erase(It);
+    InsertionOrder.erase(std::find(InsertionOrder.begin(),
+                                   InsertionOrder.end(), Key));
+  }
+  while (TotalSize + Size > MaxSize) {
+    auto Oldest = Indexes.find(InsertionOrder.front());
+    TotalSize -= Oldest->second->getMemorySize();
+    Indexes.erase(Oldest);
+    InsertionOrder.erase(InsertionOrder.begin());
+  }
+  TotalSize += Size;
+  InsertionOrder.push_back(Key);
+  Indexes[Key] = std::move(Index);
+}
+
+namespace {
+
+/// Forwards everything to another consumer and records what was reported.
+class RecordingIndexingConsumer : public IndexingConsumer {
+  IndexingConsumer &Consumer;
+  RecordedModuleIndex &Record;
+  bool Incomplete = false;
+
+  bool forward(bool Continue) {
+    if (!Continue)
+      Incomplete = true;
+    return Continue;
+  }
+
+public:
+  RecordingIndexingConsumer(IndexingConsumer &Consumer,
+                            RecordedModuleIndex &Record)
+    : Consumer(Consumer), Record(Record) { }
+
+  /// Returns true if the symbols of the module were reported completely,
+  /// i.e. the hash wasn't known, nothing failed and nothing was cancelled.
+  bool isComplete() const { return !Incomplete; }
+
+  void failed(StringRef ErrDescription) override {
+    Incomplete = true;
+    Consumer.failed(ErrDescription);
+  }
+
+  bool recordHash(StringRef Hash, bool isKnown) override {
+    if (isKnown)
+      Incomplete = true;
+    Record.Hash = Hash;
+    return forward(Consumer.recordHash(Hash, isKnown));
+  }
+
+  bool startDependency(UIdent Kind, StringRef Name, StringRef Path,
+                       bool IsSystem, StringRef Hash) override {
+    Record.recordDependency(Kind, Name, Path, IsSystem, Hash);
+    return forward(Consumer.startDependency(Kind, Name, Path, IsSystem, Hash));
+  }
+
+  bool finishDependency(UIdent Kind) override {
+    Record.recordDependencyEnd(Kind);
+    return forward(Consumer.finishDependency(Kind));
+  }
+
+  bool startSourceEntity(const EntityInfo &Info) override {
+    Record.record(RecordedModuleIndex::Event::StartEntity, Info);
+    return forward(Consumer.startSourceEntity(Info));
+  }
+
+  bool recordRelatedEntity(const EntityInfo &Info) override {
+    Record.record(RecordedModuleIndex::Event::RelatedEntity, Info);
+    return forward(Consumer.recordRelatedEntity(Info));
+  }
+
+  bool finishSourceEntity(UIdent Kind) override {
+    Record.record(Kind);
+    return forward(Consumer.finishSourceEntity(Kind));
+  }
+};
+
 class IndexSwiftASTWalker : public ide::SourceEntityWalker {
   IndexingConsumer &IdxConsumer;
   SourceManager &SrcMgr;
@@ -103,8 +398,7 @@ public:
   IndexSwiftASTWalker(IndexingConsumer &IdxConsumer,
                       ASTContext &Ctx,
                       unsigned BufferID)
-    : IdxConsumer(IdxConsumer), SrcMgr(Ctx.SourceMgr),
-      BufferID(BufferID) {
+    : IdxConsumer(IdxConsumer), SrcMgr(Ctx.SourceMgr), BufferID(BufferID) {
   }
   ~IndexSwiftASTWalker() {
     assert(Cancelled || EntitiesStack.empty());
@@ -112,12 +406,17 @@ public:
 
   void visitModule(Module &Mod, StringRef Hash);
 
+  /// Collects the names of the files whose information the hash of module
+  /// file \p Mod is computed from.
+  void getHashedFilenames(Module &Mod, SmallVectorImpl<StringRef> &Filenames);
+
 private:
   bool visitImports(SourceFileOrModule Mod,
                     llvm::SmallPtrSet<Module *, 16> &Visited);
 
   bool handleSourceOrModuleFile(SourceFileOrModule SFOrMod,
-                                StringRef KnownHash, bool &HashIsKnown);
+                                StringRef KnownHash, bool &HashIsKnown,
+                                SmallVectorImpl<char> &Hash);
 
   bool walkToDeclPre(Decl *D, CharSourceRange Range) override {
     // Do not handle unavailable decls.
@@ -290,9 +589,10 @@ void IndexSwiftASTWalker::visitModule(Module &Mod, StringRef KnownHash) {
   }
 
   bool HashIsKnown;
+  SmallString<32> Hash;
   if (SrcFile != nullptr) {
     IsModuleFile = false;
-    if (!handleSourceOrModuleFile(*SrcFile, KnownHash, HashIsKnown))
+    if (!handleSourceOrModuleFile(*SrcFile, KnownHash, HashIsKnown, Hash))
       return;
     if (HashIsKnown)
       return; // No need to report symbols.
@@ -300,7 +600,7 @@ void IndexSwiftASTWalker::visitModule(Module &Mod, StringRef KnownHash) {
   } else {
     IsModuleFile = true;
     isSystemModule = Mod.isSystemModule();
-    if (!handleSourceOrModuleFile(Mod, KnownHash, HashIsKnown))
+    if (!handleSourceOrModuleFile(Mod, KnownHash, HashIsKnown, Hash))
       return;
     if (HashIsKnown)
       return; // No need to report symbols.
@@ -308,18 +608,30 @@ void IndexSwiftASTWalker::visitModule(Module &Mod, StringRef KnownHash) {
   }
 }
 
+void IndexSwiftASTWalker::getHashedFilenames(
+    Module &Mod, SmallVectorImpl<StringRef> &Filenames) {
+  // This matches the files that hashModule() hashes.
+  SmallVector<Module *, 16> Imports;
+  Imports.push_back(&Mod);
+  getRecursiveModuleImports(Mod, Imports);
+  for (auto Import : Imports) {
+    StringRef Filename = Import->getModuleFilename();
+    if (!Filename.empty())
+      Filenames.push_back(Filename);
+  }
+}
+
 bool IndexSwiftASTWalker::handleSourceOrModuleFile(SourceFileOrModule SFOrMod,
                                                StringRef KnownHash,
-                                               bool &HashIsKnown) {
+                                               bool &HashIsKnown,
+                                               SmallVectorImpl<char> &Hash) {
   // Common reporting for TU/module file.
 
-  SmallString<32> HashBuf;
   {
-    llvm::raw_svector_ostream HashOS(HashBuf);
+    llvm::raw_svector_ostream HashOS(Hash);
     getModuleHash(SFOrMod, HashOS);
-    StringRef Hash = HashOS.str();
-    HashIsKnown = Hash == KnownHash;
-    if (!IdxConsumer.recordHash(Hash, HashIsKnown))
+    HashIsKnown = HashOS.str() == KnownHash;
+    if (!IdxConsumer.recordHash(HashOS.str(), HashIsKnown))
       return false;
   }
 
@@ -956,7 +1268,9 @@ static void indexModule(llvm::MemoryBuffer *Input,
                         StringRef Hash,
                         IndexingConsumer &IdxConsumer,
                         CompilerInstance &CI,
-                        ArrayRef<const char *> Args) {
+                        ArrayRef<const char *> Args,
+                        SwiftModuleIndexCache &ModuleCache,
+                        StringRef CacheKey) {
   trace::TracedOperation TracedOp;
   if (trace::enabled()) {
     trace::SwiftInvocation SwiftArgs;
@@ -1000,8 +1314,24 @@ static void indexModule(llvm::MemoryBuffer *Input,
   // Setup a typechecker for protocol conformance resolving.
   OwnedResolver TypeResolver = createLazyResolver(Ctx);
 
-  IndexSwiftASTWalker Walker(IdxConsumer, Ctx, /*BufferID=*/-1);
+  // Record what is reported, so that indexing the same module file again
+  // doesn't need to load it.
+  auto Recorded = std::make_shared<RecordedModuleIndex>();
+  RecordingIndexingConsumer Recorder(IdxConsumer, *Recorded);
+  IndexSwiftASTWalker Walker(Recorder, Ctx, /*BufferID=*/-1);
   Walker.visitModule(*Mod, Hash);
+  if (!Recorder.isComplete())
+    return;
+
+  // FIXME: There exists a small window where a file may change after it was
+  // hashed and before it is stamped here, in which case the recorded symbols
+  // are reported for the changed file.
+  SmallVector<StringRef, 16> Filenames;
+  Filenames.push_back(Input->getBufferIdentifier());
+  Walker.getHashedFilenames(*Mod, Filenames);
+  for (StringRef Filename : Filenames)
+    Recorded->Files.push_back(getFileStamp(Filename));
+  ModuleCache.set(CacheKey, std::move(Recorded));
 }
 
 
@@ -1032,6 +1362,26 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
                                    IndexingConsumer &IdxConsumer,
                                    ArrayRef<const char *> Args,
                                    StringRef Hash) {
+  StringRef Filename = llvm::sys::path::filename(InputFile);
+  StringRef FileExt = llvm::sys::path::extension(Filename);
+
+  // A module file that was indexed before with the same arguments is answered
+  // from the recorded index, as long as none of the files that its hash
+  // covers changed, without loading the module.
+  std::string ModuleCacheKey;
+  if (FileExt == ".swiftmodule") {
+    ModuleCacheKey = InputFile;
+    for (auto Arg : Args) {
+      ModuleCacheKey += '\0';
+      ModuleCacheKey += Arg;
+    }
+    auto Recorded = getModuleIndexCache().get(ModuleCacheKey);
+    if (Recorded && Recorded->isUpToDate()) {
+      Recorded->report(IdxConsumer, Hash);
+      return;
+    }
+  }
+
   std::string Error;
   auto InputBuf = ASTMgr->getMemoryBuffer(InputFile, Error);
   if (!InputBuf) {
@@ -1039,9 +1389,6 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
     return;
   }
 
-  StringRef Filename = llvm::sys::path::filename(InputFile);
-  StringRef FileExt = llvm::sys::path::extension(Filename);
-
   bool IsModuleIndexing = (FileExt == ".swiftmodule" || FileExt == ".pcm");
   CompilerInstance CI;
   // Display diagnostics to stderr.
@@ -1068,7 +1415,8 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
     }
 
     indexModule(InputBuf.get(), llvm::sys::path::stem(Filename),
-                Hash, IdxConsumer, CI, Args);
+                Hash, IdxConsumer, CI, Args, getModuleIndexCache(),
+                ModuleCacheKey);
     return;
   }
 
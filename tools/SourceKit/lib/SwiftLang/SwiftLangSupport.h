@@ -24,6 +24,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Mutex.h"
 #include <map>
+#include <memory>
 #include <string>
 
 namespace swift {
@@ -176,6 +177,28 @@ public:
   bool set(StringRef name, unsigned offset, SessionCacheRef session);
   bool remove(StringRef name, unsigned offset);
 };
+
+struct CompletionAST;
+
+/// Keeps the type-checked AST of the last code completion request.
+///
+/// A following request for the same file and compiler arguments, which is in
+/// the same declaration and where only that declaration was edited, reuses the
+/// AST and only parses and type-checks that declaration again.
+///
+/// The AST is not thread-safe, so a request takes it out of the cache and puts
+/// it back when it is done.
+class CompletionASTCache {
+  std::unique_ptr<CompletionAST> ast;
+  llvm::sys::Mutex mtx;
+
+public:
+  CompletionASTCache();
+  ~CompletionASTCache();
+
+  std::unique_ptr<CompletionAST> take();
+  void set(std::unique_ptr<CompletionAST> newAST);
+};
 } // end namespace CodeCompletion
 
 class SwiftInterfaceGenMap {
@@ -190,6 +213,49 @@ public:
                                    const swift::CompilerInvocation &Invok);
 };
 
+struct RecordedModuleIndex;
+
+/// A thread-safe map from the path of a module file and the compiler
+/// arguments it was indexed with to what was reported when indexing it.
+///
+/// Indexing the same module file again, e.g. Foundation for another target,
+/// reports the recorded index instead of loading and walking the module
+/// again. The oldest indexes are dropped when the cache exceeds its size.
+class SwiftModuleIndexCache {
+  llvm::StringMap<std::shared_ptr<const RecordedModuleIndex>> Indexes;
+  std::vector<std::string> InsertionOrder;
+  size_t TotalSize = 0;
+  mutable llvm::sys::Mutex Mtx;
+
+public:
+  /// The maximum number of bytes that the recorded indexes use.
+  static const size_t MaxSize = 64 * 1024 * 1024;
+
+  std::shared_ptr<const RecordedModuleIndex> get(StringRef Key) const;
+  void set(StringRef Key, std::shared_ptr<const RecordedModuleIndex> Index);
+};
+
+struct ModuleDocInfo;
+
+/// Keeps the printed interface of the module of the last paged doc info
+/// request.
+///
+/// Clients of a large module request its doc info in pages, so the same
+/// interface is needed by many consecutive requests. It is dropped after the
+/// last page was reported. The AST of the module is not thread-safe, so a
+/// request takes it out of the cache and puts it back when it is done.
+class SwiftModuleDocInfoCache {
+  std::unique_ptr<ModuleDocInfo> Info;
+  llvm::sys::Mutex Mtx;
+
+public:
+  SwiftModuleDocInfoCache();
+  ~SwiftModuleDocInfoCache();
+
+  std::unique_ptr<ModuleDocInfo> take();
+  void set(std::unique_ptr<ModuleDocInfo> NewInfo);
+};
+
 struct SwiftCompletionCache
     : public ThreadSafeRefCountedBase<SwiftCompletionCache> {
   std::unique_ptr<swift::ide::CodeCompletionCache> inMemory;
@@ -214,9 +280,12 @@ class SwiftLangSupport : public LangSupport {
   std::unique_ptr<SwiftASTManager> ASTMgr;
   SwiftEditorDocumentFileMap EditorDocuments;
   SwiftInterfaceGenMap IFaceGenContexts;
+  SwiftModuleIndexCache ModuleIndexes;
+  SwiftModuleDocInfoCache ModuleDocInfos;
   ThreadSafeRefCntPtr<SwiftCompletionCache> CCCache;
   ThreadSafeRefCntPtr<SwiftPopularAPI> PopularAPI;
   CodeCompletion::SessionCacheMap CCSessions;
+  CodeCompletion::CompletionASTCache CCASTCache;
   ThreadSafeRefCntPtr<SwiftCustomCompletions> CustomCompletions;
 
 public:
@@ -231,9 +300,14 @@ public:
 
   SwiftEditorDocumentFileMap &getEditorDocuments() { return EditorDocuments; }
   SwiftInterfaceGenMap &getIFaceGenContexts() { return IFaceGenContexts; }
+  SwiftModuleIndexCache &getModuleIndexCache() { return ModuleIndexes; }
+  SwiftModuleDocInfoCache &getModuleDocInfoCache() { return ModuleDocInfos; }
   IntrusiveRefCntPtr<SwiftCompletionCache> getCodeCompletionCache() {
     return CCCache;
   }
+  CodeCompletion::CompletionASTCache &getCodeCompletionASTCache() {
+    return CCASTCache;
+  }
 
   static SourceKit::UIdent getUIDForDecl(const swift::Decl *D,
                                          bool IsRef = false);
@@ -361,6 +435,7 @@ public:
   void getDocInfo(llvm::MemoryBuffer *InputBuf,
                   StringRef ModuleName,
                   ArrayRef<const char *> Args,
+                  llvm::Optional<std::pair<unsigned, unsigned>> Range,
                   DocInfoConsumer &Consumer) override;
 
   llvm::Optional<std::pair<unsigned, unsigned>>
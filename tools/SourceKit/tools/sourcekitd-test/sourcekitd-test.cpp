@@ -528,6 +528,10 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
 
   case SourceKitRequest::DocInfo:
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestDocInfo);
+    if (Opts.Length) {
+      sourcekitd_request_dictionary_set_int64(Req, KeyOffset, ByteOffset);
+      sourcekitd_request_dictionary_set_int64(Req, KeyLength, Opts.Length);
+    }
     break;
 
   case SourceKitRequest::SemanticInfo:
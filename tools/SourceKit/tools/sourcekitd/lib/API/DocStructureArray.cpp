@@ -0,0 +1,542 @@
+//===--- DocStructureArray.cpp --------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "sourcekitd/DocStructureArray.h"
+#include "sourcekitd/CompactArray.h"
+#include "SourceKit/Core/LLVM.h"
+#include "SourceKit/Support/UIdent.h"
+#include "DictionaryKeys.h"
+
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace SourceKit;
+using namespace sourcekitd;
+
+// The buffer starts with the number of top-level nodes, followed by the
+// offsets of four compact arrays: the nodes, their elements, their inherited
+// types and their attributes. The nodes are laid out so that the children of
+// each node are consecutive, and the top-level nodes come first. A node refers
+// to its children, elements, inherited types and attributes by ranges of
+// indices into these arrays.
+namespace {
+enum DocStructureSubArray {
+  SubStructures,
+  Elements,
+  InheritedTypes,
+  Attributes,
+  NumSubArrays
+};
+}
+
+static const size_t HeaderSize = sizeof(uint64_t) * (1 + NumSubArrays);
+
+typedef CompactArrayBuilder<unsigned,
+                            unsigned,
+                            UIdent,
+                            Optional<UIdent>,
+                            Optional<UIdent>,
+                            unsigned,
+                            unsigned,
+                            unsigned,
+                            unsigned,
+                            Optional<StringRef>,
+                            Optional<StringRef>,
+                            Optional<StringRef>,
+                            Optional<StringRef>,
+                            unsigned,
+                            unsigned,
+                            unsigned,
+                            unsigned,
+                            unsigned,
+                            unsigned,
+                            unsigned,
+                            unsigned> SubStructureBuilderTy;
+
+struct DocStructureArrayBuilder::Implementation {
+  struct Element {
+    UIdent Kind;
+    unsigned Offset;
+    unsigned Length;
+  };
+
+  struct Node {
+    unsigned Offset;
+    unsigned Length;
+    UIdent Kind;
+    UIdent AccessLevel;
+    UIdent SetterAccessLevel;
+    unsigned NameOffset;
+    unsigned NameLength;
+    unsigned BodyOffset;
+    unsigned BodyLength;
+    std::string DisplayName;
+    std::string TypeName;
+    std::string RuntimeName;
+    std::string SelectorName;
+    std::vector<std::string> InheritedTypes;
+    std::vector<UIdent> Attrs;
+    std::vector<Element> Elements;
+    std::vector<unsigned> SubStructures;
+  };
+
+  std::vector<Node> Nodes;
+  std::vector<unsigned> TopLevel;
+  std::vector<unsigned> Stack;
+};
+
+DocStructureArrayBuilder::DocStructureArrayBuilder()
+  : Impl(*new Implementation()) {
+
+}
+
+DocStructureArrayBuilder::~DocStructureArrayBuilder() {
+  delete &Impl;
+}
+
+void DocStructureArrayBuilder::beginSubStructure(
+    unsigned Offset, unsigned Length, UIdent Kind, UIdent AccessLevel,
+    UIdent SetterAccessLevel, unsigned NameOffset, unsigned NameLength,
+    unsigned BodyOffset, unsigned BodyLength, StringRef DisplayName,
+    StringRef TypeName, StringRef RuntimeName, StringRef SelectorName,
+    ArrayRef<StringRef> InheritedTypes, ArrayRef<UIdent> Attrs) {
+
+  unsigned Index = Impl.Nodes.size();
+  if (Impl.Stack.empty())
+    Impl.TopLevel.push_back(Index);
+  else
+    Impl.Nodes[Impl.Stack.back()].SubStructures.push_back(Index);
+  Impl.Stack.push_back(Index);
+
+  Impl.Nodes.emplace_back();
+  Implementation::Node &Node = Impl.Nodes.back();
+  Node.Offset = Offset;
+  Node.Length = Length;
+  Node.Kind = Kind;
+  Node.AccessLevel = AccessLevel;
+  Node.SetterAccessLevel = SetterAccessLevel;
+  Node.NameOffset = NameOffset;
+  Node.NameLength = NameLength;
+  Node.BodyOffset = BodyOffset;
+  Node.BodyLength = BodyLength;
+  Node.DisplayName = DisplayName.str();
+  Node.TypeName = TypeName.str();
+  Node.RuntimeName = RuntimeName.str();
+  Node.SelectorName = SelectorName.str();
+  for (auto TypeName : InheritedTypes)
+    Node.InheritedTypes.push_back(TypeName.str());
+  Node.Attrs.assign(Attrs.begin(), Attrs.end());
+}
+
+void DocStructureArrayBuilder::addElement(UIdent Kind, unsigned Offset,
+                                          unsigned Length) {
+  if (Impl.Stack.empty())
+    return;
+  Impl.Nodes[Impl.Stack.back()].Elements.push_back({ Kind, Offset, Length });
+}
+
+void DocStructureArrayBuilder::endSubStructure() {
+  if (!Impl.Stack.empty())
+    Impl.Stack.pop_back();
+}
+
+bool DocStructureArrayBuilder::empty() const {
+  return Impl.TopLevel.empty();
+}
+
+static Optional<UIdent> getOptionalUID(UIdent UID) {
+  if (UID.isValid())
+    return UID;
+  return None;
+}
+
+static Optional<StringRef> getOptionalString(StringRef Str) {
+  if (!Str.empty())
+    return Str;
+  return None;
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+DocStructureArrayBuilder::createBuffer() {
+  // Order the nodes breadth-first, so that the children of each node are
+  // consecutive.
+  std::vector<unsigned> Order = Impl.TopLevel;
+  std::vector<std::pair<unsigned, unsigned>> ChildRanges;
+  ChildRanges.reserve(Impl.Nodes.size());
+  for (size_t I = 0; I != Order.size(); ++I) {
+    auto &Children = Impl.Nodes[Order[I]].SubStructures;
+    unsigned Start = Order.size();
+    Order.insert(Order.end(), Children.begin(), Children.end());
+    ChildRanges.push_back({ Start, unsigned(Order.size()) });
+  }
+
+  SubStructureBuilderTy SubStructureBuilder;
+  CompactArrayBuilder<UIdent, unsigned, unsigned> ElementBuilder;
+  CompactArrayBuilder<StringRef> InheritedTypeBuilder;
+  CompactArrayBuilder<UIdent> AttrBuilder;
+  unsigned NumElements = 0;
+  unsigned NumInheritedTypes = 0;
+  unsigned NumAttrs = 0;
+
+  for (size_t I = 0, E = Order.size(); I != E; ++I) {
+    const Implementation::Node &Node = Impl.Nodes[Order[I]];
+
+    unsigned ElementsStart = NumElements;
+    for (auto &Elem : Node.Elements)
+      ElementBuilder.addEntry(Elem.Kind, Elem.Offset, Elem.Length);
+    NumElements += Node.Elements.size();
+
+    unsigned InheritedTypesStart = NumInheritedTypes;
+    for (auto &TypeName : Node.InheritedTypes)
+      InheritedTypeBuilder.addEntry(TypeName);
+    NumInheritedTypes += Node.InheritedTypes.size();
+
+    unsigned AttrsStart = NumAttrs;
+    for (auto Attr : Node.Attrs)
+      AttrBuilder.addEntry(Attr);
+    NumAttrs += Node.Attrs.size();
+
+    SubStructureBuilder.addEntry(Node.Offset,
+                                 Node.Length,
+                                 Node.Kind,
+                                 getOptionalUID(Node.AccessLevel),
+                                 getOptionalUID(Node.SetterAccessLevel),
+                                 Node.NameOffset,
+                                 Node.NameLength,
+                                 Node.BodyOffset,
+                                 Node.BodyLength,
+                                 getOptionalString(Node.DisplayName),
+                                 getOptionalString(Node.TypeName),
+                                 getOptionalString(Node.RuntimeName),
+                                 getOptionalString(Node.SelectorName),
+                                 ElementsStart,
+                                 NumElements,
+                                 InheritedTypesStart,
+                                 NumInheritedTypes,
+                                 AttrsStart,
+                                 NumAttrs,
+                                 ChildRanges[I].first,
+                                 ChildRanges[I].second);
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> SubBufs[NumSubArrays] = {
+    SubStructureBuilder.createBuffer(),
+    ElementBuilder.createBuffer(),
+    InheritedTypeBuilder.createBuffer(),
+    AttrBuilder.createBuffer(),
+  };
+
+  // Keep each compact array 8-byte aligned; the padding is unused space at the
+  // end of the strings of the previous array.
+  uint64_t Header[1 + NumSubArrays];
+  Header[0] = Impl.TopLevel.size();
+  size_t TotalSize = HeaderSize;
+  for (unsigned I = 0; I != NumSubArrays; ++I) {
+    Header[1 + I] = TotalSize;
+    TotalSize += llvm::alignTo(SubBufs[I]->getBufferSize(), sizeof(uint64_t));
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> Buf;
+  Buf = llvm::MemoryBuffer::getNewMemBuffer(TotalSize);
+  char *BufPtr = (char*)Buf->getBufferStart();
+  memcpy(BufPtr, Header, HeaderSize);
+  for (unsigned I = 0; I != NumSubArrays; ++I)
+    memcpy(BufPtr + Header[1 + I], SubBufs[I]->getBufferStart(),
+           SubBufs[I]->getBufferSize());
+
+  return Buf;
+}
+
+namespace {
+
+class DocStructureArrayReader {
+  void *Buf;
+
+public:
+  typedef CompactArrayReader<unsigned,
+                             unsigned,
+                             sourcekitd_uid_t,
+                             sourcekitd_uid_t,
+                             sourcekitd_uid_t,
+                             unsigned,
+                             unsigned,
+                             unsigned,
+                             unsigned,
+                             const char *,
+                             const char *,
+                             const char *,
+                             const char *,
+                             unsigned,
+                             unsigned,
+                             unsigned,
+                             unsigned,
+                             unsigned,
+                             unsigned,
+                             unsigned,
+                             unsigned> SubStructureReaderTy;
+
+  struct Node {
+    unsigned Offset;
+    unsigned Length;
+    sourcekitd_uid_t Kind;
+    sourcekitd_uid_t AccessLevel;
+    sourcekitd_uid_t SetterAccessLevel;
+    unsigned NameOffset;
+    unsigned NameLength;
+    unsigned BodyOffset;
+    unsigned BodyLength;
+    const char *DisplayName;
+    const char *TypeName;
+    const char *RuntimeName;
+    const char *SelectorName;
+    unsigned ElementsStart;
+    unsigned ElementsEnd;
+    unsigned InheritedTypesStart;
+    unsigned InheritedTypesEnd;
+    unsigned AttrsStart;
+    unsigned AttrsEnd;
+    unsigned SubStructuresStart;
+    unsigned SubStructuresEnd;
+  };
+
+  explicit DocStructureArrayReader(void *Buf) : Buf(Buf) {}
+
+  size_t getNumTopLevel() const {
+    return ((uint64_t*)Buf)[0];
+  }
+
+  void *getSubArray(DocStructureSubArray Kind) const {
+    return (char*)Buf + ((uint64_t*)Buf)[1 + Kind];
+  }
+
+  Node readNode(size_t Index) const {
+    Node N;
+    SubStructureReaderTy Reader(getSubArray(SubStructures));
+    Reader.readEntries(Index,
+                       N.Offset,
+                       N.Length,
+                       N.Kind,
+                       N.AccessLevel,
+                       N.SetterAccessLevel,
+                       N.NameOffset,
+                       N.NameLength,
+                       N.BodyOffset,
+                       N.BodyLength,
+                       N.DisplayName,
+                       N.TypeName,
+                       N.RuntimeName,
+                       N.SelectorName,
+                       N.ElementsStart,
+                       N.ElementsEnd,
+                       N.InheritedTypesStart,
+                       N.InheritedTypesEnd,
+                       N.AttrsStart,
+                       N.AttrsEnd,
+                       N.SubStructuresStart,
+                       N.SubStructuresEnd);
+    return N;
+  }
+};
+
+/// Functions of an array in a DocStructureArray buffer. The variant holds the
+/// index of the node that the array belongs to, and \c T maps it to the range
+/// of indices of the array elements.
+template <typename T>
+struct DocStructureArrayFuncs {
+  static sourcekitd_variant_type_t get_type(sourcekitd_variant_t var) {
+    return SOURCEKITD_VARIANT_TYPE_ARRAY;
+  }
+
+  static size_t array_get_count(sourcekitd_variant_t array) {
+    auto Range = T::getRange((void*)array.data[1], array.data[2]);
+    return Range.second - Range.first;
+  }
+
+  static sourcekitd_variant_t
+  array_get_value(sourcekitd_variant_t array, size_t index) {
+    auto Range = T::getRange((void*)array.data[1], array.data[2]);
+    assert(index < Range.second - Range.first);
+    return {{ (uintptr_t)&CompactVariantFuncs<T>::Funcs,
+              (uintptr_t)array.data[1],
+              Range.first + index }};
+  }
+
+  static VariantFunctions Funcs;
+};
+
+template <typename T>
+VariantFunctions DocStructureArrayFuncs<T>::Funcs = {
+  get_type,
+  nullptr/*AnnotArray_array_apply*/,
+  nullptr/*AnnotArray_array_get_bool*/,
+  array_get_count,
+  nullptr/*AnnotArray_array_get_int64*/,
+  nullptr/*AnnotArray_array_get_string*/,
+  nullptr/*AnnotArray_array_get_uid*/,
+  array_get_value,
+  nullptr/*AnnotArray_bool_get_value*/,
+  nullptr/*AnnotArray_dictionary_apply*/,
+  nullptr/*AnnotArray_dictionary_get_bool*/,
+  nullptr/*AnnotArray_dictionary_get_int64*/,
+  nullptr/*AnnotArray_dictionary_get_string*/,
+  nullptr/*AnnotArray_dictionary_get_value*/,
+  nullptr/*AnnotArray_dictionary_get_uid*/,
+  nullptr/*AnnotArray_string_get_length*/,
+  nullptr/*AnnotArray_string_get_ptr*/,
+  nullptr/*AnnotArray_int64_get_value*/,
+  nullptr/*AnnotArray_uid_get_value*/
+};
+
+#define APPLY(K, Ty, Field)                              \
+  do {                                                   \
+    sourcekitd_uid_t key = SKDUIDFromUIdent(K);          \
+    sourcekitd_variant_t var = make##Ty##Variant(Field); \
+    if (!applier(key, var)) return false;                \
+  } while (0)
+
+#define APPLY_ARRAY(K, T, NodeIndex)                                 \
+  do {                                                               \
+    sourcekitd_uid_t key = SKDUIDFromUIdent(K);                      \
+    sourcekitd_variant_t var = {{                                    \
+        (uintptr_t)&DocStructureArrayFuncs<T>::Funcs,                \
+        (uintptr_t)Buf, NodeIndex }};                                \
+    if (!applier(key, var)) return false;                            \
+  } while (0)
+
+class ElementArray {
+public:
+  typedef CompactArrayReader<sourcekitd_uid_t,
+                             unsigned,
+                             unsigned> CompactArrayReaderTy;
+
+  static std::pair<size_t, size_t> getRange(void *Buf, size_t NodeIndex) {
+    auto Node = DocStructureArrayReader(Buf).readNode(NodeIndex);
+    return { Node.ElementsStart, Node.ElementsEnd };
+  }
+
+  static bool dictionary_apply(void *Buf, size_t Index,
+                              sourcekitd_variant_dictionary_applier_t applier) {
+    DocStructureArrayReader Reader(Buf);
+    sourcekitd_uid_t Kind;
+    unsigned Offset;
+    unsigned Length;
+    CompactArrayReaderTy(Reader.getSubArray(Elements))
+        .readEntries(Index, Kind, Offset, Length);
+
+    APPLY(KeyKind, UID, Kind);
+    APPLY(KeyOffset, Int, Offset);
+    APPLY(KeyLength, Int, Length);
+    return true;
+  }
+};
+
+class InheritedTypeArray {
+public:
+  typedef CompactArrayReader<const char *> CompactArrayReaderTy;
+
+  static std::pair<size_t, size_t> getRange(void *Buf, size_t NodeIndex) {
+    auto Node = DocStructureArrayReader(Buf).readNode(NodeIndex);
+    return { Node.InheritedTypesStart, Node.InheritedTypesEnd };
+  }
+
+  static bool dictionary_apply(void *Buf, size_t Index,
+                              sourcekitd_variant_dictionary_applier_t applier) {
+    DocStructureArrayReader Reader(Buf);
+    const char *Name;
+    CompactArrayReaderTy(Reader.getSubArray(InheritedTypes))
+        .readEntries(Index, Name);
+
+    APPLY(KeyName, String, Name);
+    return true;
+  }
+};
+
+class AttributeArray {
+public:
+  typedef CompactArrayReader<sourcekitd_uid_t> CompactArrayReaderTy;
+
+  static std::pair<size_t, size_t> getRange(void *Buf, size_t NodeIndex) {
+    auto Node = DocStructureArrayReader(Buf).readNode(NodeIndex);
+    return { Node.AttrsStart, Node.AttrsEnd };
+  }
+
+  static bool dictionary_apply(void *Buf, size_t Index,
+                              sourcekitd_variant_dictionary_applier_t applier) {
+    DocStructureArrayReader Reader(Buf);
+    sourcekitd_uid_t Attr;
+    CompactArrayReaderTy(Reader.getSubArray(Attributes))
+        .readEntries(Index, Attr);
+
+    APPLY(KeyAttribute, UID, Attr);
+    return true;
+  }
+};
+
+/// The substructure of the document or of a node. The variant of the array of
+/// the document has index 0, the one of a node has its index plus one.
+class SubStructureArray {
+public:
+  static std::pair<size_t, size_t> getRange(void *Buf, size_t ParentIndex) {
+    DocStructureArrayReader Reader(Buf);
+    if (ParentIndex == 0)
+      return { 0, Reader.getNumTopLevel() };
+    auto Node = Reader.readNode(ParentIndex - 1);
+    return { Node.SubStructuresStart, Node.SubStructuresEnd };
+  }
+
+  static bool dictionary_apply(void *Buf, size_t Index,
+                              sourcekitd_variant_dictionary_applier_t applier) {
+    auto Node = DocStructureArrayReader(Buf).readNode(Index);
+
+    APPLY(KeyOffset, Int, Node.Offset);
+    APPLY(KeyLength, Int, Node.Length);
+    APPLY(KeyKind, UID, Node.Kind);
+    if (Node.AccessLevel)
+      APPLY(KeyAccessibility, UID, Node.AccessLevel);
+    if (Node.SetterAccessLevel)
+      APPLY(KeySetterAccessibility, UID, Node.SetterAccessLevel);
+    APPLY(KeyNameOffset, Int, Node.NameOffset);
+    APPLY(KeyNameLength, Int, Node.NameLength);
+    if (Node.BodyOffset != 0 || Node.BodyLength != 0) {
+      APPLY(KeyBodyOffset, Int, Node.BodyOffset);
+      APPLY(KeyBodyLength, Int, Node.BodyLength);
+    }
+    if (Node.DisplayName)
+      APPLY(KeyName, String, Node.DisplayName);
+    if (Node.TypeName)
+      APPLY(KeyTypeName, String, Node.TypeName);
+    if (Node.RuntimeName)
+      APPLY(KeyRuntimeName, String, Node.RuntimeName);
+    if (Node.SelectorName)
+      APPLY(KeySelectorName, String, Node.SelectorName);
+    if (Node.InheritedTypesStart != Node.InheritedTypesEnd)
+      APPLY_ARRAY(KeyInheritedTypes, InheritedTypeArray, Index);
+    if (Node.AttrsStart != Node.AttrsEnd)
+      APPLY_ARRAY(KeyAttributes, AttributeArray, Index);
+    if (Node.SubStructuresStart != Node.SubStructuresEnd)
+      APPLY_ARRAY(KeySubStructure, SubStructureArray, Index + 1);
+    if (Node.ElementsStart != Node.ElementsEnd)
+      APPLY_ARRAY(KeyElements, ElementArray, Index);
+
+    return true;
+  }
+};
+
+#undef APPLY
+#undef APPLY_ARRAY
+
+}
+
+VariantFunctions *
+sourcekitd::getVariantFunctionsForDocStructureArray() {
+  return &DocStructureArrayFuncs<SubStructureArray>::Funcs;
+}
@@ -12,6 +12,7 @@
 
 #include "DictionaryKeys.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
 
@@ -156,9 +157,10 @@ static sourcekitd_response_t indexSource(StringRef Filename,
                                          ArrayRef<const char *> Args,
                                          StringRef KnownHash);
 
-static sourcekitd_response_t reportDocInfo(llvm::MemoryBuffer *InputBuf,
-                                           StringRef ModuleName,
-                                           ArrayRef<const char *> Args);
+static sourcekitd_response_t
+reportDocInfo(llvm::MemoryBuffer *InputBuf, StringRef ModuleName,
+              ArrayRef<const char *> Args,
+              Optional<std::pair<unsigned, unsigned>> Range);
 
 static void reportCursorInfo(StringRef Filename,
                              int64_t Offset,
@@ -386,7 +388,15 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     StringRef ModuleName;
     Optional<StringRef> ModuleNameOpt = Req.getString(KeyModuleName);
     if (ModuleNameOpt.hasValue()) ModuleName = *ModuleNameOpt;
-    return Rec(reportDocInfo(InputBuf.get(), ModuleName, Args));
+    // A client can request the doc info of a large module in pages.
+    Optional<std::pair<unsigned, unsigned>> Range;
+    int64_t Offset = 0;
+    int64_t Length = 0;
+    if (!Req.getInt64(KeyLength, Length, /*isOptional=*/false)) {
+      Req.getInt64(KeyOffset, Offset, /*isOptional=*/true);
+      Range = std::make_pair(unsigned(Offset), unsigned(Length));
+    }
+    return Rec(reportDocInfo(InputBuf.get(), ModuleName, Args, Range));
   }
 
   if (ReqUID == RequestEditorOpen) {
@@ -1038,12 +1048,13 @@ static std::string mangleSimpleClass(StringRef moduleName,
                                      StringRef className) {
   using namespace swift::Demangle;
 
-  auto moduleNode = NodeFactory::create(Node::Kind::Module, moduleName);
-  auto IdNode = NodeFactory::create(Node::Kind::Identifier, className);
-  auto classNode = NodeFactory::create(Node::Kind::Class);
-  auto typeNode = NodeFactory::create(Node::Kind::Type);
-  auto typeManglingNode = NodeFactory::create(Node::Kind::TypeMangling);
-  auto globalNode = NodeFactory::create(Node::Kind::Global);
+  NodeFactory Factory;
+  auto moduleNode = Factory.create(Node::Kind::Module, moduleName);
+  auto IdNode = Factory.create(Node::Kind::Identifier, className);
+  auto classNode = Factory.create(Node::Kind::Class);
+  auto typeNode = Factory.create(Node::Kind::Type);
+  auto typeManglingNode = Factory.create(Node::Kind::TypeMangling);
+  auto globalNode = Factory.create(Node::Kind::Global);
 
   classNode->addChildren(moduleNode, IdNode);
   typeNode->addChild(classNode);
@@ -1065,13 +1076,14 @@ mangleSimpleClassNames(ArrayRef<std::pair<StringRef, StringRef>> ModuleClassPair
   return RespBuilder.createResponse();
 }
 
-static sourcekitd_response_t reportDocInfo(llvm::MemoryBuffer *InputBuf,
-                                           StringRef ModuleName,
-                                           ArrayRef<const char *> Args) {
+static sourcekitd_response_t
+reportDocInfo(llvm::MemoryBuffer *InputBuf, StringRef ModuleName,
+              ArrayRef<const char *> Args,
+              Optional<std::pair<unsigned, unsigned>> Range) {
   ResponseBuilder RespBuilder;
   SKDocConsumer DocConsumer(RespBuilder);
   LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
-  Lang.getDocInfo(InputBuf, ModuleName, Args, DocConsumer);
+  Lang.getDocInfo(InputBuf, ModuleName, Args, Range, DocConsumer);
 
   if (!DocConsumer.ErrorDescription.empty())
     return createErrorRequestFailed(DocConsumer.ErrorDescription.c_str());
@@ -1666,19 +1678,12 @@ class SKEditorConsumer : public EditorConsumer {
   ResponseBuilder::Dictionary Dict;
   TokenAnnotationsArrayBuilder SyntaxMap;
   TokenAnnotationsArrayBuilder SemanticAnnotations;
-
-  struct StructureNode {
-    ResponseBuilder::Dictionary Dict;
-    ResponseBuilder::Array SubStructures;
-    ResponseBuilder::Array Elements;
-
-    explicit StructureNode(ResponseBuilder::Dictionary Dict) : Dict(Dict) {}
-  };
-  std::vector<StructureNode> Structures;
+  DocStructureArrayBuilder DocStructure;
   ResponseBuilder::Array Diags;
   sourcekitd_response_t Error = nullptr;
 
   bool EnableSyntaxMap;
+  bool EnableStructure;
   bool EnableDiagnostics;
   bool SyntacticOnly;
 
@@ -1687,12 +1692,11 @@ public:
                    bool EnableStructure, bool EnableDiagnostics,
                    bool SyntacticOnly)
   : EnableSyntaxMap(EnableSyntaxMap),
+    EnableStructure(EnableStructure),
     EnableDiagnostics(EnableDiagnostics),
     SyntacticOnly(SyntacticOnly) {
 
     Dict = RespBuilder.getDictionary();
-    if (EnableStructure)
-      Structures.push_back(StructureNode{Dict});
   }
 
   SKEditorConsumer(ResponseReceiver RespReceiver, bool EnableSyntaxMap,
@@ -1879,6 +1883,11 @@ sourcekitd_response_t SKEditorConsumer::createResponse() {
         CustomBufferKind::TokenAnnotationsArray,
         SemanticAnnotations.createBuffer());
   }
+  if (EnableStructure && !DocStructure.empty()) {
+    Dict.setCustomBuffer(KeySubStructure,
+        CustomBufferKind::DocStructureArray,
+        DocStructure.createBuffer());
+  }
 
   return RespBuilder.createResponse();
 }
@@ -1925,76 +1934,26 @@ SKEditorConsumer::beginDocumentSubStructure(unsigned Offset,
                                             StringRef SelectorName,
                                             ArrayRef<StringRef> InheritedTypes,
                                             ArrayRef<UIdent> Attrs) {
-  if (Structures.empty())
-    return true;
-
-  auto &Parent = Structures.back();
-  if (Parent.SubStructures.isNull())
-    Parent.SubStructures = Parent.Dict.setArray(KeySubStructure);
-  auto Node = Parent.SubStructures.appendDictionary();
-  Node.set(KeyOffset, Offset);
-  Node.set(KeyLength, Length);
-  Node.set(KeyKind, Kind);
-  if (AccessLevel.isValid())
-    Node.set(KeyAccessibility, AccessLevel);
-  if (SetterAccessLevel.isValid())
-    Node.set(KeySetterAccessibility, SetterAccessLevel);
-  Node.set(KeyNameOffset, NameOffset);
-  Node.set(KeyNameLength, NameLength);
-  if (BodyOffset != 0 || BodyLength !=0) {
-    Node.set(KeyBodyOffset, BodyOffset);
-    Node.set(KeyBodyLength, BodyLength);
-  }
-
-  if (!DisplayName.empty())
-    Node.set(KeyName, DisplayName);
-
-  if (!TypeName.empty())
-    Node.set(KeyTypeName,TypeName);
-
-  if (!RuntimeName.empty())
-    Node.set(KeyRuntimeName, RuntimeName);
-
-  if (!SelectorName.empty())
-    Node.set(KeySelectorName, SelectorName);
-
-  if (!InheritedTypes.empty()) {
-    auto TypeArray = Node.setArray(KeyInheritedTypes);
-    for (const StringRef &TypeName : InheritedTypes) {
-      TypeArray.appendDictionary().set(KeyName, TypeName);
-    }
-  }
-  if (!Attrs.empty()) {
-    auto AttrArray = Node.setArray(KeyAttributes);
-    for (auto Attr : Attrs) {
-      auto AttrDict = AttrArray.appendDictionary();
-      AttrDict.set(KeyAttribute, Attr);
-    }
-  }
-  Structures.push_back(StructureNode{Node});
+  if (EnableStructure)
+    DocStructure.beginSubStructure(Offset, Length, Kind, AccessLevel,
+                                   SetterAccessLevel, NameOffset, NameLength,
+                                   BodyOffset, BodyLength, DisplayName,
+                                   TypeName, RuntimeName, SelectorName,
+                                   InheritedTypes, Attrs);
   return true;
 }
 
 bool SKEditorConsumer::endDocumentSubStructure() {
-  if (!Structures.empty())
-    Structures.pop_back();
-
+  if (EnableStructure)
+    DocStructure.endSubStructure();
   return true;
 }
 
 bool SKEditorConsumer::handleDocumentSubStructureElement(UIdent Kind,
                                                          unsigned Offset,
                                                          unsigned Length) {
-  if (Structures.empty())
-    return true;
-
-  auto &Parent = Structures.back();
-  if (Parent.Elements.isNull())
-    Parent.Elements = Parent.Dict.setArray(KeyElements);
-  auto Node = Parent.Elements.appendDictionary();
-  Node.set(KeyKind, Kind);
-  Node.set(KeyOffset, Offset);
-  Node.set(KeyLength, Length);
+  if (EnableStructure)
+    DocStructure.addElement(Kind, Offset, Length);
   return true;
 }
 
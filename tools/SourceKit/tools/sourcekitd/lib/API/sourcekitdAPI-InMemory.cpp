@@ -0,0 +1,870 @@
+//===--- sourcekitdAPI-InMemory.cpp ---------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Implements the request and response objects of sourcekitd with plain
+// reference-counted C++ objects instead of XPC objects. It is used instead of
+// sourcekitdAPI-XPC.cpp on platforms without XPC, and with
+// SWIFT_SOURCEKIT_USE_IN_MEMORY_API, which only builds the in-process
+// sourcekitd library.
+//
+// The responses are never serialized. Custom buffers, like the ones of the
+// CompactArray based arrays, are handed to the client as they were built by
+// the service.
+//
+//===----------------------------------------------------------------------===//
+
+#include "DictionaryKeys.h"
+#include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DocStructureArray.h"
+#include "sourcekitd/DocSupportAnnotationArray.h"
+#include "sourcekitd/TokenAnnotationsArray.h"
+#include "sourcekitd/Logging.h"
+#include "SourceKit/Support/UIdent.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <algorithm>
+#include <vector>
+
+using namespace SourceKit;
+using namespace sourcekitd;
+using llvm::ArrayRef;
+using llvm::StringRef;
+using llvm::raw_ostream;
+using llvm::cast;
+using llvm::dyn_cast;
+using llvm::dyn_cast_or_null;
+using llvm::isa;
+
+namespace {
+
+class SKDObject;
+typedef llvm::IntrusiveRefCntPtr<SKDObject> SKDObjectRef;
+
+/// The base class of the request, response and error objects.
+///
+/// sourcekitd_object_t and sourcekitd_response_t point to an SKDObject, and
+/// sourcekitd_request_retain/release and sourcekitd_response_dispose adjust its
+/// reference count.
+class SKDObject : public llvm::ThreadSafeRefCountedBase<SKDObject> {
+public:
+  enum class ObjectKind {
+    Dictionary,
+    Array,
+    String,
+    Int64,
+    UID,
+    Bool,
+    CustomData,
+    Error,
+  };
+
+  virtual ~SKDObject() {}
+
+  ObjectKind getKind() const { return Kind; }
+
+protected:
+  explicit SKDObject(ObjectKind K) : Kind(K) {}
+
+private:
+  const ObjectKind Kind;
+};
+
+class SKDDictionary : public SKDObject {
+  std::vector<std::pair<UIdent, SKDObjectRef>> Storage;
+
+public:
+  SKDDictionary() : SKDObject(ObjectKind::Dictionary) {}
+
+  SKDObject *get(UIdent Key) const {
+    for (auto &Entry : Storage) {
+      if (Entry.first == Key)
+        return Entry.second.get();
+    }
+    return nullptr;
+  }
+
+  void set(UIdent Key, SKDObjectRef Value) {
+    for (auto &Entry : Storage) {
+      if (Entry.first == Key) {
+        Entry.second = std::move(Value);
+        return;
+      }
+    }
+    Storage.emplace_back(Key, std::move(Value));
+  }
+
+  ArrayRef<std::pair<UIdent, SKDObjectRef>> getEntries() const {
+    return Storage;
+  }
+
+  static bool classof(const SKDObject *O) {
+    return O->getKind() == ObjectKind::Dictionary;
+  }
+};
+
+class SKDArray : public SKDObject {
+  std::vector<SKDObjectRef> Storage;
+
+public:
+  SKDArray() : SKDObject(ObjectKind::Array) {}
+
+  size_t getCount() const { return Storage.size(); }
+
+  SKDObject *get(size_t Index) const {
+    if (Index >= Storage.size())
+      return nullptr;
+    return Storage[Index].get();
+  }
+
+  void set(size_t Index, SKDObjectRef Value) {
+    if (Index == SOURCEKITD_ARRAY_APPEND) {
+      Storage.push_back(std::move(Value));
+      return;
+    }
+    assert(Index < Storage.size() && "array index out of bounds");
+    Storage[Index] = std::move(Value);
+  }
+
+  ArrayRef<SKDObjectRef> getElements() const { return Storage; }
+
+  static bool classof(const SKDObject *O) {
+    return O->getKind() == ObjectKind::Array;
+  }
+};
+
+class SKDString : public SKDObject {
+  std::string Str;
+
+public:
+  explicit SKDString(StringRef Str)
+    : SKDObject(ObjectKind::String), Str(Str) {}
+
+  StringRef get() const { return Str; }
+  const char *getCString() const { return Str.c_str(); }
+
+  static bool classof(const SKDObject *O) {
+    return O->getKind() == ObjectKind::String;
+  }
+};
+
+class SKDInt64 : public SKDObject {
+  int64_t Value;
+
+public:
+  explicit SKDInt64(int64_t Value)
+    : SKDObject(ObjectKind::Int64), Value(Value) {}
+
+  int64_t get() const { return Value; }
+
+  static bool classof(const SKDObject *O) {
+    return O->getKind() == ObjectKind::Int64;
+  }
+};
+
+class SKDUID : public SKDObject {
+  sourcekitd_uid_t UID;
+
+public:
+  explicit SKDUID(sourcekitd_uid_t UID)
+    : SKDObject(ObjectKind::UID), UID(UID) {}
+
+  sourcekitd_uid_t get() const { return UID; }
+
+  static bool classof(const SKDObject *O) {
+    return O->getKind() == ObjectKind::UID;
+  }
+};
+
+class SKDBool : public SKDObject {
+  bool Value;
+
+public:
+  explicit SKDBool(bool Value) : SKDObject(ObjectKind::Bool), Value(Value) {}
+
+  bool get() const { return Value; }
+
+  static bool classof(const SKDObject *O) {
+    return O->getKind() == ObjectKind::Bool;
+  }
+};
+
+/// A buffer which is presented to the client by the variant functions of its
+/// \c CustomBufferKind.
+class SKDCustomData : public SKDObject {
+  CustomBufferKind BufferKind;
+  std::unique_ptr<llvm::MemoryBuffer> MemBuf;
+
+public:
+  SKDCustomData(CustomBufferKind BufferKind,
+                std::unique_ptr<llvm::MemoryBuffer> MemBuf)
+    : SKDObject(ObjectKind::CustomData), BufferKind(BufferKind),
+      MemBuf(std::move(MemBuf)) {}
+
+  CustomBufferKind getBufferKind() const { return BufferKind; }
+  const void *getDataPtr() const { return MemBuf->getBufferStart(); }
+
+  static bool classof(const SKDObject *O) {
+    return O->getKind() == ObjectKind::CustomData;
+  }
+};
+
+class SKDError : public SKDObject {
+  sourcekitd_error_t ErrorKind;
+  std::string Description;
+
+public:
+  SKDError(sourcekitd_error_t ErrorKind, StringRef Description)
+    : SKDObject(ObjectKind::Error), ErrorKind(ErrorKind),
+      Description(Description) {}
+
+  sourcekitd_error_t getErrorKind() const { return ErrorKind; }
+  const char *getDescription() const { return Description.c_str(); }
+
+  static bool classof(const SKDObject *O) {
+    return O->getKind() == ObjectKind::Error;
+  }
+};
+
+} // anonymous namespace.
+
+static SKDObject *toSKDObject(void *Obj) {
+  return static_cast<SKDObject *>(Obj);
+}
+
+/// Returns \p Obj with an additional reference, which is owned by the caller.
+static void *retained(SKDObject *Obj) {
+  Obj->Retain();
+  return Obj;
+}
+
+static SKDDictionary *toSKDDictionary(void *Obj) {
+  return cast<SKDDictionary>(toSKDObject(Obj));
+}
+
+static SKDArray *toSKDArray(void *Obj) {
+  return cast<SKDArray>(toSKDObject(Obj));
+}
+
+namespace {
+
+class SKDObjectPrinter {
+  raw_ostream &OS;
+  unsigned Indent;
+
+public:
+  SKDObjectPrinter(raw_ostream &OS, unsigned Indent = 0)
+    : OS(OS), Indent(Indent) { }
+
+  void visit(const SKDObject *Obj) {
+    switch (Obj->getKind()) {
+    case SKDObject::ObjectKind::Dictionary:
+      return visitDictionary(cast<SKDDictionary>(Obj));
+    case SKDObject::ObjectKind::Array:
+      return visitArray(cast<SKDArray>(Obj));
+    case SKDObject::ObjectKind::String:
+      return visitString(cast<SKDString>(Obj)->get());
+    case SKDObject::ObjectKind::Int64:
+      OS << cast<SKDInt64>(Obj)->get();
+      return;
+    case SKDObject::ObjectKind::UID:
+      OSColor(OS, UIDColor)
+        << UIdentFromSKDUID(cast<SKDUID>(Obj)->get()).getName();
+      return;
+    case SKDObject::ObjectKind::Bool:
+      OS << (cast<SKDBool>(Obj)->get() ? "true" : "false");
+      return;
+    case SKDObject::ObjectKind::CustomData:
+    case SKDObject::ObjectKind::Error:
+      break;
+    }
+    llvm_unreachable("unexpected object in a request");
+  }
+
+private:
+  static bool compKeys(const std::pair<UIdent, SKDObjectRef> &LHS,
+                       const std::pair<UIdent, SKDObjectRef> &RHS) {
+    return sourcekitd::compareDictKeys(LHS.first, RHS.first);
+  }
+
+  void visitDictionary(const SKDDictionary *Dict) {
+    std::vector<std::pair<UIdent, SKDObjectRef>> Entries(
+        Dict->getEntries().begin(), Dict->getEntries().end());
+    std::sort(Entries.begin(), Entries.end(), compKeys);
+
+    OS << "{\n";
+    Indent += 2;
+    for (unsigned i = 0, e = Entries.size(); i != e; ++i) {
+      auto &Pair = Entries[i];
+      OS.indent(Indent);
+      OSColor(OS, DictKeyColor) << Pair.first.getName();
+      OS << ": ";
+      SKDObjectPrinter(OS, Indent).visit(Pair.second.get());
+      if (i < e-1)
+        OS << ',';
+      OS << '\n';
+    }
+    Indent -= 2;
+    OS.indent(Indent) << '}';
+  }
+
+  void visitArray(const SKDArray *Arr) {
+    auto Elements = Arr->getElements();
+    OS << "[\n";
+    Indent += 2;
+    for (unsigned i = 0, e = Elements.size(); i != e; ++i) {
+      OS.indent(Indent);
+      SKDObjectPrinter(OS, Indent).visit(Elements[i].get());
+      if (i < e-1)
+        OS << ',';
+      OS << '\n';
+    }
+    Indent -= 2;
+    OS.indent(Indent) << ']';
+  }
+
+  void visitString(StringRef Str) {
+    OS << '\"';
+    // Avoid raw_ostream's write_escaped, we don't want to escape unicode
+    // characters because it will be invalid JSON.
+    writeEscaped(Str, OS);
+    OS << '\"';
+  }
+};
+
+} // anonymous namespace.
+
+void sourcekitd::printRequestObject(sourcekitd_object_t Obj, raw_ostream &OS) {
+  if (!Obj) {
+    OS << "<<NULL>>";
+    return;
+  }
+
+  SKDObjectPrinter(OS).visit(toSKDObject(Obj));
+}
+
+//===----------------------------------------------------------------------===//
+// Internal API
+//===----------------------------------------------------------------------===//
+
+ResponseBuilder::ResponseBuilder() {
+  Impl = retained(new SKDDictionary());
+}
+
+ResponseBuilder::~ResponseBuilder() {
+  toSKDObject(Impl)->Release();
+}
+
+ResponseBuilder::ResponseBuilder(const ResponseBuilder &Other) {
+  Impl = retained(toSKDObject(Other.Impl));
+}
+
+ResponseBuilder &ResponseBuilder::operator =(const ResponseBuilder &Other) {
+  void *Tmp = retained(toSKDObject(Other.Impl));
+  toSKDObject(Impl)->Release();
+  Impl = Tmp;
+  return *this;
+}
+
+ResponseBuilder::Dictionary ResponseBuilder::getDictionary() {
+  return Dictionary(Impl);
+}
+
+sourcekitd_response_t ResponseBuilder::createResponse() {
+  return retained(toSKDObject(Impl));
+}
+
+void ResponseBuilder::Dictionary::set(UIdent Key, SourceKit::UIdent UID) {
+  set(Key, SKDUIDFromUIdent(UID));
+}
+
+void ResponseBuilder::Dictionary::set(UIdent Key, sourcekitd_uid_t UID) {
+  toSKDDictionary(Impl)->set(Key, new SKDUID(UID));
+}
+
+void ResponseBuilder::Dictionary::set(UIdent Key, const char *Str) {
+  toSKDDictionary(Impl)->set(Key, new SKDString(Str));
+}
+
+void ResponseBuilder::Dictionary::set(UIdent Key, llvm::StringRef Str) {
+  toSKDDictionary(Impl)->set(Key, new SKDString(Str));
+}
+
+void ResponseBuilder::Dictionary::set(UIdent Key, int64_t val) {
+  toSKDDictionary(Impl)->set(Key, new SKDInt64(val));
+}
+
+void ResponseBuilder::Dictionary::set(SourceKit::UIdent Key,
+                                      ArrayRef<StringRef> Strs) {
+  SKDObjectRef Arr = new SKDArray();
+  for (auto Str : Strs)
+    cast<SKDArray>(Arr.get())->set(SOURCEKITD_ARRAY_APPEND, new SKDString(Str));
+  toSKDDictionary(Impl)->set(Key, std::move(Arr));
+}
+
+void ResponseBuilder::Dictionary::setBool(UIdent Key, bool val) {
+  toSKDDictionary(Impl)->set(Key, new SKDBool(val));
+}
+
+ResponseBuilder::Array
+ResponseBuilder::Dictionary::setArray(UIdent Key) {
+  SKDArray *Arr = new SKDArray();
+  toSKDDictionary(Impl)->set(Key, Arr);
+  return Array(Arr);
+}
+
+ResponseBuilder::Dictionary
+ResponseBuilder::Dictionary::setDictionary(UIdent Key) {
+  SKDDictionary *Dict = new SKDDictionary();
+  toSKDDictionary(Impl)->set(Key, Dict);
+  return Dictionary(Dict);
+}
+
+void ResponseBuilder::Dictionary::setCustomBuffer(
+      SourceKit::UIdent Key,
+      CustomBufferKind Kind, std::unique_ptr<llvm::MemoryBuffer> MemBuf) {
+  // The client reads the buffer in the same process, so it doesn't need to be
+  // copied.
+  toSKDDictionary(Impl)->set(Key, new SKDCustomData(Kind, std::move(MemBuf)));
+}
+
+ResponseBuilder::Dictionary ResponseBuilder::Array::appendDictionary() {
+  SKDDictionary *Dict = new SKDDictionary();
+  toSKDArray(Impl)->set(SOURCEKITD_ARRAY_APPEND, Dict);
+  return Dictionary(Dict);
+}
+
+sourcekitd_uid_t RequestDict::getUID(UIdent Key) {
+  if (auto UID = dyn_cast_or_null<SKDUID>(toSKDDictionary(Dict)->get(Key)))
+    return UID->get();
+  return nullptr;
+}
+
+Optional<StringRef> RequestDict::getString(UIdent Key) {
+  if (auto Str = dyn_cast_or_null<SKDString>(toSKDDictionary(Dict)->get(Key)))
+    return Str->get();
+  return None;
+}
+
+Optional<RequestDict> RequestDict::getDictionary(SourceKit::UIdent Key) {
+  SKDObject *Obj = toSKDDictionary(Dict)->get(Key);
+  if (!Obj || !isa<SKDDictionary>(Obj))
+    return None;
+  return RequestDict(Obj);
+}
+
+bool RequestDict::getStringArray(SourceKit::UIdent Key,
+                                 llvm::SmallVectorImpl<const char *> &Arr,
+                                 bool isOptional) {
+  SKDObject *Obj = toSKDDictionary(Dict)->get(Key);
+  if (!Obj)
+    return !isOptional;
+  auto *SKDArr = dyn_cast<SKDArray>(Obj);
+  if (!SKDArr)
+    return true;
+  Arr.reserve(SKDArr->getCount());
+  for (auto &Elem : SKDArr->getElements()) {
+    auto *Str = dyn_cast<SKDString>(Elem.get());
+    if (!Str)
+      return true;
+    Arr.push_back(Str->getCString());
+  }
+  return false;
+}
+
+bool RequestDict::getUIDArray(SourceKit::UIdent Key,
+                              llvm::SmallVectorImpl<sourcekitd_uid_t> &Arr,
+                              bool isOptional) {
+  SKDObject *Obj = toSKDDictionary(Dict)->get(Key);
+  if (!Obj)
+    return !isOptional;
+  auto *SKDArr = dyn_cast<SKDArray>(Obj);
+  if (!SKDArr)
+    return true;
+  Arr.reserve(SKDArr->getCount());
+  for (auto &Elem : SKDArr->getElements()) {
+    auto *UID = dyn_cast<SKDUID>(Elem.get());
+    if (!UID || !UID->get())
+      return true;
+    Arr.push_back(UID->get());
+  }
+  return false;
+}
+
+bool RequestDict::dictionaryArrayApply(
+    SourceKit::UIdent key, llvm::function_ref<bool(RequestDict)> applier) {
+  auto *SKDArr = dyn_cast_or_null<SKDArray>(toSKDDictionary(Dict)->get(key));
+  if (!SKDArr)
+    return true;
+  for (auto &Elem : SKDArr->getElements()) {
+    if (!isa<SKDDictionary>(Elem.get()))
+      return true;
+    if (applier(RequestDict(Elem.get())))
+      return true;
+  }
+  return false;
+}
+
+bool RequestDict::getInt64(SourceKit::UIdent Key, int64_t &Val,
+                           bool isOptional) {
+  SKDObject *Obj = toSKDDictionary(Dict)->get(Key);
+  if (!Obj)
+    return !isOptional;
+  auto *Int = dyn_cast<SKDInt64>(Obj);
+  if (!Int)
+    return true;
+  Val = Int->get();
+  return false;
+}
+
+sourcekitd_response_t
+sourcekitd::createErrorRequestInvalid(const char *Description) {
+  return retained(new SKDError(SOURCEKITD_ERROR_REQUEST_INVALID, Description));
+}
+sourcekitd_response_t
+sourcekitd::createErrorRequestFailed(const char *Description) {
+  return retained(new SKDError(SOURCEKITD_ERROR_REQUEST_FAILED, Description));
+}
+sourcekitd_response_t
+sourcekitd::createErrorRequestInterrupted(const char *Description) {
+  return retained(new SKDError(SOURCEKITD_ERROR_CONNECTION_INTERRUPTED,
+                               Description));
+}
+sourcekitd_response_t
+sourcekitd::createErrorRequestCancelled() {
+  return retained(new SKDError(SOURCEKITD_ERROR_REQUEST_CANCELLED, ""));
+}
+
+//===----------------------------------------------------------------------===//
+// Public API
+//===----------------------------------------------------------------------===//
+
+sourcekitd_uid_t
+sourcekitd_uid_get_from_cstr(const char *string) {
+  return SKDUIDFromUIdent(UIdent(string));
+}
+
+sourcekitd_uid_t
+sourcekitd_uid_get_from_buf(const char *buf, size_t length) {
+  return SKDUIDFromUIdent(UIdent(llvm::StringRef(buf, length)));
+}
+
+size_t
+sourcekitd_uid_get_length(sourcekitd_uid_t uid) {
+  UIdent UID = UIdentFromSKDUID(uid);
+  return UID.getName().size();
+}
+
+const char *
+sourcekitd_uid_get_string_ptr(sourcekitd_uid_t uid) {
+  UIdent UID = UIdentFromSKDUID(uid);
+  return UID.getName().begin();
+}
+
+//===----------------------------------------------------------------------===//
+// Public Request API
+//===----------------------------------------------------------------------===//
+
+sourcekitd_object_t
+sourcekitd_request_retain(sourcekitd_object_t object) {
+  return retained(toSKDObject(object));
+}
+
+void sourcekitd_request_release(sourcekitd_object_t object) {
+  toSKDObject(object)->Release();
+}
+
+sourcekitd_object_t
+sourcekitd_request_dictionary_create(const sourcekitd_uid_t *keys,
+                                     const sourcekitd_object_t *values,
+                                     size_t count) {
+  SKDDictionary *Dict = new SKDDictionary();
+  for (size_t i = 0; i < count; ++i) {
+    if (values[i])
+      Dict->set(UIdentFromSKDUID(keys[i]), toSKDObject(values[i]));
+  }
+  return retained(Dict);
+}
+
+void
+sourcekitd_request_dictionary_set_value(sourcekitd_object_t dict,
+                                        sourcekitd_uid_t key,
+                                        sourcekitd_object_t value) {
+  toSKDDictionary(dict)->set(UIdentFromSKDUID(key), toSKDObject(value));
+}
+
+void sourcekitd_request_dictionary_set_string(sourcekitd_object_t dict,
+                                              sourcekitd_uid_t key,
+                                              const char *string) {
+  toSKDDictionary(dict)->set(UIdentFromSKDUID(key), new SKDString(string));
+}
+
+void
+sourcekitd_request_dictionary_set_stringbuf(sourcekitd_object_t dict,
+                                            sourcekitd_uid_t key,
+                                            const char *buf, size_t length) {
+  toSKDDictionary(dict)->set(UIdentFromSKDUID(key),
+                             new SKDString(StringRef(buf, length)));
+}
+
+void sourcekitd_request_dictionary_set_int64(sourcekitd_object_t dict,
+                                             sourcekitd_uid_t key,
+                                             int64_t val) {
+  toSKDDictionary(dict)->set(UIdentFromSKDUID(key), new SKDInt64(val));
+}
+
+void
+sourcekitd_request_dictionary_set_uid(sourcekitd_object_t dict,
+                                      sourcekitd_uid_t key,
+                                      sourcekitd_uid_t uid) {
+  toSKDDictionary(dict)->set(UIdentFromSKDUID(key), new SKDUID(uid));
+}
+
+sourcekitd_object_t
+sourcekitd_request_array_create(const sourcekitd_object_t *objects,
+                                size_t count) {
+  SKDArray *Arr = new SKDArray();
+  for (size_t i = 0; i < count; ++i)
+    Arr->set(SOURCEKITD_ARRAY_APPEND, toSKDObject(objects[i]));
+  return retained(Arr);
+}
+
+void
+sourcekitd_request_array_set_value(sourcekitd_object_t array, size_t index,
+                                   sourcekitd_object_t value) {
+  toSKDArray(array)->set(index, toSKDObject(value));
+}
+
+void
+sourcekitd_request_array_set_string(sourcekitd_object_t array, size_t index,
+                                    const char *string) {
+  toSKDArray(array)->set(index, new SKDString(string));
+}
+
+void
+sourcekitd_request_array_set_stringbuf(sourcekitd_object_t array, size_t index,
+                                       const char *buf, size_t length) {
+  toSKDArray(array)->set(index, new SKDString(StringRef(buf, length)));
+}
+
+void
+sourcekitd_request_array_set_int64(sourcekitd_object_t array, size_t index,
+                                   int64_t val) {
+  toSKDArray(array)->set(index, new SKDInt64(val));
+}
+
+void
+sourcekitd_request_array_set_uid(sourcekitd_object_t array, size_t index,
+                                 sourcekitd_uid_t uid) {
+  toSKDArray(array)->set(index, new SKDUID(uid));
+}
+
+sourcekitd_object_t
+sourcekitd_request_int64_create(int64_t val) {
+  return retained(new SKDInt64(val));
+}
+
+sourcekitd_object_t
+sourcekitd_request_string_create(const char *string) {
+  return retained(new SKDString(string));
+}
+
+sourcekitd_object_t
+sourcekitd_request_uid_create(sourcekitd_uid_t uid) {
+  return retained(new SKDUID(uid));
+}
+
+void
+sourcekitd_request_description_dump(sourcekitd_object_t obj) {
+  // Avoid colors here, we don't properly detect that the debug window inside
+  // Xcode doesn't support colors.
+  llvm::SmallString<128> Desc;
+  llvm::raw_svector_ostream OS(Desc);
+  printRequestObject(obj, OS);
+  llvm::errs() << OS.str() << '\n';
+}
+
+char *
+sourcekitd_request_description_copy(sourcekitd_object_t obj) {
+  llvm::SmallString<128> Desc;
+  llvm::raw_svector_ostream OS(Desc);
+  printRequestObject(obj, OS);
+  return strdup(Desc.c_str());
+}
+
+//===----------------------------------------------------------------------===//
+// Public Response API
+//===----------------------------------------------------------------------===//
+
+void
+sourcekitd_response_dispose(sourcekitd_response_t obj) {
+  toSKDObject(obj)->Release();
+}
+
+bool
+sourcekitd_response_is_error(sourcekitd_response_t obj) {
+  return isa<SKDError>(toSKDObject(obj));
+}
+
+sourcekitd_error_t
+sourcekitd_response_error_get_kind(sourcekitd_response_t obj) {
+  if (auto *Err = dyn_cast<SKDError>(toSKDObject(obj)))
+    return Err->getErrorKind();
+
+  llvm::report_fatal_error("sourcekitd error did not resolve to a known kind");
+}
+
+const char *
+sourcekitd_response_error_get_description(sourcekitd_response_t obj) {
+  if (auto *Err = dyn_cast<SKDError>(toSKDObject(obj)))
+    return Err->getDescription();
+
+  llvm::report_fatal_error("invalid sourcekitd error object");
+}
+
+static sourcekitd_variant_t variantFromSKDObject(const SKDObject *Obj);
+
+sourcekitd_variant_t
+sourcekitd_response_get_value(sourcekitd_response_t resp) {
+  if (sourcekitd_response_is_error(resp))
+    return makeNullVariant();
+  return variantFromSKDObject(toSKDObject(resp));
+}
+
+//===----------------------------------------------------------------------===//
+// Variant functions
+//===----------------------------------------------------------------------===//
+
+// Dictionaries and arrays have their own variant functions. The other objects
+// are presented as variants of the basic types, which don't need any.
+
+#define SKD_DICT(var) (reinterpret_cast<const SKDDictionary *>((var).data[1]))
+#define SKD_ARRAY(var) (reinterpret_cast<const SKDArray *>((var).data[1]))
+
+static sourcekitd_variant_type_t SKDVar_get_type(sourcekitd_variant_t var) {
+  return sourcekitd_variant_type_t(var.data[2]);
+}
+
+static bool SKDVar_dictionary_apply(
+      sourcekitd_variant_t dict,
+      sourcekitd_variant_dictionary_applier_t applier) {
+  for (auto &Entry : SKD_DICT(dict)->getEntries()) {
+    if (!applier(SKDUIDFromUIdent(Entry.first),
+                 variantFromSKDObject(Entry.second.get())))
+      return false;
+  }
+  return true;
+}
+
+static sourcekitd_variant_t
+SKDVar_dictionary_get_value(sourcekitd_variant_t dict, sourcekitd_uid_t key) {
+  return variantFromSKDObject(SKD_DICT(dict)->get(UIdentFromSKDUID(key)));
+}
+
+static size_t SKDVar_array_get_count(sourcekitd_variant_t array) {
+  return SKD_ARRAY(array)->getCount();
+}
+
+static sourcekitd_variant_t
+SKDVar_array_get_value(sourcekitd_variant_t array, size_t index) {
+  return variantFromSKDObject(SKD_ARRAY(array)->get(index));
+}
+
+static VariantFunctions SKDDictionaryVariantFuncs = {
+  SKDVar_get_type,
+  nullptr /*SKDVar_array_apply*/,
+  nullptr /*SKDVar_array_get_bool*/,
+  nullptr /*SKDVar_array_get_count*/,
+  nullptr /*SKDVar_array_get_int64*/,
+  nullptr /*SKDVar_array_get_string*/,
+  nullptr /*SKDVar_array_get_uid*/,
+  nullptr /*SKDVar_array_get_value*/,
+  nullptr /*SKDVar_bool_get_value*/,
+  SKDVar_dictionary_apply,
+  nullptr /*SKDVar_dictionary_get_bool*/,
+  nullptr /*SKDVar_dictionary_get_int64*/,
+  nullptr /*SKDVar_dictionary_get_string*/,
+  SKDVar_dictionary_get_value,
+  nullptr /*SKDVar_dictionary_get_uid*/,
+  nullptr /*SKDVar_string_get_length*/,
+  nullptr /*SKDVar_string_get_ptr*/,
+  nullptr /*SKDVar_int64_get_value*/,
+  nullptr /*SKDVar_uid_get_value*/
+};
+
+static VariantFunctions SKDArrayVariantFuncs = {
+  SKDVar_get_type,
+  nullptr /*SKDVar_array_apply*/,
+  nullptr /*SKDVar_array_get_bool*/,
+  SKDVar_array_get_count,
+  nullptr /*SKDVar_array_get_int64*/,
+  nullptr /*SKDVar_array_get_string*/,
+  nullptr /*SKDVar_array_get_uid*/,
+  SKDVar_array_get_value,
+  nullptr /*SKDVar_bool_get_value*/,
+  nullptr /*SKDVar_dictionary_apply*/,
+  nullptr /*SKDVar_dictionary_get_bool*/,
+  nullptr /*SKDVar_dictionary_get_int64*/,
+  nullptr /*SKDVar_dictionary_get_string*/,
+  nullptr /*SKDVar_dictionary_get_value*/,
+  nullptr /*SKDVar_dictionary_get_uid*/,
+  nullptr /*SKDVar_string_get_length*/,
+  nullptr /*SKDVar_string_get_ptr*/,
+  nullptr /*SKDVar_int64_get_value*/,
+  nullptr /*SKDVar_uid_get_value*/
+};
+
+static sourcekitd_variant_t variantFromSKDObject(const SKDObject *Obj) {
+  if (!Obj)
+    return makeNullVariant();
+
+  switch (Obj->getKind()) {
+  case SKDObject::ObjectKind::Dictionary:
+    return {{ (uintptr_t)&SKDDictionaryVariantFuncs, (uintptr_t)Obj,
+              SOURCEKITD_VARIANT_TYPE_DICTIONARY }};
+  case SKDObject::ObjectKind::Array:
+    return {{ (uintptr_t)&SKDArrayVariantFuncs, (uintptr_t)Obj,
+              SOURCEKITD_VARIANT_TYPE_ARRAY }};
+  case SKDObject::ObjectKind::String:
+    return makeStringVariant(cast<SKDString>(Obj)->getCString());
+  case SKDObject::ObjectKind::Int64:
+    return makeIntVariant(cast<SKDInt64>(Obj)->get());
+  case SKDObject::ObjectKind::UID:
+    return makeUIDVariant(cast<SKDUID>(Obj)->get());
+  case SKDObject::ObjectKind::Bool:
+    return makeBoolVariant(cast<SKDBool>(Obj)->get());
+  case SKDObject::ObjectKind::CustomData: {
+    auto *Data = cast<SKDCustomData>(Obj);
+    switch (Data->getBufferKind()) {
+    case CustomBufferKind::TokenAnnotationsArray:
+      return {{ (uintptr_t)getVariantFunctionsForTokenAnnotationsArray(),
+                (uintptr_t)Data->getDataPtr(), 0 }};
+    case CustomBufferKind::DocSupportAnnotationArray:
+      return {{ (uintptr_t)getVariantFunctionsForDocSupportAnnotationArray(),
+                (uintptr_t)Data->getDataPtr(), 0 }};
+    case CustomBufferKind::CodeCompletionResultsArray:
+      return {{ (uintptr_t)getVariantFunctionsForCodeCompletionResultsArray(),
+                (uintptr_t)Data->getDataPtr(), 0 }};
+    case CustomBufferKind::DocStructureArray:
+      return {{ (uintptr_t)getVariantFunctionsForDocStructureArray(),
+                (uintptr_t)Data->getDataPtr(), 0 }};
+    }
+    llvm_unreachable("unknown custom buffer kind");
+  }
+  case SKDObject::ObjectKind::Error:
+    return makeNullVariant();
+  }
+  llvm_unreachable("unknown sourcekitd object");
+}
@@ -15,15 +15,23 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/DemangleWrappers.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
-#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
-#include "llvm/Support/Regex.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 static llvm::cl::opt<bool>
 ExpandMode("expand",
@@ -53,36 +61,64 @@ static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
 
+static llvm::cl::opt<std::string>
+InputFile("input-file",
+          llvm::cl::desc("Demangle all symbols in <file> instead of stdin"),
+          llvm::cl::value_desc("file"), llvm::cl::init("-"));
+
+static llvm::cl::opt<unsigned>
+NumThreads("j",
+           llvm::cl::desc("Number of threads for demangling the symbols in "
+                          "the input file or stdin"),
+           llvm::cl::init(1));
+
+static llvm::cl::opt<unsigned>
+ChunkSize("chunk-size",
+          llvm::cl::desc("Approximate number of input bytes which are "
+                         "demangled by a thread at once"),
+          llvm::cl::init(1 << 20), llvm::cl::Hidden);
+
+static llvm::cl::opt<unsigned>
+MaxCachedNames("max-cached-names",
+               llvm::cl::desc("Maximum number of demangled names each "
+                              "thread remembers"),
+               llvm::cl::init(1 << 16), llvm::cl::Hidden);
+
 static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
+                     swift::Demangle::NodeFactory &factory,
                      const swift::Demangle::DemangleOptions &options) {
+  // The nodes of the previously demangled name are not needed anymore. Reuse
+  // their memory.
+  factory.clear();
+
   bool hadLeadingUnderscore = false;
   if (name.startswith("__")) {
     hadLeadingUnderscore = true;
     name = name.substr(1);
   }
   swift::Demangle::NodePointer pointer =
-      swift::demangle_wrappers::demangleSymbolAsNode(name);
+      swift::demangle_wrappers::demangleSymbolAsNode(name, factory);
   if (ExpandMode || TreeOnly) {
-    llvm::outs() << "Demangling for " << name << '\n';
-    swift::demangle_wrappers::NodeDumper(pointer).print(llvm::outs());
+    os << "Demangling for " << name << '\n';
+    swift::demangle_wrappers::NodeDumper(pointer).print(os);
   }
   if (RemangleMode) {
-    if (hadLeadingUnderscore) llvm::outs() << '_';
+    if (hadLeadingUnderscore) os << '_';
     // Just reprint the original mangled name if it didn't demangle.
     // This makes it easier to share the same database between the
     // mangling and demangling tests.
     if (!pointer) {
-      llvm::outs() << name;
+      os << name;
     } else {
-      llvm::outs() << swift::Demangle::mangleNode(pointer);
+      os << swift::Demangle::mangleNode(pointer);
     }
     return;
   }
   if (!TreeOnly) {
     std::string string = swift::Demangle::nodeToString(pointer, options);
     if (!CompactMode)
-      llvm::outs() << name << " ---> ";
-    llvm::outs() << (string.empty() ? name : llvm::StringRef(string));
+      os << name << " ---> ";
+    os << (string.empty() ? name : llvm::StringRef(string));
   }
 }
 
@@ -96,6 +132,255 @@ static llvm::StringRef substrAfter(llvm::StringRef whole,
   return whole.substr((part.data() - whole.data()) + part.size());
 }
 
+static bool isMangledNameChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+/// Returns the first substring of \p text which looks like a mangled name,
+/// i.e. which matches "_T[_a-zA-Z0-9$]+", or an empty string if there is none.
+///
+/// This doesn't handle Unicode symbols, but maybe that's okay.
+static llvm::StringRef findMangledName(llvm::StringRef text) {
+  const char *cur = text.begin();
+  const char *end = text.end();
+  while (cur != end) {
+    // memchr is vectorized by the C library, which makes skipping the large
+    // parts of the input which don't contain symbols cheap.
+    auto underscore =
+      static_cast<const char *>(memchr(cur, '_', end - cur));
+    if (!underscore)
+      break;
+    const char *nameEnd = underscore + 1;
+    if (nameEnd != end && *nameEnd == 'T') {
+      ++nameEnd;
+      while (nameEnd != end && isMangledNameChar(*nameEnd))
+        ++nameEnd;
+      if (nameEnd - underscore > 2)
+        return llvm::StringRef(underscore, nameEnd - underscore);
+    }
+    cur = underscore + 1;
+  }
+  return llvm::StringRef();
+}
+
+namespace {
+/// Replaces all mangled names in a text with their demanglings.
+///
+/// Each thread uses its own TextDemangler, so nothing is shared between
+/// threads.
+class TextDemangler {
+  const swift::Demangle::DemangleOptions &options;
+  swift::Demangle::NodeFactory factory;
+
+  /// Maps mangled names to their demangled output. Profiler output and crash
+  /// logs contain the same symbols over and over again.
+  llvm::StringMap<std::string> cache;
+
+public:
+  TextDemangler(const swift::Demangle::DemangleOptions &options)
+    : options(options) {}
+
+  void demangleText(llvm::StringRef text, llvm::raw_ostream &os) {
+    while (true) {
+      llvm::StringRef name = findMangledName(text);
+      if (name.empty())
+        break;
+      os << substrBefore(text, name);
+      os << getDemangled(name);
+      text = substrAfter(text, name);
+    }
+    os << text;
+  }
+
+private:
+  llvm::StringRef getDemangled(llvm::StringRef name) {
+    auto iter = cache.find(name);
+    if (iter != cache.end())
+      return iter->getValue();
+
+    // Don't let the cache grow without bounds if the input contains many
+    // distinct symbols.
+    if (cache.size() >= MaxCachedNames)
+      cache.clear();
+
+    std::string &result = cache[name];
+    llvm::raw_string_ostream resultStream(result);
+    demangle(resultStream, name, factory, options);
+    resultStream.flush();
+    return result;
+  }
+};
+} // end anonymous namespace
+
+/// Returns the number of input bytes which are demangled by a thread at once.
+static size_t getChunkSize() {
+  return std::max(1u, unsigned(ChunkSize));
+}
+
+/// Returns the length of the chunk at the start of \p text which is demangled
+/// by one thread.
+///
+/// Chunks end after a character which can't be part of a mangled name, so that
+/// no symbol is split between two chunks.
+static size_t getChunkLength(llvm::StringRef text) {
+  size_t length = std::min(getChunkSize(), text.size());
+  while (length < text.size() && isMangledNameChar(text[length - 1]))
+    ++length;
+  return length;
+}
+
+namespace {
+/// Demangles the chunks of a text on NumThreads threads.
+///
+/// The worker threads are created once and reused for all parts of the input.
+/// The calling thread demangles the first chunk itself.
+class DemanglerPool {
+  std::vector<std::unique_ptr<TextDemangler>> demanglers;
+  std::vector<std::thread> workers;
+  std::vector<llvm::StringRef> chunks;
+  std::vector<std::string> outputs;
+
+  std::mutex mutex;
+  std::condition_variable roundStarted;
+  std::condition_variable roundFinished;
+
+  /// Incremented for each text which is demangled, so that a worker can tell
+  /// new work from a spurious wakeup.
+  unsigned round = 0;
+  unsigned numChunks = 0;
+  unsigned numPendingChunks = 0;
+  bool shuttingDown = false;
+
+  void demangleChunk(unsigned idx) {
+    llvm::raw_string_ostream chunkStream(outputs[idx]);
+    demanglers[idx]->demangleText(chunks[idx], chunkStream);
+  }
+
+  void runWorker(unsigned idx) {
+    unsigned lastRound = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        roundStarted.wait(lock, [&] {
+          return shuttingDown || round != lastRound;
+        });
+        if (shuttingDown)
+          return;
+        lastRound = round;
+        // There are fewer chunks than threads at the end of the input.
+        if (idx >= numChunks)
+          continue;
+      }
+      demangleChunk(idx);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--numPendingChunks == 0)
+          roundFinished.notify_one();
+      }
+    }
+  }
+
+public:
+  DemanglerPool(unsigned numThreads,
+                const swift::Demangle::DemangleOptions &options)
+    : chunks(numThreads), outputs(numThreads) {
+    for (unsigned idx = 0; idx < numThreads; ++idx)
+      demanglers.emplace_back(new TextDemangler(options));
+    for (unsigned idx = 1; idx < numThreads; ++idx)
+      workers.emplace_back(&DemanglerPool::runWorker, this, idx);
+  }
+
+  ~DemanglerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      shuttingDown = true;
+    }
+    roundStarted.notify_all();
+    for (auto &worker : workers)
+      worker.join();
+  }
+
+  /// Demangles all symbols in \p text and writes the text with the demangled
+  /// symbols to \p os, in the order of the input.
+  void demangleText(llvm::StringRef text, llvm::raw_ostream &os) {
+    if (text.empty())
+      return;
+
+    // Hand out one chunk to each thread. The last chunk takes the rest.
+    unsigned count = 0;
+    while (!text.empty()) {
+      size_t length = count + 1 == demanglers.size() ? text.size()
+                                                     : getChunkLength(text);
+      chunks[count++] = text.substr(0, length);
+      text = text.substr(length);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      numChunks = count;
+      numPendingChunks = count - 1;
+      ++round;
+    }
+    if (count > 1)
+      roundStarted.notify_all();
+
+    demangleChunk(0);
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      roundFinished.wait(lock, [&] { return numPendingChunks == 0; });
+    }
+
+    for (unsigned idx = 0; idx < count; ++idx) {
+      os << outputs[idx];
+      outputs[idx].clear();
+    }
+  }
+};
+} // end anonymous namespace
+
+/// Demangles all symbols in \p input and writes the text with the demangled
+/// symbols to \p os.
+///
+/// The input is read incrementally, so the output of large piped inputs is
+/// written while reading. Each part of the input is split into chunks which
+/// are demangled in parallel on NumThreads threads.
+///
+/// Returns false if reading the input failed.
+static bool demangleStream(FILE *input, llvm::raw_ostream &os,
+                           const swift::Demangle::DemangleOptions &options) {
+  unsigned numThreads = std::max(1u, unsigned(NumThreads));
+  DemanglerPool pool(numThreads, options);
+
+  size_t readSize = getChunkSize() * numThreads;
+  std::string buffer;
+  bool atEnd = false;
+  while (!atEnd) {
+    size_t oldSize = buffer.size();
+    buffer.resize(oldSize + readSize);
+    size_t numRead = std::fread(&buffer[oldSize], 1, readSize, input);
+    buffer.resize(oldSize + numRead);
+    if (numRead < readSize) {
+      if (std::ferror(input))
+        return false;
+      atEnd = true;
+    }
+
+    // Don't split a symbol at the end of the buffer. Keep the trailing
+    // characters which might belong to a mangled name for the next part.
+    size_t length = buffer.size();
+    if (!atEnd) {
+      while (length > 0 && isMangledNameChar(buffer[length - 1]))
+        --length;
+    }
+    pool.demangleText(llvm::StringRef(buffer.data(), length), os);
+    os.flush();
+    buffer.erase(0, length);
+  }
+  return true;
+}
+
 int main(int argc, char **argv) {
 #if defined(__CYGWIN__)
   // Cygwin clang 3.5.2 with '-O3' generates CRASHING BINARY,
@@ -109,28 +394,29 @@ int main(int argc, char **argv) {
   if (Simplified)
     options = swift::Demangle::DemangleOptions::SimplifiedUIDemangleOptions();
 
+  swift::Demangle::NodeFactory factory;
+
   if (InputNames.empty()) {
     CompactMode = true;
-    auto input = llvm::MemoryBuffer::getSTDIN();
-    if (!input) {
-      llvm::errs() << input.getError().message() << '\n';
-      return EXIT_FAILURE;
+    FILE *input = stdin;
+    if (InputFile != "-") {
+      input = std::fopen(InputFile.c_str(), "rb");
+      if (!input) {
+        llvm::errs() << InputFile << ": " << std::strerror(errno) << '\n';
+        return EXIT_FAILURE;
+      }
     }
-    llvm::StringRef inputContents = input.get()->getBuffer();
-
-    // This doesn't handle Unicode symbols, but maybe that's okay.
-    llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
-    llvm::SmallVector<llvm::StringRef, 1> matches;
-    while (maybeSymbol.match(inputContents, &matches)) {
-      llvm::outs() << substrBefore(inputContents, matches.front());
-      demangle(llvm::outs(), matches.front(), options);
-      inputContents = substrAfter(inputContents, matches.front());
+    bool success = demangleStream(input, llvm::outs(), options);
+    if (input != stdin)
+      std::fclose(input);
+    if (!success) {
+      llvm::errs() << "error reading " << InputFile << '\n';
+      return EXIT_FAILURE;
     }
-    llvm::outs() << inputContents;
 
   } else {
     for (llvm::StringRef name : InputNames) {
-      demangle(llvm::outs(), name, options);
+      demangle(llvm::outs(), name, factory, options);
       llvm::outs() << '\n';
     }
   }
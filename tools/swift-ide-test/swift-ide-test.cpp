@@ -1373,8 +1373,9 @@ static int doPrintAST(const CompilerInvocation &InitInvok,
 
   // If we were given a mangled name, do a very simple form of LLDB's logic to
   // look up a type based on that name.
+  Demangle::NodeFactory Factory;
   Demangle::NodePointer node =
-    demangle_wrappers::demangleSymbolAsNode(MangledNameToFind);
+    demangle_wrappers::demangleSymbolAsNode(MangledNameToFind, Factory);
   using NodeKind = Demangle::Node::Kind;
 
   if (!node) {
@@ -1524,10 +1525,12 @@ static int doPrintLocalTypes(const CompilerInvocation &InitInvok,
     }
 
     // Simulate the demangling / parsing process
+    Demangle::NodeFactory Factory;
     for (auto MangledName : MangledNames) {
+      Factory.clear();
 
       // Global
-      auto node = demangle_wrappers::demangleSymbolAsNode(MangledName);
+      auto node = demangle_wrappers::demangleSymbolAsNode(MangledName, Factory);
 
       // TypeMangling
       node = node->getFirstChild();
@@ -0,0 +1,84 @@
+#include "swift/Basic/Demangle.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace swift::Demangle;
+
+// The corpus is the demangler's own test input, which contains a line
+// "<mangled name> ---> <demangled name>" for each symbol.
+#ifndef SWIFT_DEMANGLE_CORPUS
+#error "SWIFT_DEMANGLE_CORPUS must be defined to the path of manglings.txt"
+#endif
+
+static std::vector<std::string> readCorpus() {
+  std::vector<std::string> Names;
+  auto Buffer = llvm::MemoryBuffer::getFile(SWIFT_DEMANGLE_CORPUS);
+  if (!Buffer)
+    return Names;
+
+  llvm::StringRef Contents = Buffer.get()->getBuffer();
+  while (!Contents.empty()) {
+    llvm::StringRef Line;
+    std::tie(Line, Contents) = Contents.split('\n');
+    llvm::StringRef Mangled = Line.split(" ---> ").first.trim();
+    if (!Mangled.empty())
+      Names.push_back(Mangled.str());
+  }
+  return Names;
+}
+
+/// Demangles \p Name like demangleSymbolAsString does, but with nodes
+/// allocated in \p Factory.
+static std::string demangleWith(NodeFactory &Factory, const std::string &Name) {
+  NodePointer Root = demangleSymbolAsNode(Name, Factory);
+  std::string Result = Root ? nodeToString(Root) : std::string();
+  return Result.empty() ? Name : Result;
+}
+
+TEST(DemangleBenchmark, SharedFactory) {
+  auto Corpus = readCorpus();
+  ASSERT_FALSE(Corpus.empty());
+
+  // Keep the trees of all symbols alive in a single factory. This forces the
+  // factory to allocate many slabs.
+  NodeFactory Factory;
+  std::vector<NodePointer> Roots;
+  for (auto &Name : Corpus)
+    Roots.push_back(demangleSymbolAsNode(Name, Factory));
+
+  for (size_t Idx = 0, End = Corpus.size(); Idx != End; ++Idx) {
+    std::string Result = Roots[Idx] ? nodeToString(Roots[Idx]) : std::string();
+    if (Result.empty())
+      Result = Corpus[Idx];
+    EXPECT_EQ(demangleSymbolAsString(Corpus[Idx]), Result);
+  }
+}
+
+// The throughput benchmark doesn't run by default. Run it with
+// --gtest_also_run_disabled_tests and compare the reported time.
+TEST(DemangleBenchmark, DISABLED_Throughput) {
+  auto Corpus = readCorpus();
+  ASSERT_FALSE(Corpus.empty());
+
+  std::vector<std::string> Expected;
+  for (auto &Name : Corpus)
+    Expected.push_back(demangleSymbolAsString(Name));
+
+  // Reuse a single factory for all symbols, which is the intended usage for
+  // tools that demangle many names: after the first few symbols, clear()
+  // recycles the slab and no more memory is allocated for nodes.
+  const unsigned NumIterations = 200;
+  NodeFactory Factory;
+  for (unsigned Iter = 0; Iter != NumIterations; ++Iter) {
+    for (size_t Idx = 0, End = Corpus.size(); Idx != End; ++Idx) {
+      Factory.clear();
+      std::string Result = demangleWith(Factory, Corpus[Idx]);
+      if (Iter == 0)
+        EXPECT_EQ(Expected[Idx], Result);
+    }
+  }
+}
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "SourceKit/Support/FuzzyStringMatcher.h"
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using FuzzyStringMatcher = SourceKit::FuzzyStringMatcher;
+using llvm::StringRef;
+
+/// Returns \p Count identifiers that look like the names in a global code
+/// completion result: camel-cased words, with and without framework prefixes,
+/// some with argument labels.
+static std::vector<std::string> makeCorpus(unsigned Count) {
+  static const char *const Prefixes[] = { "", "", "", "NS", "UI", "CG", "_" };
+  static const char *const Words[] = {
+    "view", "Controller", "Window", "Table", "Cell", "Data", "Source",
+    "delegate", "Event", "Layout", "Constraint", "Image", "Color", "String",
+    "Array", "Dictionary", "Index", "Range", "Font", "Attributed", "Text",
+    "Field", "Button", "Action", "Target", "Notification", "Center", "Queue",
+    "Operation", "Request", "Response", "Session", "Task", "URL", "File",
+    "Manager", "Bundle", "Path", "Value", "Number", "Formatter", "Date",
+  };
+  static const char *const Labels[] = { "", "", "(_:)", "(for:)",
+                                        "(with:options:)", "(at:)" };
+  const unsigned NumPrefixes = sizeof(Prefixes) / sizeof(Prefixes[0]);
+  const unsigned NumWords = sizeof(Words) / sizeof(Words[0]);
+  const unsigned NumLabels = sizeof(Labels) / sizeof(Labels[0]);
+
+  // A fixed-seed linear congruential generator keeps the corpus the same on
+  // every run.
+  uint32_t Seed = 42;
+  auto Next = [&Seed](unsigned Bound) {
+    Seed = Seed * 1664525 + 1013904223;
+    return (Seed >> 8) % Bound;
+  };
+
+  std::vector<std::string> Corpus;
+  Corpus.reserve(Count);
+  for (unsigned I = 0; I != Count; ++I) {
+    std::string Name = Prefixes[Next(NumPrefixes)];
+    unsigned NumNameWords = 1 + Next(4);
+    for (unsigned W = 0; W != NumNameWords; ++W)
+      Name += Words[Next(NumWords)];
+    Name += Labels[Next(NumLabels)];
+    Corpus.push_back(std::move(Name));
+  }
+  return Corpus;
+}
+
+TEST(FuzzyStringMatcherBenchmark, PrefilterIsConservative) {
+  auto Corpus = makeCorpus(10000);
+  for (const char *Pattern : { "a", "vc", "tvc", "NSWin", "dataSrc", "zzq" }) {
+    FuzzyStringMatcher M(Pattern);
+    for (auto &Candidate : Corpus) {
+      if (M.matchesCandidate(Candidate))
+        EXPECT_TRUE(M.mayMatchCandidate(Candidate)) << Pattern << " "
+                                                    << Candidate;
+    }
+  }
+}
+
+TEST(FuzzyStringMatcherBenchmark, ConcurrentScoresMatchSerialScores) {
+  // Large enough to be scored in concurrent chunks.
+  auto Corpus = makeCorpus(20000);
+  std::vector<StringRef> Candidates(Corpus.begin(), Corpus.end());
+
+  for (const char *Pattern : { "a", "tvc", "NSWin" }) {
+    FuzzyStringMatcher M(Pattern);
+    M.normalize = true;
+    std::vector<double> Scores(Candidates.size());
+    M.scoreCandidates(Candidates, Scores);
+    for (size_t I = 0, E = Candidates.size(); I != E; ++I)
+      EXPECT_EQ(M.scoreCandidate(Candidates[I]), Scores[I])
+          << Pattern << " " << Candidates[I];
+  }
+}
+
+// The throughput benchmark doesn't run by default. Run it with
+// --gtest_also_run_disabled_tests and compare the reported time.
+TEST(FuzzyStringMatcherBenchmark, DISABLED_Throughput) {
+  auto Corpus = makeCorpus(100000);
+  const unsigned NumIterations = 5;
+
+  for (const char *Pattern : { "a", "vc", "tvc", "NSWin", "dataSrc", "zzq" }) {
+    FuzzyStringMatcher M(Pattern);
+    M.normalize = true;
+
+    // This is what the code completion organizer does for each candidate.
+    double TotalScore = 0;
+    for (unsigned Iter = 0; Iter != NumIterations; ++Iter) {
+      for (auto &Candidate : Corpus) {
+        if (M.matchesCandidate(Candidate))
+          TotalScore += M.scoreCandidate(Candidate);
+      }
+    }
+    EXPECT_GE(TotalScore, 0.0);
+  }
+}
@@ -40,6 +40,26 @@ TEST(FuzzyStringMatcher, BasicMatching) {
   }
 }
 
+TEST(FuzzyStringMatcher, CharacterMaskPrefilter) {
+  FuzzyStringMatcher m("aBc1_");
+  EXPECT_TRUE(m.mayMatchCandidate("ABC1_"));
+  EXPECT_TRUE(m.mayMatchCandidate("_1cba"));
+  EXPECT_TRUE(m.mayMatchCandidate("xxAxxbxxCxx1xx_"));
+  EXPECT_FALSE(m.mayMatchCandidate("abc1"));
+  EXPECT_FALSE(m.mayMatchCandidate("ab_1"));
+  EXPECT_FALSE(m.mayMatchCandidate(""));
+
+  // The prefilter ignores the order, matchesCandidate doesn't.
+  EXPECT_FALSE(m.matchesCandidate("_1cba"));
+  EXPECT_TRUE(m.matchesCandidate("xxAxxbxxCxx1xx_"));
+
+  // Non-ASCII bytes are opaque, but must never be rejected if they match.
+  FuzzyStringMatcher u(u8"\u2602z");
+  EXPECT_TRUE(u.mayMatchCandidate(u8"Z\u2602"));
+  EXPECT_TRUE(u.matchesCandidate(u8"x\u2602Z"));
+  EXPECT_FALSE(u.matchesCandidate(u8"xZ"));
+}
+
 TEST(FuzzyStringMatcher, SingleCharacterMatching) {
   EXPECT_TRUE(FuzzyStringMatcher("A").matchesCandidate("a"));
   EXPECT_TRUE(FuzzyStringMatcher("a").matchesCandidate("a"));
@@ -43,3 +43,53 @@ TEST(EditableTextBuffer, Updates) {
 
   EXPECT_EQ(Buf->getFilename(), "/a/test");
 }
+
+TEST(EditableTextBuffer, OlderSnapshots) {
+  EditableTextBufferManager BufMgr;
+  EditableTextBufferRef EdBuf = BufMgr.getOrCreateBuffer("/a/test", "abc");
+
+  ImmutableTextSnapshotRef Snap1 = EdBuf->insert(3, "def");
+  ImmutableTextSnapshotRef Snap2 = EdBuf->insert(0, "123");
+  ImmutableTextSnapshotRef Snap3 = EdBuf->erase(3, 2);
+
+  // Materialize the latest snapshot first, then the older ones.
+  EXPECT_EQ(Snap3->getBuffer()->getText(), "123cdef");
+  EXPECT_EQ(Snap1->getBuffer()->getText(), "abcdef");
+  EXPECT_EQ(Snap2->getBuffer()->getText(), "123abcdef");
+
+  // Editing after materializing older snapshots continues from the latest
+  // text.
+  ImmutableTextSnapshotRef Snap4 = EdBuf->replace(0, 3, "x");
+  EXPECT_EQ(Snap4->getBuffer()->getText(), "xcdef");
+  EXPECT_EQ(Snap3->getBuffer()->getText(), "123cdef");
+}
+
+TEST(EditableTextBuffer, ManyEdits) {
+  EditableTextBufferManager BufMgr;
+  EditableTextBufferRef EdBuf = BufMgr.getOrCreateBuffer("/a/test");
+
+  std::string Expected;
+  for (unsigned I = 0; I != 1000; ++I) {
+    unsigned Offset = Expected.size() / 2;
+    EdBuf->insert(Offset, "ab\n");
+    Expected.insert(Offset, "ab\n");
+    if (I % 10 == 0)
+      EXPECT_EQ(EdBuf->getBuffer()->getText(), Expected);
+  }
+  EXPECT_EQ(EdBuf->getBuffer()->getText(), Expected);
+}
+
+TEST(ImmutableTextBuffer, LineAndColumn) {
+  EditableTextBufferManager BufMgr;
+  EditableTextBufferRef EdBuf = BufMgr.getOrCreateBuffer("/a/test",
+                                                         "ab\n\ncde\nf");
+  ImmutableTextBufferRef Buf = EdBuf->getBuffer();
+
+  EXPECT_EQ(std::make_pair(1u, 1u), Buf->getLineAndColumn(0));
+  EXPECT_EQ(std::make_pair(1u, 3u), Buf->getLineAndColumn(2));
+  EXPECT_EQ(std::make_pair(2u, 1u), Buf->getLineAndColumn(3));
+  EXPECT_EQ(std::make_pair(3u, 1u), Buf->getLineAndColumn(4));
+  EXPECT_EQ(std::make_pair(3u, 3u), Buf->getLineAndColumn(6));
+  EXPECT_EQ(std::make_pair(4u, 2u), Buf->getLineAndColumn(9));
+  EXPECT_EQ(std::make_pair(0u, 0u), Buf->getLineAndColumn(10));
+}
@@ -0,0 +1,393 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "SourceKit/Core/Context.h"
+#include "SourceKit/Core/LangSupport.h"
+#include "SourceKit/Core/NotificationCenter.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace SourceKit;
+using namespace llvm;
+
+static StringRef getRuntimeLibPath() {
+  return sys::path::parent_path(SWIFTLIB_DIR);
+}
+
+namespace {
+
+typedef std::tuple<unsigned, unsigned, UIdent> SemanticAnnotation;
+typedef std::tuple<unsigned, unsigned, UIdent> SyntaxMapEntry;
+
+class SemaEditorConsumer : public EditorConsumer {
+  bool NeedsSemanticInfo;
+
+public:
+  std::vector<SemanticAnnotation> Annotations;
+  std::vector<SyntaxMapEntry> SyntaxMap;
+  unsigned AffectedOffset = 0;
+  unsigned AffectedLength = 0;
+
+  explicit SemaEditorConsumer(bool NeedsSemanticInfo = true)
+    : NeedsSemanticInfo(NeedsSemanticInfo) {}
+
+private:
+  bool needsSemanticInfo() override { return NeedsSemanticInfo; }
+
+  void handleRequestError(const char *Description) override {
+    llvm_unreachable("unexpected error");
+  }
+
+  bool handleSyntaxMap(unsigned Offset, unsigned Length, UIdent Kind) override {
+    SyntaxMap.push_back(std::make_tuple(Offset, Length, Kind));
+    return true;
+  }
+
+  bool handleSemanticAnnotation(unsigned Offset, unsigned Length,
+                                UIdent Kind, bool isSystem) override {
+    Annotations.push_back(std::make_tuple(Offset, Length, Kind));
+    return true;
+  }
+
+  bool beginDocumentSubStructure(unsigned Offset, unsigned Length,
+                                 UIdent Kind, UIdent AccessLevel,
+                                 UIdent SetterAccessLevel,
+                                 unsigned NameOffset,
+                                 unsigned NameLength,
+                                 unsigned BodyOffset,
+                                 unsigned BodyLength,
+                                 StringRef DisplayName,
+                                 StringRef TypeName,
+                                 StringRef RuntimeName,
+                                 StringRef SelectorName,
+                                 ArrayRef<StringRef> InheritedTypes,
+                                 ArrayRef<UIdent> Attrs) override {
+    return false;
+  }
+
+  bool endDocumentSubStructure() override { return false; }
+
+  bool handleDocumentSubStructureElement(UIdent Kind,
+                                         unsigned Offset,
+                                         unsigned Length) override {
+    return false;
+  }
+
+  bool recordAffectedRange(unsigned Offset, unsigned Length) override {
+    AffectedOffset = Offset;
+    AffectedLength = Length;
+    return true;
+  }
+
+  bool recordAffectedLineRange(unsigned Line, unsigned Length) override {
+    return false;
+  }
+
+  bool recordFormattedText(StringRef Text) override { return false; }
+
+  bool setDiagnosticStage(UIdent DiagStage) override { return false; }
+  bool handleDiagnostic(const DiagnosticEntryInfo &Info,
+                        UIdent DiagStage) override {
+    return false;
+  }
+
+  bool handleSourceText(StringRef Text) override { return false; }
+};
+
+class EditingTest : public ::testing::Test {
+  SourceKit::Context Ctx{ getRuntimeLibPath() };
+
+  std::mutex Mtx;
+  std::condition_variable Cond;
+  llvm::StringMap<unsigned> NumUpdates;
+
+public:
+  LangSupport &getLang() { return Ctx.getSwiftLangSupport(); }
+
+  void SetUp() {
+    Ctx.getNotificationCenter().addDocumentUpdateNotificationReceiver(
+      [this](StringRef DocName) {
+        std::lock_guard<std::mutex> L(Mtx);
+        ++NumUpdates[DocName];
+        Cond.notify_all();
+      });
+  }
+
+  void open(StringRef DocName, StringRef Text, ArrayRef<const char *> Args) {
+    SemaEditorConsumer Consumer;
+    auto Buf = MemoryBuffer::getMemBufferCopy(Text, DocName);
+    getLang().editorOpen(DocName, Buf.get(), /*EnableSyntaxMap=*/false,
+                         Consumer, Args);
+  }
+
+  void replaceText(StringRef DocName, unsigned Offset, unsigned Length,
+                   StringRef Text) {
+    SemaEditorConsumer Consumer;
+    auto Buf = MemoryBuffer::getMemBufferCopy(Text, DocName);
+    getLang().editorReplaceText(DocName, Buf.get(), Offset, Length, Consumer);
+  }
+
+  /// Opens \p DocName without compiler arguments and reports its syntax map
+  /// to \p Consumer.
+  void openWithSyntaxMap(StringRef DocName, StringRef Text,
+                         SemaEditorConsumer &Consumer) {
+    auto Buf = MemoryBuffer::getMemBufferCopy(Text, DocName);
+    getLang().editorOpen(DocName, Buf.get(), /*EnableSyntaxMap=*/true,
+                         Consumer, /*Args=*/None);
+  }
+
+  void replaceText(StringRef DocName, unsigned Offset, unsigned Length,
+                   StringRef Text, SemaEditorConsumer &Consumer) {
+    auto Buf = MemoryBuffer::getMemBufferCopy(Text, DocName);
+    getLang().editorReplaceText(DocName, Buf.get(), Offset, Length, Consumer);
+  }
+
+  void close(StringRef DocName) {
+    getLang().editorClose(DocName, /*RemoveCache=*/false);
+  }
+
+  /// Returns the semantic annotations of the last AST of \p DocName.
+  std::vector<SemanticAnnotation> readAnnotations(StringRef DocName) {
+    SemaEditorConsumer Consumer;
+    auto Buf = MemoryBuffer::getMemBufferCopy("", DocName);
+    getLang().editorReplaceText(DocName, Buf.get(), 0, 0, Consumer);
+    return Consumer.Annotations;
+  }
+
+  unsigned getNumUpdates(StringRef DocName) {
+    std::lock_guard<std::mutex> L(Mtx);
+    return NumUpdates.lookup(DocName);
+  }
+
+  /// Waits until \p DocName got at least \p Num document update
+  /// notifications.
+  void waitForUpdates(StringRef DocName, unsigned Num) {
+    std::unique_lock<std::mutex> L(Mtx);
+    bool Done = Cond.wait_for(L, std::chrono::seconds(60), [&] {
+      return NumUpdates.lookup(DocName) >= Num;
+    });
+    if (!Done)
+      llvm::report_fatal_error("document update took too long");
+  }
+
+  unsigned findOffset(StringRef Val, StringRef Text) {
+    auto pos = Text.find(Val);
+    assert(pos != StringRef::npos);
+    return pos;
+  }
+};
+
+} // anonymous namespace
+
+TEST_F(EditingTest, OnlyInterfaceEditsUpdateOtherDocuments) {
+  const char *DocA = "/a.swift";
+  const char *DocB = "/b.swift";
+  const char *ContentsA =
+    "func foo() -> Int {\n"
+    "  return 1\n"
+    "}\n";
+  const char *ContentsB =
+    "func bar() -> Int {\n"
+    "  return foo()\n"
+    "}\n";
+  const char *Args[] = { "-parse-as-library", DocA, DocB };
+
+  open(DocA, ContentsA, Args);
+  open(DocB, ContentsB, Args);
+  waitForUpdates(DocA, 1);
+  waitForUpdates(DocB, 1);
+
+  // Edit the function body and a comment. Only the edited document needs new
+  // semantic info.
+  replaceText(DocA, findOffset("1", ContentsA), 1, "2");
+  waitForUpdates(DocA, 2);
+  replaceText(DocA, 0, 0, "// comment\n");
+  waitForUpdates(DocA, 3);
+
+  // Change the signature of the function. Now the other document must be
+  // updated, too.
+  replaceText(DocA, findOffset("Int", ContentsA) + strlen("// comment\n"), 3,
+              "String");
+  waitForUpdates(DocA, 4);
+  waitForUpdates(DocB, 2);
+
+  EXPECT_EQ(2u, getNumUpdates(DocB));
+}
+
+TEST_F(EditingTest, AnnotationsAfterBodyEditMatchNewDocument) {
+  const char *DocA = "/annot_a.swift";
+  const char *DocB = "/annot_b.swift";
+  std::string Contents =
+    "struct S {}\n"
+    "func foo() -> S {\n"
+    "  return S()\n"
+    "}\n"
+    "func bar() -> S {\n"
+    "  let s = S()\n"
+    "  return s\n"
+    "}\n";
+  const char *ArgsA[] = { "-parse-as-library", DocA };
+  const char *ArgsB[] = { "-parse-as-library", DocB };
+
+  open(DocA, Contents, ArgsA);
+  waitForUpdates(DocA, 1);
+
+  // Only the body of 'bar' changes, the annotations of the other declarations
+  // can be reused.
+  unsigned Offset = findOffset("return s", Contents);
+  const char *Insertion = "_ = foo()\n  ";
+  replaceText(DocA, Offset, 0, Insertion);
+  waitForUpdates(DocA, 2);
+  auto Edited = readAnnotations(DocA);
+
+  Contents.insert(Offset, Insertion);
+  open(DocB, Contents, ArgsB);
+  waitForUpdates(DocB, 1);
+  auto New = readAnnotations(DocB);
+
+  EXPECT_FALSE(New.empty());
+  EXPECT_EQ(New, Edited);
+}
+
+TEST_F(EditingTest, AnnotationsAfterPrivateDeclEditMatchNewDocument) {
+  const char *DocA = "/annot_private_a.swift";
+  const char *DocB = "/annot_private_b.swift";
+  std::string Contents =
+    "private func helper() {}\n"
+    "func user() {\n"
+    "  helper()\n"
+    "}\n";
+  const char *ArgsA[] = { "-parse-as-library", DocA };
+  const char *ArgsB[] = { "-parse-as-library", DocB };
+
+  open(DocA, Contents, ArgsA);
+  waitForUpdates(DocA, 1);
+
+  // A private global is not part of the interface hash, but the reference in
+  // 'user' must still be annotated again.
+  unsigned Offset = findOffset("func helper() {}", Contents);
+  StringRef Removed = "func helper() {}";
+  const char *Insertion = "var helper = {}";
+  replaceText(DocA, Offset, Removed.size(), Insertion);
+  waitForUpdates(DocA, 2);
+  auto Edited = readAnnotations(DocA);
+
+  Contents.replace(Offset, Removed.size(), Insertion);
+  open(DocB, Contents, ArgsB);
+  waitForUpdates(DocB, 1);
+  auto New = readAnnotations(DocB);
+
+  unsigned RefOffset = findOffset("helper()", Contents);
+  auto IsRef = [&](const SemanticAnnotation &Annot) {
+    return std::get<0>(Annot) == RefOffset;
+  };
+  auto Ref = std::find_if(Edited.begin(), Edited.end(), IsRef);
+  ASSERT_NE(Edited.end(), Ref);
+  EXPECT_EQ(UIdent("source.lang.swift.ref.var.global"), std::get<2>(*Ref));
+  EXPECT_EQ(New, Edited);
+}
+
+/// Returns a source file with \p NumFuncs functions, and sets \p EditOffset
+/// to the start of the body of the function in the middle of the file.
+static std::string makeSource(unsigned NumFuncs, unsigned &EditOffset) {
+  std::string Source;
+  for (unsigned I = 0; I != NumFuncs; ++I) {
+    Source += "func f" + std::to_string(I) + "() -> Int {\n";
+    if (I == NumFuncs / 2)
+      EditOffset = Source.size();
+    Source += "  let x = \"string\" // comment\n"
+              "  return x.characters.count + 1\n"
+              "}\n";
+  }
+  return Source;
+}
+
+TEST_F(EditingTest, SyntaxMapOfEditMatchesFullParse) {
+  const char *DocName = "/edit.swift";
+  unsigned EditOffset = 0;
+  std::string Source = makeSource(20, EditOffset);
+  const char *Insertion = "  x\n";
+
+  SemaEditorConsumer OpenConsumer(/*NeedsSemanticInfo=*/false);
+  openWithSyntaxMap(DocName, Source, OpenConsumer);
+  SemaEditorConsumer EditConsumer(/*NeedsSemanticInfo=*/false);
+  replaceText(DocName, EditOffset, 0, Insertion, EditConsumer);
+  close(DocName);
+
+  // Only the lines around the edit are re-reported, not the rest of the file.
+  EXPECT_EQ(EditOffset, EditConsumer.AffectedOffset);
+  EXPECT_LT(EditConsumer.AffectedLength, 100u);
+
+  // The reported entries must be the same as the ones of a full parse of the
+  // new text.
+  std::string NewSource = Source;
+  NewSource.insert(EditOffset, Insertion);
+  SemaEditorConsumer FullConsumer(/*NeedsSemanticInfo=*/false);
+  openWithSyntaxMap(DocName, NewSource, FullConsumer);
+  close(DocName);
+
+  std::vector<SyntaxMapEntry> Expected;
+  for (auto &Entry : FullConsumer.SyntaxMap) {
+    unsigned Offset = std::get<0>(Entry);
+    if (Offset >= EditConsumer.AffectedOffset &&
+        Offset < EditConsumer.AffectedOffset + EditConsumer.AffectedLength)
+      Expected.push_back(Entry);
+  }
+  EXPECT_EQ(Expected, EditConsumer.SyntaxMap);
+}
+
+/// Types \p NumKeystrokes characters into the middle of a file with
+/// \p NumFuncs functions.
+static void typeIntoFile(EditingTest &Test, unsigned NumFuncs,
+                         unsigned NumKeystrokes) {
+  const char *DocName = "/latency.swift";
+  unsigned EditOffset = 0;
+  std::string Source = makeSource(NumFuncs, EditOffset);
+
+  SemaEditorConsumer OpenConsumer(/*NeedsSemanticInfo=*/false);
+  Test.openWithSyntaxMap(DocName, Source, OpenConsumer);
+
+  for (unsigned I = 0; I != NumKeystrokes; ++I) {
+    SemaEditorConsumer Consumer(/*NeedsSemanticInfo=*/false);
+    Test.replaceText(DocName, EditOffset + I, 0, "a", Consumer);
+    EXPECT_FALSE(Consumer.SyntaxMap.empty());
+    EXPECT_LT(Consumer.AffectedLength, 100u);
+  }
+  Test.close(DocName);
+}
+
+// The latency tests are benchmarks and don't run by default. Run them with
+// --gtest_also_run_disabled_tests and compare the reported times: the latency
+// should grow with the file size as slowly as possible.
+
+TEST_F(EditingTest, DISABLED_KeystrokeLatency100) {
+  typeIntoFile(*this, 100, 20);
+}
+
+TEST_F(EditingTest, DISABLED_KeystrokeLatency1000) {
+  typeIntoFile(*this, 1000, 20);
+}
+
+TEST_F(EditingTest, DISABLED_KeystrokeLatency5000) {
+  typeIntoFile(*this, 5000, 20);
+}
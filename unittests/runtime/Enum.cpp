@@ -153,3 +153,93 @@ TEST(EnumTest, storeEnumTagSinglePayload) {
   ASSERT_TRUE(test_storeEnumTagSinglePayload({1, 1}, {219, 123},
                                               XI_TMBi8_, 3, 4));
 }
+
+// Mock up the metadata of a generic multi-payload enum, whose payload size is
+// stored in the word after the parent metadata reference.
+struct MultiPayloadEnumMetadataMock {
+  alignas(NominalTypeDescriptor)
+  char DescriptorStorage[sizeof(NominalTypeDescriptor)];
+
+  ValueWitnessTable VWT;
+
+  // FullMetadata<EnumMetadata> followed by the payload size.
+  const ValueWitnessTable *ValueWitnesses;
+  uintptr_t Kind;
+  intptr_t DescriptionOffset;
+  intptr_t ParentOffset;
+  size_t PayloadSize;
+
+  using PayloadList = std::initializer_list<const FullOpaqueMetadata *>;
+
+  MultiPayloadEnumMetadataMock(PayloadList payloads, unsigned numEmptyCases)
+    : VWT(_TWVBi8_) {
+    memset(DescriptorStorage, 0, sizeof(DescriptorStorage));
+    auto &Descriptor
+      = *reinterpret_cast<NominalTypeDescriptor *>(DescriptorStorage);
+    Descriptor.Enum.NumPayloadCasesAndPayloadSizeOffset
+      = payloads.size() | (3U << 24);
+    Descriptor.Enum.NumEmptyCases = numEmptyCases;
+
+    ValueWitnesses = &VWT;
+    Kind = uintptr_t(MetadataKind::Enum);
+    DescriptionOffset = reinterpret_cast<intptr_t>(&Descriptor)
+      - reinterpret_cast<intptr_t>(&DescriptionOffset);
+    ParentOffset = 0;
+    PayloadSize = 0;
+
+    std::vector<const TypeLayout *> layouts;
+    for (auto payload : payloads)
+      layouts.push_back(payload->base.getValueWitnesses()->getTypeLayout());
+    swift_initEnumMetadataMultiPayload(&VWT, get(), layouts.size(),
+                                        layouts.data());
+  }
+
+  EnumMetadata *get() {
+    return reinterpret_cast<EnumMetadata *>(&Kind);
+  }
+};
+
+bool test_multiPayloadRoundTrip(MultiPayloadEnumMetadataMock &mock,
+                                unsigned whichCase,
+                                std::initializer_list<uint8_t> expected) {
+  EnumMetadata *enumType = mock.get();
+  assert(enumType->getValueWitnesses()->size == expected.size());
+
+  std::vector<uint8_t> buf(expected.size(), 0xAA);
+  swift_storeEnumTagMultiPayload(asOpaque(buf.data()), enumType, whichCase);
+  if (memcmp(buf.data(), expected.begin(), expected.size()) != 0)
+    return false;
+  return swift_getEnumCaseMultiPayload(asOpaque(buf.data()), enumType)
+           == whichCase;
+}
+
+TEST(EnumTest, multiPayloadTagBytes) {
+  // One-byte payload and one tag byte: too small for word-sized access.
+  MultiPayloadEnumMetadataMock small({&_TMBi8_, &_TMBi8_}, 300);
+  ASSERT_EQ(2u, small.get()->getValueWitnesses()->size);
+  ASSERT_TRUE(test_multiPayloadRoundTrip(small, 0, {0xAA, 0}));
+  ASSERT_TRUE(test_multiPayloadRoundTrip(small, 1, {0xAA, 1}));
+  ASSERT_TRUE(test_multiPayloadRoundTrip(small, 2, {0, 2}));
+  ASSERT_TRUE(test_multiPayloadRoundTrip(small, 257, {255, 2}));
+  ASSERT_TRUE(test_multiPayloadRoundTrip(small, 258, {0, 3}));
+  ASSERT_TRUE(test_multiPayloadRoundTrip(small, 301, {43, 3}));
+
+  // Two-byte payload and two tag bytes, which fill a single word together.
+  MultiPayloadEnumMetadataMock shared({&_TMBi16_, &_TMBi8_}, 300 << 16);
+  ASSERT_EQ(4u, shared.get()->getValueWitnesses()->size);
+  ASSERT_TRUE(test_multiPayloadRoundTrip(shared, 1, {0xAA, 0xAA, 1, 0}));
+  ASSERT_TRUE(test_multiPayloadRoundTrip(shared, 2, {0, 0, 2, 0}));
+  ASSERT_TRUE(test_multiPayloadRoundTrip(shared, 3, {1, 0, 2, 0}));
+  ASSERT_TRUE(test_multiPayloadRoundTrip(shared, 2 + (257 << 16) + 0x1234,
+                                         {0x34, 0x12, 3, 1}));
+
+  // Payload area big enough for the index of every empty case.
+  MultiPayloadEnumMetadataMock large({&_TMBi64_, &_TMBi32_, &_TMBi8_}, 1000);
+  ASSERT_EQ(9u, large.get()->getValueWitnesses()->size);
+  ASSERT_TRUE(test_multiPayloadRoundTrip(large, 2,
+                      {0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 2}));
+  ASSERT_TRUE(test_multiPayloadRoundTrip(large, 3,
+                                         {0, 0, 0, 0, 0, 0, 0, 0, 3}));
+  ASSERT_TRUE(test_multiPayloadRoundTrip(large, 1002,
+                                         {231, 3, 0, 0, 0, 0, 0, 0, 3}));
+}
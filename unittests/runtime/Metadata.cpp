@@ -806,6 +806,46 @@ TEST(MetadataTest, installCommonValueWitnesses_pod_indirect) {
   EXPECT_EQ(buf2.canary, (uintptr_t)0xA5A5A5A5U);
 }
 
+TEST(MetadataTest, getTupleTypeMetadata_bitwiseTakable) {
+  // (Builtin.NativeObject, Builtin.Int64) is not POD, but bitwise-takable.
+  const Metadata *elements[] = { &_TMBo, &_TMBi64_ };
+  auto tuple = swift_getTupleTypeMetadata(2, elements, nullptr, nullptr);
+  auto witnesses = tuple->getValueWitnesses();
+  EXPECT_FALSE(witnesses->isPOD());
+  EXPECT_TRUE(witnesses->isBitwiseTakable());
+
+  // Takes should use the common memcpy witnesses instead of taking each
+  // element separately.
+  ValueWitnessTable expected;
+  expected.size = witnesses->size;
+  expected.flags = witnesses->flags;
+  expected.stride = witnesses->stride;
+  installCommonValueWitnesses(&expected);
+  EXPECT_EQ(expected.initializeWithTake, witnesses->initializeWithTake);
+  EXPECT_EQ(expected.initializeArrayWithTakeFrontToBack,
+            witnesses->initializeArrayWithTakeFrontToBack);
+  EXPECT_EQ(expected.initializeArrayWithTakeBackToFront,
+            witnesses->initializeArrayWithTakeBackToFront);
+
+  // Taking doesn't touch the reference counts, so the object references don't
+  // need to be valid.
+  struct Element {
+    void *object;
+    uint64_t value;
+  };
+  ASSERT_EQ(sizeof(Element), witnesses->stride);
+  Element array[4] = {
+    {(void *) 0x1000, 1}, {(void *) 0x2000, 2}, {(void *) 0x3000, 3}, {}
+  };
+  witnesses->initializeArrayWithTakeBackToFront(
+    reinterpret_cast<OpaqueValue *>(&array[1]),
+    reinterpret_cast<OpaqueValue *>(&array[0]), 3, tuple);
+  EXPECT_EQ((void *) 0x1000, array[1].object);
+  EXPECT_EQ(2u, array[2].value);
+  EXPECT_EQ((void *) 0x3000, array[3].object);
+  EXPECT_EQ(3u, array[3].value);
+}
+
 // We cannot construct RelativeDirectPointer instances, so define
 // a "shadow" struct for that purpose
 struct GenericWitnessTableStorage {
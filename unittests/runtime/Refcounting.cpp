@@ -13,6 +13,8 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "gtest/gtest.h"
+#include <thread>
+#include <vector>
 
 using namespace swift;
 
@@ -152,3 +154,117 @@ TEST(RefcountingTest, unowned_retain_release_n) {
   swift_release(object);
   EXPECT_EQ(1u, value);
 }
+
+TEST(RefcountingTest, weak_side_table) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+  WeakReference ref1, ref2;
+  swift_weakInit(&ref1, object);
+  swift_weakCopyInit(&ref2, &ref1);
+
+  // Weak references don't keep the object's memory alive.
+  EXPECT_EQ(1u, swift_unownedRetainCount(object));
+
+  auto loaded = swift_weakLoadStrong(&ref2);
+  EXPECT_EQ(object, loaded);
+  EXPECT_EQ(2u, swift_retainCount(object));
+  swift_release(loaded);
+
+  swift_release(object);
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref1));
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref2));
+
+  WeakReference ref3;
+  swift_weakCopyInit(&ref3, &ref1);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref3));
+
+  swift_weakDestroy(&ref1);
+  swift_weakDestroy(&ref2);
+  swift_weakDestroy(&ref3);
+}
+
+TEST(RefcountingTest, weak_assign) {
+  size_t value1 = 0, value2 = 0;
+  auto object1 = allocTestObject(&value1, 1);
+  auto object2 = allocTestObject(&value2, 1);
+  WeakReference ref1, ref2;
+  swift_weakInit(&ref1, object1);
+  swift_weakInit(&ref2, nullptr);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref2));
+
+  swift_weakCopyAssign(&ref2, &ref1);
+  swift_weakAssign(&ref1, object2);
+  auto loaded = swift_weakTakeStrong(&ref2);
+  EXPECT_EQ(object1, loaded);
+  swift_release(loaded);
+
+  swift_release(object1);
+  EXPECT_EQ(1u, value1);
+  loaded = swift_weakLoadStrong(&ref1);
+  EXPECT_EQ(object2, loaded);
+  swift_release(loaded);
+
+  swift_weakTakeInit(&ref2, &ref1);
+  swift_release(object2);
+  EXPECT_EQ(1u, value2);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref2));
+  swift_weakDestroy(&ref2);
+}
+
+TEST(RefcountingTest, weak_load_races_with_release) {
+  for (unsigned iteration = 0; iteration < 100; ++iteration) {
+    size_t value = 0;
+    auto object = allocTestObject(&value, 1);
+    WeakReference ref;
+    swift_weakInit(&ref, object);
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < 4; ++i) {
+      threads.emplace_back([&ref, object] {
+        for (unsigned j = 0; j < 100; ++j) {
+          auto loaded = swift_weakLoadStrong(&ref);
+          if (!loaded)
+            return;
+          EXPECT_EQ(object, loaded);
+          swift_release(loaded);
+        }
+      });
+    }
+    swift_release(object);
+    for (auto &thread : threads)
+      thread.join();
+
+    EXPECT_EQ(1u, value);
+    EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref));
+    swift_weakDestroy(&ref);
+  }
+}
+
+TEST(RefcountingTest, weak_init_on_many_threads) {
+  // Form and destroy weak references to many objects on several threads, so
+  // that the side table entries are spread over the shards of the side table
+  // map and the threads access the same shards concurrently.
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < 4; ++i) {
+    threads.emplace_back([] {
+      for (unsigned j = 0; j < 1000; ++j) {
+        size_t value = 0;
+        auto object = allocTestObject(&value, 1);
+        WeakReference ref1, ref2;
+        swift_weakInit(&ref1, object);
+        swift_weakInit(&ref2, object);
+        auto loaded = swift_weakLoadStrong(&ref2);
+        EXPECT_EQ(object, loaded);
+        swift_release(loaded);
+        swift_release(object);
+        EXPECT_EQ(1u, value);
+        EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref1));
+        swift_weakDestroy(&ref1);
+        swift_weakDestroy(&ref2);
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+}
@@ -0,0 +1,73 @@
+//===--- Statistics.cpp - Runtime statistics tests ------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Statistics.h"
+#include "gtest/gtest.h"
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+static void destroyTestObject(HeapObject *object) {
+  swift_deallocObject(object, sizeof(HeapObject), alignof(HeapObject) - 1);
+}
+
+static const FullMetadata<ClassMetadata> TestClassObjectMetadata = {
+  { { &destroyTestObject }, { &_TWVBo } },
+  { { { MetadataKind::Class } }, 0, /*rodata*/ 1,
+  ClassFlags::UsesSwift1Refcounting, nullptr, 0, 0, 0, 0, 0 }
+};
+
+static void allocateTestObjects(unsigned count) {
+  for (unsigned i = 0; i < count; ++i)
+    swift_release(swift_allocObject(&TestClassObjectMetadata,
+                                    sizeof(HeapObject),
+                                    alignof(HeapObject) - 1));
+}
+
+static uint64_t getObjectAllocations() {
+  RuntimeStatistics statistics;
+  swift_getRuntimeStatistics(&statistics);
+  return statistics.ObjectAllocations;
+}
+
+TEST(StatisticsTest, ObjectAllocations) {
+  uint64_t before = getObjectAllocations();
+  allocateTestObjects(10);
+  EXPECT_EQ(before + 10, getObjectAllocations());
+}
+
+TEST(StatisticsTest, ExitedThreads) {
+  uint64_t before = getObjectAllocations();
+
+  // Threads which start after others exited take over their counters.
+  for (unsigned round = 0; round < 2; ++round) {
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < 4; ++i)
+      threads.emplace_back(allocateTestObjects, 100);
+    for (auto &thread : threads)
+      thread.join();
+  }
+
+  EXPECT_EQ(before + 800, getObjectAllocations());
+}
+
+TEST(StatisticsTest, Reset) {
+  allocateTestObjects(5);
+  swift_resetRuntimeStatistics();
+  EXPECT_EQ(0u, getObjectAllocations());
+
+  allocateTestObjects(3);
+  EXPECT_EQ(3u, getObjectAllocations());
+}